@@ -0,0 +1,63 @@
+// bench/bench_aggregate.cpp
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cfp/aggregate.hpp"
+#include "cfp/parser.hpp"
+
+namespace {
+
+constexpr std::array<std::string_view, 6> SAMPLES{"H2O",     "Fe2(SO4)3", "K4[Fe(CN)6]*3H2O",
+                                                  "C6H12O6", "NaCl",      "[Co(NH3)5Cl]Cl2"};
+
+constexpr int64_t ROWS = 200'000;
+
+const std::vector<std::string_view> &dataset() {
+  static const auto formulas = [] {
+    std::vector<std::string_view> rows(static_cast<size_t>(ROWS));
+    for (size_t row = 0; row < rows.size(); row++) {
+      rows[row] = SAMPLES[row % SAMPLES.size()];
+    }
+    return rows;
+  }();
+  return formulas;
+}
+
+// the per-row map merge this API replaces
+void BM_AggregateMapMerge(benchmark::State &state) {
+  for (auto _ : state) {
+    std::unordered_map<std::string, uint64_t> total;
+
+    for (const auto formula : dataset()) {
+      for (const auto &[symbol, count] : cfp::Parser{formula}.parse()) {
+        total[symbol] += count;
+      }
+    }
+
+    benchmark::DoNotOptimize(total);
+  }
+
+  state.SetItemsProcessed(state.iterations() * ROWS);
+}
+
+void BM_Aggregate(benchmark::State &state) {
+  const auto threads = static_cast<unsigned>(state.range(0));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cfp::aggregate(dataset(), threads));
+  }
+
+  state.SetItemsProcessed(state.iterations() * ROWS);
+}
+
+}  // namespace
+
+BENCHMARK(BM_AggregateMapMerge)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Aggregate)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
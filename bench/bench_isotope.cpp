@@ -0,0 +1,26 @@
+// bench/bench_isotope.cpp
+
+#include <benchmark/benchmark.h>
+
+#include "cfp/isotope_pattern.hpp"
+#include "cfp/parser.hpp"
+
+namespace {
+
+const cfp::Composition SMALL = cfp::Parser{"C8H10N4O2"}.parseComposition();
+const cfp::Composition LARGE = cfp::Parser{"C1000H2000N300O500S20"}.parseComposition();
+
+// a fresh calculator per iteration: element powers and patterns are built every time
+void BM_IsotopeCold(benchmark::State &state) {
+  const auto &comp = state.range(0) == 0 ? SMALL : LARGE;
+  const auto mode = static_cast<cfp::IsotopeMode>(state.range(1));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cfp::isotope_distribution(comp, {.mode = mode}));
+  }
+}
+
+}  // namespace
+
+// formula: 0 = C8H10N4O2, 1 = C1000H2000N300O500S20; mode: 0 = Fine, 1 = Aggregated
+BENCHMARK(BM_IsotopeCold)->ArgsProduct({{0, 1}, {0, 1}})->Unit(benchmark::kMicrosecond);
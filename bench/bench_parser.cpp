@@ -0,0 +1,90 @@
+// bench/bench_parser.cpp
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <string_view>
+
+#include "cfp/parser.hpp"
+#include "cfp/parser_context.hpp"
+#include "cfp/program.hpp"
+
+namespace {
+
+// Short formulas typical of bulk workloads
+constexpr std::array<std::string_view, 8> SHORT_FORMULAS{
+    "H2O", "NaCl", "C6H12O6", "CH3COOH", "Fe2(SO4)3", "CuSO4*5H2O", "K4[Fe(CN)6]", "C8H10N4O2",
+};
+
+void BM_ParserMap(benchmark::State &state) {
+  for (auto _ : state) {
+    for (const auto formula : SHORT_FORMULAS) {
+      cfp::Parser parser{formula};
+      benchmark::DoNotOptimize(parser.parse());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(SHORT_FORMULAS.size()));
+}
+
+void BM_ParserComposition(benchmark::State &state) {
+  for (auto _ : state) {
+    for (const auto formula : SHORT_FORMULAS) {
+      cfp::Parser parser{formula};
+      benchmark::DoNotOptimize(parser.parseComposition());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(SHORT_FORMULAS.size()));
+}
+
+void BM_ParserWide(benchmark::State &state) {
+  for (auto _ : state) {
+    for (const auto formula : SHORT_FORMULAS) {
+      cfp::Parser parser{formula};
+      benchmark::DoNotOptimize(parser.parseWide());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(SHORT_FORMULAS.size()));
+}
+
+void BM_ParserContext(benchmark::State &state) {
+  cfp::ParserContext ctx;
+
+  for (auto _ : state) {
+    for (const auto formula : SHORT_FORMULAS) {
+      benchmark::DoNotOptimize(&ctx.parse(formula));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(SHORT_FORMULAS.size()));
+}
+
+// re-evaluation of a compiled formula with a changing outer multiplier
+void BM_ProgramEvaluate(benchmark::State &state) {
+  const auto program = cfp::FormulaProgram::compile("[Co(NH3)5(H2O)]2(SO4)3*6H2O");
+  std::array<uint64_t, cfp::ELEMENT_COUNT> counts{};
+  uint64_t scale = 1;
+
+  for (auto _ : state) {
+    program.evaluate(scale++, counts);
+    benchmark::DoNotOptimize(counts.data());
+  }
+}
+
+void BM_ProgramReparse(benchmark::State &state) {
+  cfp::ParserContext ctx;
+  uint64_t scale = 1;
+
+  for (auto _ : state) {
+    auto comp = ctx.parse("[Co(NH3)5(H2O)]2(SO4)3*6H2O");
+    comp *= scale++;
+    benchmark::DoNotOptimize(comp);
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_ParserMap);
+BENCHMARK(BM_ParserComposition);
+BENCHMARK(BM_ParserWide);
+BENCHMARK(BM_ParserContext);
+BENCHMARK(BM_ProgramEvaluate);
+BENCHMARK(BM_ProgramReparse);
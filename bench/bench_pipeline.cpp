@@ -0,0 +1,68 @@
+// bench/bench_pipeline.cpp
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "cfp/parser_context.hpp"
+#include "cfp/pipeline.hpp"
+
+namespace {
+
+constexpr std::array<std::string_view, 6> SAMPLES{"H2O",     "Fe2(SO4)3", "K4[Fe(CN)6]*3H2O",
+                                                  "C6H12O6", "NaCl",      "[Co(NH3)5Cl]Cl2"};
+
+constexpr size_t ROWS = 200'000;
+
+const std::string &text() {
+  static const auto lines = [] {
+    std::string joined;
+    for (size_t row = 0; row < ROWS; row++) {
+      joined += SAMPLES[row % SAMPLES.size()];
+      joined += '\n';
+    }
+    return joined;
+  }();
+  return lines;
+}
+
+// read, split and parse one after another on one thread
+void BM_LinesSequential(benchmark::State &state) {
+  for (auto _ : state) {
+    std::istringstream input{text()};
+    cfp::ParserContext ctx;
+    const auto oxygen = cfp::element_id("O");
+    uint64_t total = 0;
+
+    for (std::string line; std::getline(input, line);) {
+      total += ctx.parse(line)[oxygen];
+    }
+
+    benchmark::DoNotOptimize(total);
+  }
+}
+
+void BM_LinesPipeline(benchmark::State &state) {
+  const cfp::PipelineOptions options{.threads = static_cast<unsigned>(state.range(0))};
+
+  for (auto _ : state) {
+    std::istringstream input{text()};
+    const auto oxygen = cfp::element_id("O");
+    uint64_t total = 0;
+
+    for (const auto &result : cfp::parse_lines(input, options)) {
+      total += result.composition[oxygen];
+    }
+
+    benchmark::DoNotOptimize(total);
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_LinesSequential)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LinesPipeline)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
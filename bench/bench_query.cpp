@@ -0,0 +1,48 @@
+// bench/bench_query.cpp
+
+#include <benchmark/benchmark.h>
+
+#include <string_view>
+
+#include "cfp/parser_context.hpp"
+#include "cfp/query.hpp"
+
+namespace {
+
+constexpr std::string_view FORMULA = "[Co(NH3)5(H2O)]2(SO4)3*6H2O";
+
+void BM_CountOfFullEvaluation(benchmark::State &state) {
+  cfp::ParserContext ctx;
+  const auto oxygen = cfp::element_id("O");
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ctx.parse(FORMULA)[oxygen]);
+  }
+}
+
+void BM_CountOf(benchmark::State &state) {
+  const auto oxygen = cfp::element_id("O");
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cfp::count_of(FORMULA, oxygen));
+  }
+}
+
+void BM_ContainsAnyMiss(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cfp::contains_any(FORMULA, {cfp::element_id("Cl"), cfp::element_id("Br")}));
+  }
+}
+
+void BM_ContainsAnyHit(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cfp::contains_any(FORMULA, {cfp::element_id("Co")}));
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_CountOfFullEvaluation);
+BENCHMARK(BM_CountOf);
+BENCHMARK(BM_ContainsAnyMiss);
+BENCHMARK(BM_ContainsAnyHit);
@@ -0,0 +1,84 @@
+// bench/bench_similarity.cpp
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/parser.hpp"
+#include "cfp/similarity.hpp"
+
+namespace {
+
+constexpr size_t ROWS = 1'000'000;
+
+/// Deterministic organic-looking corpus: CHNOPS plus the odd halogen or metal.
+const std::vector<cfp::Composition> &dataset() {
+  static const auto records = [] {
+    constexpr cfp::ElementId EXTRA[] = {9, 11, 15, 16, 17, 19, 26, 35, 53};
+    uint64_t state = 0x9e3779b97f4a7c15;
+
+    const auto next = [&state] {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+    };
+
+    std::vector<cfp::Composition> rows(ROWS);
+
+    for (auto &comp : rows) {
+      comp.add(6, 1 + (next() % 40));
+      comp.add(1, 1 + (next() % 80));
+      comp.add(8, next() % 12);
+      comp.add(7, next() % 6);
+
+      if (next() % 4 == 0) {
+        comp.add(EXTRA[next() % std::size(EXTRA)], 1 + (next() % 4));
+      }
+    }
+
+    return rows;
+  }();
+  return records;
+}
+
+const cfp::SimilarityIndex &index() {
+  static const cfp::SimilarityIndex built{dataset()};
+  return built;
+}
+
+const cfp::Composition QUERY = cfp::Parser{"C8H10N4O2"}.parseComposition();
+
+// scoring every record with the exact reference, single-threaded
+void BM_SimilarityBruteForce(benchmark::State &state) {
+  const auto metric = static_cast<cfp::SimilarityMetric>(state.range(0));
+
+  for (auto _ : state) {
+    double best = 0.0;
+
+    for (const auto &record : dataset()) {
+      best = std::max(best, cfp::similarity(QUERY, record, metric));
+    }
+
+    benchmark::DoNotOptimize(best);
+  }
+}
+
+void BM_SimilaritySearch(benchmark::State &state) {
+  const auto metric = static_cast<cfp::SimilarityMetric>(state.range(0));
+  const auto threads = static_cast<unsigned>(state.range(1));
+  (void)index();
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(index().search(QUERY, 10, metric, threads));
+  }
+}
+
+}  // namespace
+
+// metric: 0 = Tanimoto, 1 = Cosine, 2 = MassDistance
+BENCHMARK(BM_SimilarityBruteForce)->Arg(0)->Arg(2)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SimilaritySearch)->ArgsProduct({{0, 1, 2}, {1, 4}})->Unit(benchmark::kMillisecond);
@@ -4,6 +4,7 @@ option(ENABLE_STRICT_WARNINGS "Treat warnings as errors"          ON)
 option(ENABLE_TESTING         "Build unit tests"                  ON)
 option(ENABLE_COVERAGE        "Enable coverage instrumentation"   OFF)
 option(BUILD_APP              "Build the demo application"        OFF)
+option(ENABLE_BENCHMARKS      "Build the benchmark suite"         OFF)
 option(ENABLE_SANITIZERS      "Enable ASan / UBSan"               OFF)
 option(ENABLE_ASAN            "Enable AddressSanitizer"           OFF)
 option(ENABLE_UBSAN           "Enable UndefinedBehaviorSanitizer" OFF)
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>  // uint64_t
+#include <span>
+#include <string_view>
+
+#include "cfp/composition.hpp"
+#include "cfp/element.hpp"
+
+namespace cfp {
+
+/**
+ * @struct WeightedTotals
+ * @brief Element totals under real-valued weights (e.g. moles or kilograms per row).
+ */
+struct WeightedTotals {
+  /// Weighted count per element ID (slot 0 is always zero).
+  alignas(64) std::array<double, Composition::CAPACITY> totals{};
+
+  [[nodiscard]] double operator[](ElementId id) const noexcept {
+    return id < Composition::CAPACITY ? totals[id] : 0.0;
+  }
+
+  /// Weighted count of an element given by symbol (0 if absent or unknown).
+  [[nodiscard]] double count(std::string_view symbol) const noexcept {
+    return (*this)[element_id(symbol)];
+  }
+};
+
+/**
+ * @brief Total element counts over a dataset of formulas.
+ *
+ * Rows are parsed in blocks on a pool of workers. Each worker keeps one
+ * reusable ParserContext and one dense per-thread accumulator, so there
+ * are no locks and no per-row allocations. The per-thread totals are
+ * combined pairwise in a tree at the end.
+ *
+ * Example: aggregate({"H2O", "H2O2"}) == {H: 4, O: 3}
+ *
+ * @param formulas  One formula per row.
+ * @param threads   Worker threads (0 = hardware concurrency).
+ * @return          Sum of all compositions.
+ * @throws TokenizerError, ParserError of the first invalid row (lowest index).
+ * @throws OverflowError  if a total exceeds 64 bits.
+ */
+Composition aggregate(std::span<const std::string_view> formulas, unsigned threads = 0);
+
+/**
+ * @brief Total element counts with an integer quantity per row.
+ * @param weights  One multiplier per formula.
+ * @throws std::invalid_argument if @a weights and @a formulas differ in length.
+ * @see aggregate(std::span<const std::string_view>, unsigned)
+ */
+Composition aggregate(std::span<const std::string_view> formulas, std::span<const uint64_t> weights,
+                      unsigned threads = 0);
+
+/**
+ * @brief Total element counts with a real-valued quantity per row.
+ *
+ * Rows are handed to workers dynamically, so with more than one thread the
+ * summation order, and with it the last bits of the result, may vary
+ * between runs.
+ *
+ * @param weights  One weight per formula.
+ * @throws std::invalid_argument if @a weights and @a formulas differ in length.
+ * @see aggregate(std::span<const std::string_view>, unsigned)
+ */
+WeightedTotals aggregate(std::span<const std::string_view> formulas, std::span<const double> weights,
+                         unsigned threads = 0);
+
+}  // namespace cfp
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>  // size_t
 #include <cstdint>  // uint64_t
 #include <memory>  // unique_ptr
 #include <string>
@@ -7,6 +8,11 @@
 #include <unordered_map>
 #include <vector>
 
+#include "cfp/checked.hpp"
+#include "cfp/composition.hpp"
+#include "cfp/element.hpp"
+#include "cfp/wide_composition.hpp"
+
 namespace cfp {
 
 using ElementCountDict = std::unordered_map<std::string, uint64_t>;
@@ -23,6 +29,28 @@ struct Node {
    * @param mult  Multiplier from parent groups.
    */
   virtual void evaluate(ElementCountDict &out, uint64_t mult) const = 0;
+
+  /**
+   * @brief Evaluate a node into a dense composition.
+   * @param out   Composition to accumulate into (unknown symbols are skipped).
+   * @param mult  Multiplier from parent groups.
+   */
+  virtual void evaluate(Composition &out, uint64_t mult) const = 0;
+
+  /**
+   * @brief Evaluate a node into 128-bit counts.
+   * @param out   Wide composition to accumulate into (unknown symbols are skipped).
+   * @param mult  Multiplier from parent groups.
+   */
+  virtual void evaluate(WideComposition &out, wide_count mult) const = 0;
+
+  /**
+   * @brief Evaluate a node into the terms of a parametric composition.
+   * @param terms  terms[0] is the constant part, terms[p + 1] the coefficients of parameter p.
+   * @param mult   Numeric multiplier from parent groups.
+   * @param term   Term the parent groups' parameter selects (0 if none).
+   */
+  virtual void evaluate(std::vector<Composition> &terms, uint64_t mult, size_t term) const = 0;
 };
 
 /**
@@ -32,10 +60,35 @@ struct ElementNode final : Node {
   std::string symbol;
   uint64_t count{1};
 
-  explicit ElementNode(std::string_view sym, uint64_t count) : symbol{sym}, count{count} {}
+  /// Atomic number of the symbol (0 if not in the periodic table).
+  ElementId id{0};
+
+  /// Input position of the count (of the symbol if it has none).
+  size_t offset{0};
+
+  explicit ElementNode(std::string_view sym, uint64_t count) : symbol{sym}, count{count}, id{element_id(sym)} {}
 
   void evaluate(ElementCountDict &out, uint64_t mult) const override {
-    out[symbol] += count * mult;
+    auto &total = out[symbol];
+    total = at_offset(offset, [&] { return checked_add(total, checked_mul(count, mult)); });
+  }
+
+  void evaluate(Composition &out, uint64_t mult) const override {
+    if (id != 0) {
+      at_offset(offset, [&] { out.add(id, checked_mul(count, mult)); });
+    }
+  }
+
+  void evaluate(WideComposition &out, wide_count mult) const override {
+    if (id != 0) {
+      at_offset(offset, [&] { out.add(id, checked_mul(wide_count{count}, mult)); });
+    }
+  }
+
+  void evaluate(std::vector<Composition> &terms, uint64_t mult, size_t term) const override {
+    if (id != 0) {
+      at_offset(offset, [&] { terms[term].add(id, checked_mul(count, mult)); });
+    }
   }
 };
 
@@ -45,20 +98,57 @@ struct ElementNode final : Node {
  * Example: "(SO4)3" produces a GroupNode with
  *   children = { ElementNode{"S", 1}, ElementNode{"O", 4} }
  *   multiplier = 3
+ *
+ * A parameter multiplier ("(CH2)n") leaves multiplier at 1 and sets term.
  */
 struct GroupNode final : Node {
   std::vector<std::unique_ptr<Node>> children;
   uint64_t multiplier{1};
 
+  /// Parametric term of the multiplier (0 = numeric, p + 1 = parameter p).
+  size_t term{0};
+
+  /// Source text: brackets and multiplier included (units: prefix included).
+  std::string_view text;
+
+  /// Input position of the multiplier (of the group if it has none).
+  size_t offset{0};
+
   explicit GroupNode(uint64_t mult = 1) : multiplier{mult} {}
 
   void evaluate(ElementCountDict &out, uint64_t mult) const override {
-    const uint64_t next_mult = mult * multiplier;
+    const uint64_t next_mult = at_offset(offset, [&] { return checked_mul(mult, multiplier); });
+
+    for (const auto &child : children) {
+      child->evaluate(out, next_mult);
+    }
+  }
+
+  void evaluate(Composition &out, uint64_t mult) const override {
+    const uint64_t next_mult = at_offset(offset, [&] { return checked_mul(mult, multiplier); });
 
     for (const auto &child : children) {
       child->evaluate(out, next_mult);
     }
   }
+
+  void evaluate(WideComposition &out, wide_count mult) const override {
+    const wide_count next_mult = at_offset(offset, [&] { return checked_mul(mult, wide_count{multiplier}); });
+
+    for (const auto &child : children) {
+      child->evaluate(out, next_mult);
+    }
+  }
+
+  // the parser rejects a parameter inside a parametric group, so at most one level sets term
+  void evaluate(std::vector<Composition> &terms, uint64_t mult, size_t parent_term) const override {
+    const uint64_t next_mult = at_offset(offset, [&] { return checked_mul(mult, multiplier); });
+    const size_t next_term = (term != 0) ? term : parent_term;
+
+    for (const auto &child : children) {
+      child->evaluate(terms, next_mult, next_term);
+    }
+  }
 };
 
 }  // namespace cfp
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint64_t
+#include <string_view>
+#include <vector>
+
+#include "cfp/composition.hpp"
+
+namespace cfp {
+
+struct GroupNode;
+
+/**
+ * @struct Subtotal
+ * @brief Contribution of one part of a formula to its total.
+ *
+ * The source text is kept as a position in the parsed input rather than a
+ * view of it, so a subtotal stays valid after the input is gone; text()
+ * recovers it from the same input.
+ */
+struct Subtotal {
+  /// Position of the source text in the input: a unit with its prefix ("5H2O") or a group with
+  /// brackets and multiplier ("(SO4)3").
+  size_t offset{0};
+
+  /// Length of the source text.
+  size_t length{0};
+
+  /// Index of the unit (for a group: of the unit containing it).
+  size_t unit{0};
+
+  /// Own multiplier: the unit prefix or the group suffix.
+  uint64_t multiplier{1};
+
+  /// Counts with all multipliers applied, so the parts sum to the total.
+  SparseComposition counts;
+
+  /**
+   * @brief Source text, e.g. "5H2O".
+   * @param input  The formula this subtotal was parsed from.
+   * @throws std::out_of_range if @a input is shorter than offset.
+   */
+  [[nodiscard]] std::string_view text(std::string_view input) const {
+    return input.substr(offset, length);
+  }
+
+  bool operator==(const Subtotal &) const = default;
+};
+
+/**
+ * @struct Breakdown
+ * @brief Total composition with subtotals per '*' unit and per top-level group.
+ *
+ * Example: "CuSO4*5H2O" => total {H: 10, O: 9, S: 1, Cu: 1},
+ *          units {"CuSO4": {O: 4, S: 1, Cu: 1}, "5H2O": {H: 10, O: 5}}
+ */
+struct Breakdown {
+  Composition total;
+
+  /// One subtotal per '*'-separated unit, in input order.
+  std::vector<Subtotal> units;
+
+  /// One subtotal per bracketed group directly inside a unit, in input order (if requested).
+  std::vector<Subtotal> groups;
+
+  bool operator==(const Breakdown &) const = default;
+};
+
+namespace detail {
+
+/**
+ * @brief Evaluate a parsed tree unit by unit (used by BasicParser::parseBreakdown()).
+ * @param root    Root of BasicParser's tree: one GroupNode child per unit.
+ * @param input   The parsed input, which the tree's source texts view.
+ * @param groups  Also record the top-level groups of each unit.
+ * @throws OverflowError if a count exceeds 64 bits.
+ */
+Breakdown evaluate_breakdown(const GroupNode &root, std::string_view input, bool groups);
+
+}  // namespace detail
+
+}  // namespace cfp
@@ -0,0 +1,123 @@
+/*
+ * C interface to the formula parser, for FFI callers (Python, Rust, Go, ...).
+ *
+ * Every function is callable from C, never lets a C++ exception escape and
+ * reports failures as cfp_status codes. Results go to caller-owned buffers;
+ * the library allocates nothing the caller has to free.
+ *
+ * The functions are part of the static cfp library and of the shared
+ * library cfp_c (libcfp_c.so), which exports nothing else and is what
+ * ctypes, cffi or cgo load.
+ */
+#pragma once
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* int32_t, uint8_t, uint64_t */
+
+/** Exported from the shared library, which hides everything else. */
+#if defined(__GNUC__)
+#define CFP_API __attribute__((visibility("default")))
+#else
+#define CFP_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bump on any incompatible change of the functions or codes below (and the SOVERSION of cfp_c). */
+#define CFP_C_API_VERSION 2
+
+/**
+ * @brief Result codes, returned by the functions and stored per formula.
+ *
+ * The values are part of the ABI and never change.
+ */
+typedef enum cfp_status {
+  CFP_OK = 0,                     /**< Success. */
+  CFP_ERROR_TOKENIZER = 1,        /**< Invalid character, number or whitespace. */
+  CFP_ERROR_PARSER = 2,           /**< Grammar error or unknown element symbol. */
+  CFP_ERROR_OVERFLOW = 3,         /**< A count exceeds 64 bits. */
+  CFP_ERROR_CAPACITY = 4,         /**< Output buffers too small; see the required size. */
+  CFP_ERROR_INVALID_ARGUMENT = 5, /**< Null pointer where a buffer is needed. */
+  CFP_ERROR_INTERNAL = 6,         /**< Out of memory or another unexpected failure. */
+  CFP_ERROR_LIMIT = 7             /**< Input exceeds one of the cfp_limits passed to the call. */
+} cfp_status;
+
+/**
+ * @brief Static description of a status code, e.g. "parser error".
+ * @return Never NULL ("unknown status" for values outside cfp_status).
+ */
+CFP_API const char *cfp_status_string(int32_t status);
+
+/**
+ * @brief Resource limits for untrusted input (see cfp::ParseLimits).
+ *
+ * Passed to each call, so no limits persist between calls or depend on the
+ * calling thread. A field of 0 imposes no limit, so a zero-initialized
+ * struct means none. An input exceeding a limit is rejected with
+ * CFP_ERROR_LIMIT and the offset where it was detected.
+ */
+typedef struct cfp_limits {
+  size_t max_length;  /**< Input length in bytes. */
+  size_t max_depth;   /**< Nesting depth of '(' and '[' groups. */
+  size_t max_tokens;  /**< Tokens lexed. */
+  size_t max_units;   /**< '*'-separated units. */
+  uint64_t max_count; /**< Every number in the input and every evaluated element count. */
+} cfp_limits;
+
+/**
+ * @brief Parse one formula into (element ID, count) pairs.
+ *
+ * Pairs are written in ascending element ID (atomic number) order.
+ *
+ * @param formula      Formula bytes (need not be NUL-terminated).
+ * @param length       Number of bytes in @a formula.
+ * @param limits       Optional (may be NULL for none); limits for untrusted input.
+ * @param element_ids  Receives up to @a capacity element IDs.
+ * @param counts       Receives up to @a capacity counts.
+ * @param capacity     Size of both output arrays (118 always suffices).
+ * @param written      Receives the number of pairs (also on CFP_ERROR_CAPACITY).
+ * @param error_offset Optional (may be NULL); receives the byte offset of the error (0 on success),
+ *                     for an overflow that of the count or multiplier that overflowed.
+ * @return             CFP_OK or an error code; nothing is written to the arrays on error.
+ */
+CFP_API int32_t cfp_parse(const char *formula, size_t length, const cfp_limits *limits, uint8_t *element_ids,
+                          uint64_t *counts, size_t capacity, size_t *written, size_t *error_offset);
+
+/**
+ * @brief Parse many formulas in one call, optionally on several threads.
+ *
+ * The pairs of all formulas are packed into @a element_ids / @a counts;
+ * formula i owns the range [offsets[i], offsets[i + 1]). A formula that
+ * fails gets an empty range and its code in @a statuses; the others are
+ * unaffected.
+ *
+ * If the pairs do not fit, nothing is written to the pair arrays,
+ * @a offsets and @a statuses are still filled, *required holds the needed
+ * capacity and CFP_ERROR_CAPACITY is returned; calling again with larger
+ * buffers (or sizing them as 118 * count up front) succeeds.
+ *
+ * @param formulas       @a count formula pointers.
+ * @param lengths        Byte length of each formula, or NULL if all are NUL-terminated.
+ * @param count          Number of formulas.
+ * @param limits         Optional (may be NULL for none); limits applied to each formula.
+ * @param element_ids    Receives the element IDs of all formulas.
+ * @param counts         Receives the matching counts.
+ * @param capacity       Size of @a element_ids and @a counts.
+ * @param offsets        Receives count + 1 range boundaries.
+ * @param statuses       Receives count per-formula status codes.
+ * @param error_offsets  Optional (may be NULL); receives count error byte offsets (0 on success).
+ * @param threads        Worker threads (0 = hardware concurrency, 1 = calling thread only).
+ * @param required       Optional (may be NULL); receives the total number of pairs.
+ * @return               CFP_OK once every formula has a status, or CFP_ERROR_CAPACITY,
+ *                       CFP_ERROR_INVALID_ARGUMENT or CFP_ERROR_INTERNAL for the call as a whole.
+ */
+CFP_API int32_t cfp_parse_batch(const char *const *formulas, const size_t *lengths, size_t count,
+                                const cfp_limits *limits, uint8_t *element_ids, uint64_t *counts, size_t capacity,
+                                size_t *offsets, int32_t *statuses, size_t *error_offsets, unsigned threads,
+                                size_t *required);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <utility>  // forward
+
+#include "cfp/error/overflow_error.hpp"
+
+namespace cfp {
+
+namespace detail {
+
+/// Out-of-line throw keeps the checked helpers small enough to inline.
+[[noreturn]] void throw_count_overflow(const char *operation);
+
+}  // namespace detail
+
+/**
+ * @brief Product of two counts, throwing OverflowError instead of wrapping.
+ *
+ * Compiles to the plain multiply plus one never-taken branch on the
+ * overflow flag (__builtin_mul_overflow).
+ *
+ * @tparam T  Unsigned count type (uint64_t or wide_count).
+ */
+template <typename T>
+[[nodiscard]] inline T checked_mul(T lhs, T rhs) {
+  T result;
+
+  if (__builtin_mul_overflow(lhs, rhs, &result)) [[unlikely]] {
+    detail::throw_count_overflow("multiplier product exceeds the count range");
+  }
+
+  return result;
+}
+
+/**
+ * @brief Sum of two counts, throwing OverflowError instead of wrapping.
+ * @tparam T  Unsigned count type (uint64_t or wide_count).
+ */
+template <typename T>
+[[nodiscard]] inline T checked_add(T lhs, T rhs) {
+  T result;
+
+  if (__builtin_add_overflow(lhs, rhs, &result)) [[unlikely]] {
+    detail::throw_count_overflow("element count exceeds the count range");
+  }
+
+  return result;
+}
+
+/**
+ * @brief Run one checked step of evaluating a formula.
+ *
+ * An OverflowError thrown by @a step is rethrown with the input position
+ * of the multiplier or count being applied.
+ *
+ * @param offset  Input position of that multiplier or count.
+ * @return        Result of @a step.
+ */
+template <typename F>
+decltype(auto) at_offset(size_t offset, F &&step) {
+  try {
+    return std::forward<F>(step)();
+  } catch (const OverflowError &error) {
+    throw OverflowError{error, offset};
+  }
+}
+
+}  // namespace cfp
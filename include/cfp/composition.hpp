@@ -0,0 +1,305 @@
+#pragma once
+
+#include <array>
+#include <bit>  // countr_zero, popcount
+#include <cstddef>  // size_t, ptrdiff_t
+#include <cstdint>  // uint64_t
+#include <iterator>  // forward_iterator_tag
+#include <stdexcept>  // out_of_range
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>  // pair
+#include <vector>
+
+#include "cfp/checked.hpp"
+#include "cfp/element.hpp"
+
+namespace cfp {
+
+/**
+ * @class Composition
+ * @brief Dense element-count vector indexed by element ID (atomic number).
+ *
+ * Counts live in a fixed, padded array so that arithmetic, comparison and
+ * subset tests are straight loops the compiler vectorizes; a presence bitmask
+ * tracks the non-zero slots for fast emptiness/subset checks and for
+ * iteration. Iteration is deterministic: ascending element ID.
+ *
+ * Example: "H2O" => counts[1] = 2, counts[8] = 1, mask = {1, 8}
+ */
+class Composition {
+public:
+  using count_type = uint64_t;
+
+  /// Number of count slots (element IDs 0..127; slot 0 is always zero).
+  static constexpr size_t CAPACITY = 128;
+
+  /// Number of 64-bit words in the presence mask.
+  static constexpr size_t MASK_WORDS = CAPACITY / 64;
+
+  using Entry = std::pair<ElementId, count_type>;
+
+  /**
+   * @class const_iterator
+   * @brief Forward iterator over (element ID, count) of present elements.
+   */
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Entry;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Entry;
+
+    const_iterator() = default;
+
+    Entry operator*() const noexcept {
+      return {static_cast<ElementId>(slot_), owner_->counts_[slot_]};
+    }
+
+    const_iterator &operator++() noexcept {
+      seek(slot_ + 1);
+      return *this;
+    }
+
+    const_iterator operator++(int) noexcept {
+      auto copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    bool operator==(const const_iterator &other) const noexcept {
+      return slot_ == other.slot_;
+    }
+
+  private:
+    friend class Composition;
+
+    const Composition *owner_{nullptr};
+    size_t slot_{CAPACITY};
+
+    const_iterator(const Composition *owner, size_t from) noexcept : owner_{owner} {
+      seek(from);
+    }
+
+    /// Move to the first present slot at or after @a from.
+    void seek(size_t from) noexcept;
+  };
+
+  Composition() = default;
+
+  /**
+   * @brief Count of an element.
+   * @param id  Element ID.
+   * @return    Count, or 0 if absent.
+   */
+  [[nodiscard]] count_type operator[](ElementId id) const noexcept {
+    return id < CAPACITY ? counts_[id] : 0;
+  }
+
+  /**
+   * @brief Count of an element given by symbol.
+   * @param symbol  Element symbol, e.g. "Fe".
+   * @return        Count, or 0 if absent or unknown.
+   */
+  [[nodiscard]] count_type count(std::string_view symbol) const noexcept {
+    return (*this)[element_id(symbol)];
+  }
+
+  /**
+   * @brief Add atoms of a single element.
+   * @param id     Element ID (1..ELEMENT_COUNT).
+   * @param count  Number of atoms to add.
+   * @throws std::out_of_range if @a id is CAPACITY or more.
+   * @throws OverflowError     if the count leaves the count range.
+   */
+  void add(ElementId id, count_type count) {
+    if (id >= CAPACITY) {
+      throw std::out_of_range{"element ID beyond the composition capacity"};
+    }
+
+    counts_[id] = checked_add(counts_[id], count);
+    if (count != 0) {
+      mask_[id / 64] |= uint64_t{1} << (id % 64);
+    }
+  }
+
+  /// Check whether an element is present.
+  [[nodiscard]] bool contains(ElementId id) const noexcept {
+    return id < CAPACITY && ((mask_[id / 64] >> (id % 64)) & 1U) != 0;
+  }
+
+  /// True if no element is present.
+  [[nodiscard]] bool empty() const noexcept {
+    return (mask_[0] | mask_[1]) == 0;
+  }
+
+  /// Number of distinct elements present.
+  [[nodiscard]] size_t size() const noexcept {
+    return static_cast<size_t>(std::popcount(mask_[0]) + std::popcount(mask_[1]));
+  }
+
+  /**
+   * @brief Total number of atoms.
+   * @throws OverflowError if the sum exceeds the count range.
+   */
+  [[nodiscard]] count_type total() const;
+
+  /// Remove all elements.
+  void clear() noexcept;
+
+  /// Presence bitmask: bit @c id of word @c id/64 is set iff the element is present.
+  [[nodiscard]] const std::array<uint64_t, MASK_WORDS> &mask() const noexcept {
+    return mask_;
+  }
+
+  /// Raw dense counts (indexed by element ID).
+  [[nodiscard]] const std::array<count_type, CAPACITY> &counts() const noexcept {
+    return counts_;
+  }
+
+  [[nodiscard]] const_iterator begin() const noexcept {
+    return {this, 0};
+  }
+
+  [[nodiscard]] const_iterator end() const noexcept {
+    return {};
+  }
+
+  /**
+   * @brief Element-wise sum.
+   * @throws OverflowError if a count leaves the count range (counts are then unspecified).
+   */
+  Composition &operator+=(const Composition &other);
+
+  /**
+   * @brief Element-wise difference.
+   * @throws std::underflow_error if @a other is not a subset of this composition.
+   */
+  Composition &operator-=(const Composition &other);
+
+  /**
+   * @brief Multiply every count by @a factor.
+   * @throws OverflowError if a count leaves the count range (counts are then unspecified).
+   */
+  Composition &operator*=(count_type factor);
+
+  friend Composition operator+(Composition lhs, const Composition &rhs) {
+    return lhs += rhs;
+  }
+
+  friend Composition operator-(Composition lhs, const Composition &rhs) {
+    return lhs -= rhs;
+  }
+
+  friend Composition operator*(Composition lhs, count_type factor) {
+    return lhs *= factor;
+  }
+
+  friend bool operator==(const Composition &lhs, const Composition &rhs) noexcept;
+
+  /**
+   * @brief Subset test: every count in this is <= the count in @a other.
+   */
+  [[nodiscard]] bool isSubsetOf(const Composition &other) const noexcept;
+
+  /**
+   * @brief Greatest common divisor of all present counts (0 if empty).
+   */
+  [[nodiscard]] count_type gcd() const noexcept;
+
+  /**
+   * @brief Empirical formula: all counts divided by their GCD.
+   *
+   * Example: C6H12O6 => CH2O
+   */
+  [[nodiscard]] Composition empirical() const noexcept;
+
+  /**
+   * @brief Convert to an element-symbol map.
+   */
+  [[nodiscard]] std::unordered_map<std::string, count_type> toDict() const;
+
+private:
+  // SparseComposition::toDense() fills these directly
+  friend class SparseComposition;
+
+  alignas(64) std::array<count_type, CAPACITY> counts_{};
+  std::array<uint64_t, MASK_WORDS> mask_{};
+
+  /// Rebuild the presence mask from the counts.
+  void updateMask() noexcept;
+};
+
+/**
+ * @brief Render a composition as a canonical formula in Hill order.
+ *
+ * Carbon first, then hydrogen, then the rest alphabetically; without carbon
+ * all elements are alphabetical. Counts of 1 are omitted, so the result
+ * parses back to the same composition: {C: 6, H: 12, O: 6} => "C6H12O6".
+ *
+ * @param comp  Composition to render.
+ * @return      Formula string (empty for an empty composition).
+ */
+std::string to_string(const Composition &comp);
+
+/**
+ * @class SparseComposition
+ * @brief Sorted (element ID, count) list: a compact form for short formulas.
+ *
+ * Costs 16 bytes per distinct element instead of the fixed dense footprint,
+ * which makes it cheaper to store, copy and compare in bulk. Entries are
+ * kept sorted by element ID, so iteration order matches Composition; they
+ * only come from a Composition or a checked sum, so every ID is below
+ * Composition::CAPACITY and appears once.
+ */
+class SparseComposition {
+public:
+  using count_type = Composition::count_type;
+  using Entry = Composition::Entry;
+
+  SparseComposition() = default;
+
+  /// Compress a dense composition.
+  explicit SparseComposition(const Composition &dense);
+
+  /// Expand to the dense form (cannot fail: entry IDs are unique and in range).
+  [[nodiscard]] Composition toDense() const noexcept;
+
+  /// Count of an element (binary search), or 0 if absent.
+  [[nodiscard]] count_type operator[](ElementId id) const noexcept;
+
+  [[nodiscard]] const std::vector<Entry> &entries() const noexcept {
+    return entries_;
+  }
+
+  [[nodiscard]] size_t size() const noexcept {
+    return entries_.size();
+  }
+
+  [[nodiscard]] bool empty() const noexcept {
+    return entries_.empty();
+  }
+
+  [[nodiscard]] auto begin() const noexcept {
+    return entries_.begin();
+  }
+
+  [[nodiscard]] auto end() const noexcept {
+    return entries_.end();
+  }
+
+  /**
+   * @brief Element-wise sum (sorted merge).
+   * @throws OverflowError if a count leaves the count range.
+   */
+  SparseComposition &operator+=(const SparseComposition &other);
+
+  bool operator==(const SparseComposition &) const = default;
+
+private:
+  std::vector<Entry> entries_;
+};
+
+}  // namespace cfp
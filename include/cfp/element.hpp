@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t
+#include <string_view>
+
+namespace cfp {
+
+/// Element identifier: the atomic number (1..118), 0 for an unknown symbol.
+using ElementId = uint8_t;
+
+/// Number of known elements (H..Og).
+inline constexpr size_t ELEMENT_COUNT = 118;
+
+/**
+ * @brief Periodic table symbols indexed by atomic number.
+ *
+ * Index 0 is reserved for "no element" and holds an empty symbol.
+ */
+// clang-format off
+inline constexpr std::array<std::string_view, ELEMENT_COUNT + 1> ELEMENT_SYMBOLS = {
+  "",
+  "H",  "He", "Li", "Be", "B",  "C",  "N",  "O",  "F",  "Ne",
+  "Na", "Mg", "Al", "Si", "P",  "S",  "Cl", "Ar", "K",  "Ca",
+  "Sc", "Ti", "V",  "Cr", "Mn", "Fe", "Co", "Ni", "Cu", "Zn",
+  "Ga", "Ge", "As", "Se", "Br", "Kr", "Rb", "Sr", "Y",  "Zr",
+  "Nb", "Mo", "Tc", "Ru", "Rh", "Pd", "Ag", "Cd", "In", "Sn",
+  "Sb", "Te", "I",  "Xe", "Cs", "Ba", "La", "Ce", "Pr", "Nd",
+  "Pm", "Sm", "Eu", "Gd", "Tb", "Dy", "Ho", "Er", "Tm", "Yb",
+  "Lu", "Hf", "Ta", "W",  "Re", "Os", "Ir", "Pt", "Au", "Hg",
+  "Tl", "Pb", "Bi", "Po", "At", "Rn", "Fr", "Ra", "Ac", "Th",
+  "Pa", "U",  "Np", "Pu", "Am", "Cm", "Bk", "Cf", "Es", "Fm",
+  "Md", "No", "Lr", "Rf", "Db", "Sg", "Bh", "Hs", "Mt", "Ds",
+  "Rg", "Cn", "Nh", "Fl", "Mc", "Lv", "Ts", "Og"
+};
+// clang-format on
+
+namespace detail {
+
+/**
+ * @brief Symbol lookup table indexed by [first letter][second letter].
+ *
+ * Column 0 holds one-letter symbols, columns 1..26 the lowercase 'a'..'z'.
+ */
+inline constexpr auto SYMBOL_TABLE = [] {
+  std::array<std::array<ElementId, 27>, 26> table{};
+
+  for (size_t id = 1; id <= ELEMENT_COUNT; id++) {
+    const auto symbol = ELEMENT_SYMBOLS[id];
+    const auto row = static_cast<size_t>(symbol[0] - 'A');
+    const auto col = symbol.size() > 1 ? static_cast<size_t>(symbol[1] - 'a') + 1 : 0;
+    table[row][col] = static_cast<ElementId>(id);
+  }
+
+  return table;
+}();
+
+}  // namespace detail
+
+/**
+ * @brief Look up the atomic number of an element symbol.
+ *
+ * @param symbol  Element symbol, e.g. "Fe" (case-sensitive).
+ * @return        Atomic number, or 0 if the symbol is not in the periodic table.
+ */
+constexpr ElementId element_id(std::string_view symbol) noexcept {
+  if (symbol.empty() || symbol.size() > 2 || symbol[0] < 'A' || symbol[0] > 'Z') {
+    return 0;
+  }
+
+  const auto row = static_cast<size_t>(symbol[0] - 'A');
+
+  if (symbol.size() == 1) {
+    return detail::SYMBOL_TABLE[row][0];
+  }
+
+  if (symbol[1] < 'a' || symbol[1] > 'z') {
+    return 0;
+  }
+
+  return detail::SYMBOL_TABLE[row][static_cast<size_t>(symbol[1] - 'a') + 1];
+}
+
+/**
+ * @brief Get the symbol of an element.
+ *
+ * @param id  Atomic number.
+ * @return    Element symbol, or an empty view for unknown IDs.
+ */
+constexpr std::string_view element_symbol(ElementId id) noexcept {
+  return id <= ELEMENT_COUNT ? ELEMENT_SYMBOLS[id] : std::string_view{};
+}
+
+}  // namespace cfp
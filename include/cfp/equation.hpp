@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // int64_t, uint64_t
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/element.hpp"
+
+namespace cfp {
+
+/**
+ * @struct Species
+ * @brief One formula of an equation side with its stoichiometric coefficient.
+ *
+ * Example: "3CO" => {formula: "CO", coefficient: 3, composition: {C: 1, O: 1}}
+ */
+struct Species {
+  /// Formula text as written, without the coefficient.
+  std::string formula;
+
+  /// Stoichiometric coefficient (1 if none was written).
+  uint64_t coefficient{1};
+
+  /// Element counts of one formula unit (not scaled by the coefficient).
+  Composition composition;
+
+  bool operator==(const Species &) const = default;
+};
+
+/**
+ * @struct Equation
+ * @brief Parsed chemical equation: reactants -> products.
+ */
+struct Equation {
+  std::vector<Species> reactants;
+  std::vector<Species> products;
+
+  bool operator==(const Equation &) const = default;
+};
+
+/**
+ * @brief Parse an equation such as "Fe2O3 + 3CO -> 2Fe + 3CO2".
+ *
+ * Sides are separated by "->" or '='; species by '+'. Each species is an
+ * optional coefficient followed by a formula of the full grammar (a leading
+ * number is always the coefficient, so "2H2O" is two water molecules).
+ * Whitespace is allowed around operators only.
+ *
+ * @throws TokenizerError on lex errors.
+ * @throws ParserError    on grammar errors or symbols not in the periodic table.
+ * @throws OverflowError  if a count exceeds 64 bits.
+ */
+Equation parse_equation(std::string_view input);
+
+/**
+ * @brief Render an equation, omitting coefficients of 1.
+ * @return e.g. "Fe2O3 + 3CO -> 2Fe + 3CO2"
+ */
+std::string to_string(const Equation &equation);
+
+/**
+ * @brief Check that every element occurs equally often on both sides.
+ * @throws OverflowError if a side's total exceeds 64 bits.
+ */
+bool is_balanced(const Equation &equation);
+
+/**
+ * @class Balancer
+ * @brief Finds the smallest positive integer coefficients of an equation.
+ *
+ * Builds the element-by-species matrix (reactant counts positive, product
+ * counts negative) and reduces it to row echelon form with fraction-free
+ * integer elimination: every row update is a cross-multiplication followed by
+ * division by the row's gcd, so all entries stay exact integers. The
+ * one-dimensional null space then yields the coefficients.
+ *
+ * The matrix and pivot buffers are kept between calls; a Balancer reused for
+ * many reactions stops allocating once it has seen the largest one. Not
+ * thread-safe; use one balancer per thread.
+ */
+class Balancer {
+public:
+  Balancer() = default;
+
+  /**
+   * @brief Overwrite the coefficients of @a equation with a balancing.
+   *
+   * Coefficients written in the input are ignored.
+   *
+   * @throws std::invalid_argument if the reaction has no balancing with all
+   *         coefficients positive, or more than one independent balancing.
+   * @throws OverflowError if an intermediate value exceeds 64 bits.
+   */
+  void balance(Equation &equation);
+
+private:
+  /// Row-major element-by-species matrix.
+  std::vector<int64_t> matrix_;
+
+  /// Pivot column of each echelon row.
+  std::vector<size_t> pivots_;
+
+  /// Coefficients being solved for, one per species.
+  std::vector<int64_t> solution_;
+
+  size_t rows_{0};
+  size_t cols_{0};
+
+  [[nodiscard]] int64_t &at(size_t row, size_t col) noexcept {
+    return matrix_[(row * cols_) + col];
+  }
+
+  void build(const Equation &equation);
+  void eliminate();
+  void solve();
+};
+
+/**
+ * @brief Balance an equation with a temporary Balancer.
+ * @see Balancer::balance
+ */
+void balance(Equation &equation);
+
+/**
+ * @struct BalancedReaction
+ * @brief Outcome of one reaction of a batch.
+ */
+struct BalancedReaction {
+  /// Balanced equation (as parsed if balancing failed; empty if parsing failed).
+  Equation equation;
+
+  /// Error message, empty on success.
+  std::string error;
+
+  [[nodiscard]] bool ok() const noexcept {
+    return error.empty();
+  }
+};
+
+/**
+ * @brief Parse and balance many reactions in parallel.
+ *
+ * Reactions are handed out dynamically to the workers; each worker reuses
+ * one Balancer. A failing reaction records its error and does not stop the
+ * batch.
+ *
+ * @param reactions  Equation strings.
+ * @param threads    Worker threads (0 = hardware concurrency).
+ * @return           One result per reaction, in input order.
+ */
+std::vector<BalancedReaction> balance_batch(std::span<const std::string_view> reactions, unsigned threads = 0);
+
+}  // namespace cfp
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cfp {
+
+/**
+ * @enum DiagnosticKind
+ * @brief Category of a problem found by a recovering parse.
+ */
+enum class DiagnosticKind : uint8_t {
+  /// Character that cannot start any token (e.g. 'c', '$').
+  UnexpectedCharacter,
+
+  /// Whitespace inside the formula.
+  Whitespace,
+
+  /// Zero or leading-zero number.
+  InvalidNumber,
+
+  /// Number, multiplier product or count beyond the count range.
+  CountOverflow,
+
+  /// Element symbol not in the periodic table.
+  UnknownElement,
+
+  /// Closing ')' or ']' without a matching opener.
+  UnmatchedCloser,
+
+  /// '(' or '[' never closed (or closed by the wrong kind).
+  UnclosedGroup,
+
+  /// Group without content: "()".
+  EmptyGroup,
+
+  /// Unit without content: "H2O**H2O", "*H2O", "H2O*".
+  EmptyUnit,
+
+  /// Token in a position where the grammar does not allow it.
+  UnexpectedToken
+};
+
+/**
+ * @brief Convert a DiagnosticKind to a human-readable name.
+ *
+ * @param kind  DiagnosticKind to stringify.
+ * @return      String literal representation.
+ */
+constexpr std::string_view to_string(DiagnosticKind kind) noexcept {
+  // clang-format off
+  switch (kind) {
+    case DiagnosticKind::UnexpectedCharacter: return "UnexpectedCharacter";
+    case DiagnosticKind::Whitespace:          return "Whitespace";
+    case DiagnosticKind::InvalidNumber:       return "InvalidNumber";
+    case DiagnosticKind::CountOverflow:       return "CountOverflow";
+    case DiagnosticKind::UnknownElement:      return "UnknownElement";
+    case DiagnosticKind::UnmatchedCloser:     return "UnmatchedCloser";
+    case DiagnosticKind::UnclosedGroup:       return "UnclosedGroup";
+    case DiagnosticKind::EmptyGroup:          return "EmptyGroup";
+    case DiagnosticKind::EmptyUnit:           return "EmptyUnit";
+    case DiagnosticKind::UnexpectedToken:     [[fallthrough]];
+    default:                                  return "UnexpectedToken";
+  }
+  // clang-format on
+}
+
+/**
+ * @struct Diagnostic
+ * @brief One problem found by a recovering parse.
+ */
+struct Diagnostic {
+  /// Zero-based index in the input where the problem starts.
+  size_t offset{0};
+
+  DiagnosticKind kind{DiagnosticKind::UnexpectedToken};
+
+  /// Short description of the problem.
+  std::string message;
+};
+
+/// Caller-provided collection of diagnostics (appended to, never cleared).
+using DiagnosticSink = std::vector<Diagnostic>;
+
+}  // namespace cfp
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint64_t
+#include <stdexcept>  // runtime_error
+#include <string_view>
+
+#include "cfp/limits.hpp"
+
+namespace cfp {
+
+/**
+ * @class LimitError
+ * @brief Exception thrown when an input exceeds a ParseLimits bound.
+ *
+ * Reported instead of any later tokenizer or parser error, so callers can
+ * tell hostile or oversized input apart from malformed formulas.
+ */
+class LimitError final : public std::runtime_error {
+public:
+  /// Zero-based position where the limit was exceeded (the input length for evaluated counts).
+  size_t offset{0};
+
+  /// Limit that was exceeded.
+  LimitKind kind{LimitKind::Length};
+
+  /// Configured value of that limit.
+  uint64_t limit{0};
+
+  /**
+   * @brief Construct a new LimitError.
+   *
+   * The exception’s what() message is formatted as:
+   *   "Limit exceeded: <msg> (limit <lim>) at pos <pos> (kind=<kind>)"
+   *
+   * @param pos   Position of the violation.
+   * @param knd   Limit that was exceeded.
+   * @param lim   Configured value of that limit.
+   * @param msg   Short description of the violation.
+   */
+  LimitError(size_t pos, LimitKind knd, uint64_t lim, std::string_view msg);
+};
+
+}  // namespace cfp
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <optional>
+#include <stdexcept>  // overflow_error
+#include <string_view>
+
+namespace cfp {
+
+/**
+ * @class OverflowError
+ * @brief Exception thrown when an element count or multiplier product
+ *        does not fit the count type.
+ *
+ * Raised by checked evaluation instead of silently wrapping around; callers
+ * that need larger counts can evaluate with WideComposition.
+ */
+class OverflowError final : public std::overflow_error {
+public:
+  /**
+   * @brief Zero-based input position of the multiplier or count that overflowed.
+   *
+   * For an element without a count it is the symbol, for a unit its prefix
+   * multiplier. Empty for arithmetic outside parsing (e.g. Composition::operator+=).
+   */
+  std::optional<size_t> offset;
+
+  /**
+   * @brief Construct a new OverflowError.
+   *
+   * The exception’s what() message is formatted as:
+   *   "Count overflow: <msg>"
+   *
+   * @param msg  Short description of the overflowing operation.
+   */
+  explicit OverflowError(std::string_view msg);
+
+  /**
+   * @brief Attribute an overflow to an input position.
+   *
+   * The exception’s what() message is formatted as:
+   *   "<cause.what()> at pos <pos>"
+   *
+   * @param cause  Overflow raised by the checked arithmetic.
+   * @param pos    Position of the multiplier or count.
+   */
+  OverflowError(const OverflowError &cause, size_t pos);
+};
+
+}  // namespace cfp
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <stdexcept>  // runtime_error
+#include <string_view>
+
+#include "cfp/error/diagnostic.hpp"
+
+namespace cfp {
+
+/**
+ * @class StreamError
+ * @brief Exception thrown when a streamed formula is invalid.
+ *
+ * The input is never held in one piece, so instead of a token slice it
+ * carries the absolute stream position and the category of the problem.
+ */
+class StreamError final : public std::runtime_error {
+public:
+  /// Zero-based position in the whole stream where the error occurred.
+  size_t offset{0};
+
+  /// Category of the problem (shared with recovering diagnostics).
+  DiagnosticKind kind{DiagnosticKind::UnexpectedToken};
+
+  /**
+   * @brief Construct a new StreamError.
+   *
+   * The exception’s what() message is formatted as:
+   *   "<msg> at pos <pos> (kind=<kind>)"
+   *
+   * @param pos   Absolute stream position of the error.
+   * @param knd   Category of the error.
+   * @param msg   Short description of the error condition.
+   */
+  StreamError(size_t pos, DiagnosticKind knd, std::string_view msg);
+};
+
+}  // namespace cfp
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint32_t, uint64_t
+#include <span>
+#include <string_view>
+#include <utility>  // pair
+#include <vector>
+
+#include "cfp/limits.hpp"
+
+namespace cfp {
+
+struct GroupNode;
+
+/// Canonical 64-bit hash of a bracketed group's content.
+using GroupFingerprint = uint64_t;
+
+/**
+ * @struct GroupCount
+ * @brief A group fingerprint and how many copies of the group a formula holds.
+ */
+struct GroupCount {
+  GroupFingerprint fingerprint{0};
+
+  /// Copies, i.e. the group's own multiplier times all enclosing ones.
+  uint64_t count{0};
+
+  bool operator==(const GroupCount &) const = default;
+};
+
+/**
+ * @struct FormulaFingerprints
+ * @brief Group fingerprints of a parsed formula (see BasicParser::parseFingerprints()).
+ */
+struct FormulaFingerprints {
+  /// Every bracketed group, one entry per distinct fingerprint, ordered by fingerprint.
+  std::vector<GroupCount> groups;
+
+  /// Fingerprint of each unit's content in input order (a unit that is one group: that group's content).
+  std::vector<GroupFingerprint> units;
+
+  bool operator==(const FormulaFingerprints &) const = default;
+};
+
+/**
+ * @brief Fingerprint of a motif such as "(SO4)", "[Fe(CN)6]" or "NO3".
+ *
+ * The fingerprint covers the group's normalized content, never its own
+ * multiplier: element counts are merged and ordered by element ID, and
+ * nested groups contribute their fingerprint with their summed multiplier.
+ * So "(SO4)", "[O4S]" and "(SO2O2)" agree, while "(S(O)4)" differs.
+ *
+ * @param motif   Group content, or one bracketed group (its multiplier is ignored).
+ * @param limits  Resource limits for untrusted input (default: none).
+ * @throws TokenizerError, ParserError on an invalid motif or unknown symbols.
+ * @throws LimitError            if the motif exceeds @a limits.
+ * @throws std::invalid_argument if the motif has '*' units or a unit multiplier.
+ */
+GroupFingerprint group_fingerprint(std::string_view motif, const ParseLimits &limits = {});
+
+/**
+ * @brief Fingerprints of every bracketed subgroup of a formula.
+ *
+ * Example: "K4[Fe(CN)6]" => {[Fe(CN)6]: 1, (CN): 6}
+ *
+ * @param formula  Formula string.
+ * @param limits   Resource limits for untrusted input (default: none).
+ * @return         One entry per distinct fingerprint, ordered by fingerprint.
+ * @throws TokenizerError, ParserError on invalid input or unknown symbols.
+ * @throws LimitError     if the formula exceeds @a limits.
+ * @throws OverflowError  if a copy count exceeds 64 bits.
+ */
+std::vector<GroupCount> group_fingerprints(std::string_view formula, const ParseLimits &limits = {});
+
+/**
+ * @struct MotifMatch
+ * @brief A record containing a motif.
+ */
+struct MotifMatch {
+  /// Index of the record in the indexed corpus.
+  size_t record{0};
+
+  /// Copies of the motif in the record.
+  uint64_t count{0};
+
+  bool operator==(const MotifMatch &) const = default;
+};
+
+/**
+ * @class FingerprintIndex
+ * @brief Inverted index from group fingerprints to the records holding them.
+ *
+ * Built once over a corpus (in parallel); afterwards "which records contain
+ * motif X, and how many times" is a binary search plus a contiguous scan,
+ * without re-parsing. Postings are stored flat: sorted unique fingerprints,
+ * one offset per fingerprint, then 32-bit record indices and copy counts.
+ *
+ * Example:
+ *   auto index = cfp::FingerprintIndex::build(formulas);
+ *   for (auto [record, count] : index.find("(SO4)")) { ... }
+ */
+class FingerprintIndex {
+public:
+  FingerprintIndex() = default;
+
+  /**
+   * @brief Index the bracketed groups of every record.
+   * @param formulas  One formula per record.
+   * @param threads   Worker threads (0 = hardware concurrency).
+   * @param limits    Limits for each record and for the motifs passed to find() later.
+   * @throws TokenizerError, ParserError, LimitError of the first invalid record (lowest index).
+   * @throws OverflowError         if a copy count exceeds 64 bits.
+   * @throws std::invalid_argument if there are 2^32 records or more.
+   */
+  static FingerprintIndex build(std::span<const std::string_view> formulas, unsigned threads = 0,
+                                const ParseLimits &limits = {});
+
+  /// Records containing the group, ascending, with their copy counts.
+  [[nodiscard]] std::vector<MotifMatch> find(GroupFingerprint fingerprint) const;
+
+  /**
+   * @brief Records containing a motif (see group_fingerprint()).
+   * @throws TokenizerError, ParserError, std::invalid_argument on an invalid motif.
+   * @throws LimitError if the motif exceeds the limits of build().
+   */
+  [[nodiscard]] std::vector<MotifMatch> find(std::string_view motif) const;
+
+  /// Number of records containing the group.
+  [[nodiscard]] size_t recordCount(GroupFingerprint fingerprint) const noexcept;
+
+  /// Number of indexed records.
+  [[nodiscard]] size_t size() const noexcept {
+    return records_;
+  }
+
+  /// Distinct group fingerprints in the corpus, ascending.
+  [[nodiscard]] std::span<const GroupFingerprint> fingerprints() const noexcept {
+    return fingerprints_;
+  }
+
+private:
+  size_t records_{0};
+
+  /// Limits of build(), also applied to motifs.
+  ParseLimits limits_;
+
+  std::vector<GroupFingerprint> fingerprints_;
+
+  /// Postings of fingerprints_[i] are [offsets_[i], offsets_[i + 1]).
+  std::vector<size_t> offsets_;
+
+  std::vector<uint32_t> record_ids_;
+  std::vector<uint64_t> counts_;
+
+  /// Posting range of a fingerprint (empty if absent).
+  [[nodiscard]] std::pair<size_t, size_t> postings(GroupFingerprint fingerprint) const noexcept;
+};
+
+namespace detail {
+
+/**
+ * @brief Fingerprint the groups of a parsed tree (used by BasicParser::parseFingerprints()).
+ * @param root  Root of BasicParser's tree: one GroupNode child per unit.
+ * @throws OverflowError if a copy count exceeds 64 bits.
+ */
+FormulaFingerprints fingerprint_tree(const GroupNode &root);
+
+}  // namespace detail
+
+}  // namespace cfp
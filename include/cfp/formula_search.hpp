@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>  // uint32_t
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/element.hpp"
+
+namespace cfp {
+
+/**
+ * @struct ElementRange
+ * @brief Allowed count range of one element in a formula search.
+ */
+struct ElementRange {
+  ElementId element{0};
+  uint32_t min{0};
+  uint32_t max{0};
+};
+
+/**
+ * @struct FormulaFilter
+ * @brief Chemistry filters applied to mass-matching candidates.
+ *
+ * The defaults accept every mass match.
+ */
+struct FormulaFilter {
+  /// Minimum ring-and-double-bond equivalents (RDBE); e.g. 0 for neutral molecules.
+  double min_rdbe{-std::numeric_limits<double>::infinity()};
+
+  /// Maximum RDBE.
+  double max_rdbe{std::numeric_limits<double>::infinity()};
+
+  /// Require an integer RDBE (even-electron neutral molecules).
+  bool integer_rdbe{false};
+
+  /// Apply the Seven Golden Rules heuristics (Kind & Fiehn, 2007): rules 2, 4, 5 and 6.
+  bool golden_rules{false};
+};
+
+/**
+ * @struct FormulaQuery
+ * @brief Target mass, tolerance and element constraints of a formula search.
+ */
+struct FormulaQuery {
+  /// Target neutral monoisotopic mass (Da).
+  double mass{0.0};
+
+  /// Absolute mass tolerance (Da); for ppm use mass * ppm * 1e-6.
+  double tolerance{1e-3};
+
+  /// Elements and their count ranges, e.g. {{6, 0, 50}, {1, 0, 100}}.
+  std::vector<ElementRange> elements;
+
+  FormulaFilter filter;
+};
+
+/**
+ * @struct FormulaCandidate
+ * @brief A composition matching a formula query.
+ */
+struct FormulaCandidate {
+  Composition composition;
+
+  /// Monoisotopic mass of the composition (Da).
+  double mass{0.0};
+
+  /// mass - query mass (Da).
+  double error{0.0};
+
+  /// Ring-and-double-bond equivalents.
+  double rdbe{0.0};
+};
+
+/**
+ * @brief Ring-and-double-bond equivalents: 1 + sum(n_i * (v_i - 2)) / 2.
+ *
+ * Uses the lowest common valence of each element (C 4, N 3, O 2, H 1, ...).
+ */
+double rdbe(const Composition &comp) noexcept;
+
+/**
+ * @brief Check the Seven Golden Rules heuristics 2 (LEWIS/SENIOR), 4 (H/C),
+ *        5 (heteroatom/C ratios) and 6 (NOPS probability).
+ */
+bool passes_golden_rules(const Composition &comp) noexcept;
+
+/**
+ * @brief Enumerate all compositions matching a target mass.
+ *
+ * Branch-and-bound over the elements ordered by mass: a branch is cut as soon
+ * as its lightest completion is above, or its heaviest completion below, the
+ * tolerance window; the last element's count is solved directly. The counts
+ * of the heaviest element are distributed over the worker threads.
+ *
+ * @param query    Target mass, tolerance, element ranges and filters.
+ * @param threads  Worker threads (0 = hardware concurrency).
+ * @return         Candidates ordered by absolute mass error (then by composition).
+ * @throws std::invalid_argument on invalid ranges or elements without isotope data.
+ */
+std::vector<FormulaCandidate> find_formulas(const FormulaQuery &query, unsigned threads = 0);
+
+/**
+ * @brief Run many formula searches, distributing whole queries over threads.
+ *
+ * @param queries  Queries to run.
+ * @param threads  Worker threads (0 = hardware concurrency).
+ * @return         One result list per query, in input order.
+ */
+std::vector<std::vector<FormulaCandidate>> find_formulas_batch(std::span<const FormulaQuery> queries,
+                                                               unsigned threads = 0);
+
+}  // namespace cfp
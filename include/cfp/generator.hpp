@@ -0,0 +1,161 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>  // ptrdiff_t
+#include <exception>  // exception_ptr
+#include <iterator>  // default_sentinel_t, input_iterator_tag
+#include <memory>  // addressof
+#include <type_traits>  // remove_reference_t
+#include <utility>  // exchange
+
+namespace cfp {
+
+/**
+ * @class Generator
+ * @brief Minimal lazy coroutine generator (a stand-in for C++23 std::generator).
+ *
+ * The coroutine runs only when the consumer advances: begin() runs it up to
+ * the first co_yield, each increment up to the next one. It is an input
+ * range, so it is consumed by a single pass, typically a range-for.
+ * An exception leaving the coroutine is rethrown by begin() or operator++.
+ *
+ * Example:
+ *   cfp::Generator<int> count(int n) {
+ *     for (int i = 0; i < n; i++) co_yield i;
+ *   }
+ *   for (int &i : count(3)) { ... }
+ *
+ * Yielded values are referenced, not copied: a reference is valid until the
+ * iterator is next advanced, and the consumer may move from it.
+ */
+template <typename T>
+class Generator {
+public:
+  using value_type = std::remove_reference_t<T>;
+
+  class promise_type {
+  public:
+    Generator get_return_object() noexcept {
+      return Generator{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+
+    std::suspend_always initial_suspend() const noexcept {
+      return {};
+    }
+
+    std::suspend_always final_suspend() const noexcept {
+      return {};
+    }
+
+    std::suspend_always yield_value(value_type &value) noexcept {
+      current_ = std::addressof(value);
+      return {};
+    }
+
+    // a yielded temporary lives until the coroutine resumes
+    std::suspend_always yield_value(value_type &&value) noexcept {
+      current_ = std::addressof(value);
+      return {};
+    }
+
+    void return_void() const noexcept {}
+
+    void unhandled_exception() noexcept {
+      error_ = std::current_exception();
+    }
+
+    /// Generators only yield; they never await.
+    template <typename U>
+    std::suspend_never await_transform(U &&) = delete;
+
+  private:
+    friend class Generator;
+
+    value_type *current_{nullptr};
+    std::exception_ptr error_;
+  };
+
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = Generator::value_type;
+
+    iterator() = default;
+
+    value_type &operator*() const noexcept {
+      return *handle_.promise().current_;
+    }
+
+    iterator &operator++() {
+      resume(handle_);
+      return *this;
+    }
+
+    void operator++(int) {
+      ++*this;
+    }
+
+    friend bool operator==(const iterator &it, std::default_sentinel_t) noexcept {
+      return !it.handle_ || it.handle_.done();
+    }
+
+  private:
+    friend class Generator;
+
+    std::coroutine_handle<promise_type> handle_;
+
+    explicit iterator(std::coroutine_handle<promise_type> handle) noexcept : handle_{handle} {}
+  };
+
+  Generator(Generator &&other) noexcept : handle_{std::exchange(other.handle_, nullptr)} {}
+
+  Generator &operator=(Generator &&other) noexcept {
+    if (this != &other) {
+      destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+
+  Generator(const Generator &) = delete;
+  Generator &operator=(const Generator &) = delete;
+
+  /// Destroying an unfinished generator destroys the suspended coroutine (and its locals).
+  ~Generator() {
+    destroy();
+  }
+
+  /// Run to the first value; call once.
+  iterator begin() {
+    resume(handle_);
+    return iterator{handle_};
+  }
+
+  std::default_sentinel_t end() const noexcept {
+    return {};
+  }
+
+private:
+  std::coroutine_handle<promise_type> handle_;
+
+  explicit Generator(std::coroutine_handle<promise_type> handle) noexcept : handle_{handle} {}
+
+  static void resume(std::coroutine_handle<promise_type> handle) {
+    if (handle && !handle.done()) {
+      handle.resume();
+
+      if (auto error = std::exchange(handle.promise().error_, nullptr)) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  void destroy() noexcept {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+};
+
+}  // namespace cfp
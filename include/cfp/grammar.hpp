@@ -0,0 +1,99 @@
+#pragma once
+
+#include <concepts>  // convertible_to
+
+namespace cfp {
+
+/**
+ * @struct FullGrammar
+ * @brief Grammar policy with every feature of the formula language enabled.
+ *
+ * Tokenizer and Parser are templates over a grammar policy; features switched
+ * off in the policy are removed at compile time (the corresponding characters
+ * are then rejected as unexpected by the tokenizer).
+ *
+ * Custom grammars derive from this one and override single flags:
+ * @code
+ * struct NoLigandGrammar : cfp::FullGrammar {
+ *   static constexpr bool LIGANDS = false;
+ * };
+ * @endcode
+ */
+struct FullGrammar {
+  /// Parenthesized groups: "(...)".
+  static constexpr bool PARENS = true;
+
+  /// Square-bracketed groups: "[...]".
+  static constexpr bool BRACKETS = true;
+
+  /// Units separated by '*', with optional prefix multipliers: "CuSO4*5H2O".
+  static constexpr bool LIGANDS = true;
+
+  /// Multipliers after a closing ')' or ']': "(SO4)3".
+  static constexpr bool GROUP_MULTIPLIERS = true;
+
+  /// Reject element symbols that are not in the periodic table.
+  static constexpr bool STRICT_ELEMENTS = false;
+
+  /// Equation operators '+', "->" and '=' (whitespace allowed around them).
+  static constexpr bool EQUATIONS = false;
+
+  /// Lowercase parameter names as group and unit multipliers: "(C2H4)n", "CuSO4*xH2O".
+  static constexpr bool PARAMETERS = false;
+};
+
+/**
+ * @struct StrictGrammar
+ * @brief Full grammar with periodic-table validation of element symbols.
+ */
+struct StrictGrammar : FullGrammar {
+  static constexpr bool STRICT_ELEMENTS = true;
+};
+
+/**
+ * @struct FlatGrammar
+ * @brief Elements with counts only (e.g. "C12H22O11"): no groups, no ligands.
+ */
+struct FlatGrammar : FullGrammar {
+  static constexpr bool PARENS = false;
+  static constexpr bool BRACKETS = false;
+  static constexpr bool LIGANDS = false;
+  static constexpr bool GROUP_MULTIPLIERS = false;
+};
+
+/**
+ * @struct EquationGrammar
+ * @brief Full grammar plus the equation layer: "Fe2O3 + 3CO -> 2Fe + 3CO2".
+ */
+struct EquationGrammar : FullGrammar {
+  static constexpr bool EQUATIONS = true;
+};
+
+/**
+ * @struct ParametricGrammar
+ * @brief Full grammar plus symbolic multipliers: "H(CH2)nOH", "[Fe(CN)6]x".
+ */
+struct ParametricGrammar : FullGrammar {
+  static constexpr bool PARAMETERS = true;
+};
+
+/**
+ * @concept GrammarPolicy
+ * @brief Requirements on a grammar policy type.
+ */
+template <typename G>
+concept GrammarPolicy = requires {
+  { G::PARENS } -> std::convertible_to<bool>;
+  { G::BRACKETS } -> std::convertible_to<bool>;
+  { G::LIGANDS } -> std::convertible_to<bool>;
+  { G::GROUP_MULTIPLIERS } -> std::convertible_to<bool>;
+  { G::STRICT_ELEMENTS } -> std::convertible_to<bool>;
+  { G::EQUATIONS } -> std::convertible_to<bool>;
+  { G::PARAMETERS } -> std::convertible_to<bool>;
+};
+
+/// True if the grammar has any kind of bracketed group.
+template <GrammarPolicy G>
+inline constexpr bool HAS_GROUPS = G::PARENS || G::BRACKETS;
+
+}  // namespace cfp
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>  // uint16_t
+#include <span>
+
+#include "cfp/composition.hpp"
+#include "cfp/element.hpp"
+
+namespace cfp {
+
+/**
+ * @struct Isotope
+ * @brief A naturally occurring isotope of an element.
+ */
+struct Isotope {
+  /// Atomic number of the element.
+  ElementId element{0};
+
+  /// Mass number (protons + neutrons), e.g. 13 for carbon-13.
+  uint16_t mass_number{0};
+
+  /// Exact atomic mass in unified atomic mass units (Da).
+  double mass{0.0};
+
+  /// Natural abundance as a fraction (isotopes of an element sum to ~1).
+  double abundance{0.0};
+};
+
+/**
+ * @brief Natural isotopes of an element, ordered by mass number.
+ *
+ * Data: NIST/IUPAC representative isotopic compositions.
+ *
+ * @param id  Element ID.
+ * @return    Isotopes, or an empty span for elements without a natural
+ *            isotopic composition (e.g. Tc, Pm, transuranics).
+ */
+std::span<const Isotope> isotopes(ElementId id) noexcept;
+
+/**
+ * @brief Mass of the most abundant isotope of an element.
+ * @return Mass in Da, or 0.0 if the element has no natural isotopes.
+ */
+double monoisotopic_mass(ElementId id) noexcept;
+
+/**
+ * @brief Abundance-weighted mean isotope mass of an element.
+ * @return Mass in Da, or 0.0 if the element has no natural isotopes.
+ */
+double average_mass(ElementId id) noexcept;
+
+/**
+ * @brief Monoisotopic mass of a composition (most abundant isotope of each element).
+ * @throws std::invalid_argument if an element has no natural isotopes.
+ */
+double monoisotopic_mass(const Composition &comp);
+
+/**
+ * @brief Average (molar) mass of a composition.
+ * @throws std::invalid_argument if an element has no natural isotopes.
+ */
+double average_mass(const Composition &comp);
+
+}  // namespace cfp
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>  // uint8_t, uint64_t
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/element.hpp"
+
+namespace cfp {
+
+/**
+ * @enum IsotopeMode
+ * @brief How isotopologue peaks are merged.
+ */
+enum class IsotopeMode : uint8_t {
+  /// Merge peaks closer than IsotopeOptions::resolution (fine structure).
+  Fine,
+
+  /// Merge peaks with the same nominal mass (M, M+1, M+2, ...).
+  Aggregated
+};
+
+/**
+ * @struct IsotopeOptions
+ * @brief Pruning and binning parameters of the isotope-pattern engine.
+ */
+struct IsotopeOptions {
+  /// Merged peaks (also of intermediate patterns) below this probability are dropped.
+  double threshold{1e-6};
+
+  /// Bin width in Da for IsotopeMode::Fine.
+  double resolution{1e-4};
+
+  IsotopeMode mode{IsotopeMode::Aggregated};
+};
+
+/**
+ * @struct Peak
+ * @brief One peak of an isotopic distribution.
+ */
+struct Peak {
+  /// Probability-weighted mean mass of the merged isotopologues (Da).
+  double mass{0.0};
+
+  /// Probability of the peak (absolute, not normalized to the base peak).
+  double probability{0.0};
+
+  /// Nominal mass (sum of mass numbers) of the peak.
+  uint64_t nominal{0};
+};
+
+/// Peaks sorted by ascending mass.
+using IsotopeDistribution = std::vector<Peak>;
+
+/**
+ * @class IsotopeCalculator
+ * @brief Computes pruned isotopic distributions of compositions.
+ *
+ * The pattern of n atoms of an element is built by repeated squaring of the
+ * single-atom pattern; the 2^k powers and the final per-(element, count)
+ * patterns are cached, so formulas sharing elements (as in a batch) reuse
+ * the intermediate results. Patterns are combined by pruned convolution.
+ *
+ * A calculator is not thread-safe; use one per thread.
+ */
+class IsotopeCalculator {
+public:
+  /**
+   * @brief Create a calculator with fixed pruning/binning options.
+   * @param options  Probability threshold, resolution and merge mode.
+   */
+  explicit IsotopeCalculator(IsotopeOptions options = {});
+
+  /**
+   * @brief Isotopic distribution of a composition.
+   * @param comp  Composition, e.g. from Parser::parseComposition().
+   * @return      Peaks sorted by mass (empty for an empty composition).
+   * @throws std::invalid_argument if an element has no natural isotopes.
+   * @throws OverflowError         if a nominal mass exceeds 64 bits.
+   */
+  IsotopeDistribution compute(const Composition &comp);
+
+  /**
+   * @brief Isotopic distributions of many compositions.
+   *
+   * Element patterns computed for one formula are reused by the others.
+   *
+   * @param comps  Compositions to process.
+   * @return       One distribution per composition, in input order.
+   * @throws std::invalid_argument if an element has no natural isotopes.
+   * @throws OverflowError         if a nominal mass exceeds 64 bits.
+   */
+  std::vector<IsotopeDistribution> computeBatch(std::span<const Composition> comps);
+
+  /// Drop all cached element patterns.
+  void clearCache() noexcept;
+
+  [[nodiscard]] const IsotopeOptions &options() const noexcept {
+    return options_;
+  }
+
+private:
+  IsotopeOptions options_;
+
+  /// powers_[id][k]: pattern of 2^k atoms of element id.
+  std::vector<std::vector<IsotopeDistribution>> powers_;
+
+  /// patterns_[id][n]: pattern of n atoms of element id.
+  std::vector<std::unordered_map<uint64_t, IsotopeDistribution>> patterns_;
+
+  /**
+   * @brief Pattern of @a count atoms of one element (cached).
+   */
+  const IsotopeDistribution &elementPattern(ElementId id, uint64_t count);
+
+  /**
+   * @brief Pattern of 2^@a exponent atoms of one element (cached).
+   */
+  const IsotopeDistribution &powerPattern(ElementId id, uint8_t exponent);
+
+  /**
+   * @brief Convolution of two distributions, merged per options, then pruned.
+   *
+   * Both inputs and the result are sorted by bin key (nominal mass if
+   * aggregated, else mass).
+   */
+  [[nodiscard]] IsotopeDistribution convolve(const IsotopeDistribution &lhs, const IsotopeDistribution &rhs) const;
+
+  /**
+   * @brief Sort by mass and merge peaks falling into the same bin.
+   */
+  void merge(IsotopeDistribution &peaks) const;
+
+  /**
+   * @brief Merge adjacent peaks falling into the same bin; @a peaks must be sorted by bin key.
+   */
+  void coalesce(IsotopeDistribution &peaks) const;
+
+  /**
+   * @brief Merge @a peak into @a bin if it falls into the same bin; @a peak must not sort before @a bin.
+   * @return False (and @a bin unchanged) if @a peak starts a new bin.
+   */
+  bool absorb(Peak &bin, const Peak &peak) const noexcept;
+};
+
+/**
+ * @brief Isotopic distribution of a single composition.
+ *
+ * Convenience wrapper for one-off calls; prefer a long-lived IsotopeCalculator
+ * to reuse cached element patterns.
+ */
+IsotopeDistribution isotope_distribution(const Composition &comp, IsotopeOptions options = {});
+
+}  // namespace cfp
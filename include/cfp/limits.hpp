@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t, uint64_t
+#include <limits>
+#include <string_view>
+
+namespace cfp {
+
+/**
+ * @enum LimitKind
+ * @brief Resource limit that rejected an input.
+ */
+enum class LimitKind : uint8_t {
+  /// Input longer than ParseLimits::max_length.
+  Length,
+
+  /// Groups nested deeper than ParseLimits::max_depth.
+  Depth,
+
+  /// More tokens than ParseLimits::max_tokens.
+  Tokens,
+
+  /// More '*'-separated units than ParseLimits::max_units.
+  Units,
+
+  /// Number or element count above ParseLimits::max_count.
+  Count
+};
+
+/**
+ * @brief Convert a LimitKind to a human-readable name.
+ *
+ * @param kind  LimitKind to stringify.
+ * @return      String literal representation.
+ */
+constexpr std::string_view to_string(LimitKind kind) noexcept {
+  // clang-format off
+  switch (kind) {
+    case LimitKind::Length: return "Length";
+    case LimitKind::Depth:  return "Depth";
+    case LimitKind::Tokens: return "Tokens";
+    case LimitKind::Units:  return "Units";
+    case LimitKind::Count:  [[fallthrough]];
+    default:                return "Count";
+  }
+  // clang-format on
+}
+
+/**
+ * @struct ParseLimits
+ * @brief Resource limits for parsing untrusted input.
+ *
+ * Every limit is checked while tokenizing or parsing, as soon as it can be
+ * exceeded, so a violating input is rejected after work proportional to
+ * the limit rather than to the input. The defaults impose no limits.
+ *
+ * Example (public endpoint):
+ *   constexpr cfp::ParseLimits limits{.max_length = 256, .max_depth = 8, .max_count = 1'000'000};
+ *   cfp::Parser parser{formula, limits};
+ */
+struct ParseLimits {
+  static constexpr size_t UNLIMITED = std::numeric_limits<size_t>::max();
+
+  /// Input length in bytes; checked before the first token is lexed.
+  size_t max_length{UNLIMITED};
+
+  /// Nesting depth of '(' and '[' groups ("(OH)2" has depth 1); bounds the parser's recursion.
+  size_t max_depth{UNLIMITED};
+
+  /// Tokens lexed, excluding the end marker.
+  size_t max_tokens{UNLIMITED};
+
+  /// '*'-separated units (in equations: over all species).
+  size_t max_units{UNLIMITED};
+
+  /// Every number in the input and every evaluated element count.
+  uint64_t max_count{std::numeric_limits<uint64_t>::max()};
+};
+
+}  // namespace cfp
@@ -1,46 +1,268 @@
 #pragma once
 
+#include <cctype>  // std::isspace
+#include <cstddef>  // size_t
 #include <cstdint>  // uint64_t
+#include <format>
+#include <limits>
 #include <memory>  // unique_ptr
+#include <optional>
 #include <string>
 #include <string_view>
+#include <type_traits>  // is_same_v
 #include <unordered_map>
+#include <utility>  // move
+#include <vector>
 
 #include "cfp/ast.hpp"
+#include "cfp/breakdown.hpp"
+#include "cfp/composition.hpp"
+#include "cfp/equation.hpp"
+#include "cfp/error/diagnostic.hpp"
+#include "cfp/error/limit_error.hpp"
+#include "cfp/error/overflow_error.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/fingerprint.hpp"
+#include "cfp/grammar.hpp"
+#include "cfp/limits.hpp"
+#include "cfp/parametric.hpp"
 #include "cfp/tokenizer.hpp"
+#include "cfp/wide_composition.hpp"
 
 namespace cfp {
 
 /**
- * @class Parser
+ * @class BasicParser
  * @brief Parses a chemical formula into element counts.
  *
- * Supports:
+ * Supports (each feature subject to the grammar policy):
  *  - single elements & multipliers:                     Fe2        => {Fe: 2}
  *  - multiple elements:                                 H2O        => {H: 2, O: 1}
  *  - nested () and [] with multipliers                  Fe2(SO4)3  => {Fe: 2, S: 3, O: 12}
  *  - ligand groups (*) with optional prefix multipliers CuSO4*5H2O => {Cu: 1, S: 1, O: 9, H: 10}
+ *  - equations (parseEquation(), if G::EQUATIONS)       H2 + O2 -> H2O
+ *  - parameters (parseParametric(), if G::PARAMETERS)   H(CH2)nOH  => {H: 2, O: 1} + n * {C: 1, H: 2}
+ *  - subtotals per unit and group (parseBreakdown())    CuSO4*5H2O => CuSO4 + 5H2O
+ *  - group fingerprints (parseFingerprints())           K4[Fe(CN)6] => {[Fe(CN)6]: 1, (CN): 6}
+ *
+ * Optional ParseLimits bound the input length, nesting depth, token and
+ * unit counts and the evaluated counts; every entry point then throws
+ * LimitError as soon as a bound is exceeded.
+ *
+ * A recovering parser (Recovering = true, constructed with a DiagnosticSink)
+ * reports lex and grammar errors instead of throwing them and
+ * resynchronizes: invalid lexemes and stray tokens are skipped, groups still
+ * open at a '*', at the closer of an outer group or at the end are closed
+ * implicitly. Limits are still enforced. Use it with parseComposition() (see
+ * parse_recovering()). The throwing parser compiles recovery out.
+ *
+ * @tparam G           Grammar policy (see grammar.hpp); disabled features are compiled out.
+ * @tparam Recovering  Report errors to a DiagnosticSink and resynchronize instead of throwing.
  */
-class Parser {
+template <GrammarPolicy G, bool Recovering = false>
+class BasicParser {
 public:
   /**
    * @brief Create a parser for the given formula.
-   * @param input  Non-empty formula string (no whitespace).
+   * @param input   Non-empty formula string (no whitespace).
+   * @param limits  Resource limits for untrusted input (default: none).
    * @throws TokenizerError on any lex error in the first token.
+   * @throws LimitError     if the input is too long.
    */
-  explicit Parser(std::string_view input);
+  explicit BasicParser(std::string_view input, const ParseLimits &limits = {})
+    requires(!Recovering);
+
+  /**
+   * @brief Create a recovering parser for the given formula.
+   * @param input   Formula string (may be empty or invalid).
+   * @param sink    Receives one Diagnostic per problem (not necessarily in input
+   *                order); must outlive the parser.
+   * @param limits  Resource limits for untrusted input (default: none).
+   * @throws LimitError if the input is too long.
+   */
+  BasicParser(std::string_view input, DiagnosticSink &sink, const ParseLimits &limits = {})
+    requires(Recovering);
 
   /**
    * @brief Fully parse and evaluate the formula.
    * @return A map of element symbol to total count.
    * @throws ParserError    on grammar errors (mismatches, empties, etc.)
    * @throws TokenizerError on mid-parse lex errors.
+   * @throws OverflowError  if a count exceeds 64 bits.
    */
   std::unordered_map<std::string, uint64_t> parse();
 
+  /**
+   * @brief Fully parse and evaluate the formula into a dense composition.
+   *
+   * A recovering parser throws only LimitError: unknown symbols are reported
+   * and skipped, and a unit whose counts overflow is reported and left out.
+   *
+   * @return Element counts indexed by element ID.
+   * @throws ParserError    on grammar errors or symbols not in the periodic table.
+   * @throws TokenizerError on mid-parse lex errors.
+   * @throws OverflowError  if a count exceeds 64 bits.
+   */
+  Composition parseComposition();
+
+  /**
+   * @brief Fully parse and evaluate the formula with 128-bit counts.
+   *
+   * Only products and sums are widened: each count and multiplier written in
+   * the input must still fit 64 bits ("C18446744073709551616" is a lex error).
+   *
+   * @return Element counts that may exceed 64 bits.
+   * @throws ParserError    on grammar errors or symbols not in the periodic table.
+   * @throws TokenizerError on mid-parse lex errors, including literals beyond 64 bits.
+   * @throws OverflowError  if a count exceeds 128 bits.
+   */
+  WideComposition parseWide();
+
+  /**
+   * @brief Parse into the total plus per-unit (and per top-level group) subtotals.
+   *
+   * The subtotals come from the same tree walk that computes the total; each
+   * locates its source text in the input (see Subtotal::text()).
+   *
+   * @param groups  Also record each bracketed group directly inside a unit.
+   * @return        Total and subtotals; unit subtotals always sum to the total.
+   * @throws ParserError    on grammar errors or symbols not in the periodic table.
+   * @throws TokenizerError on mid-parse lex errors.
+   * @throws OverflowError  if a count exceeds 64 bits.
+   */
+  Breakdown parseBreakdown(bool groups = false);
+
+  /**
+   * @brief Parse into the fingerprints of every bracketed group and of each unit (see group_fingerprints()).
+   * @return Groups with their copy counts, and one content fingerprint per unit.
+   * @throws ParserError    on grammar errors or symbols not in the periodic table.
+   * @throws TokenizerError on mid-parse lex errors.
+   * @throws OverflowError  if a copy count exceeds 64 bits.
+   */
+  FormulaFingerprints parseFingerprints();
+
+  /**
+   * @brief Parse a chemical equation: species ('+' species)* ("->" | '=') species ('+' species)*.
+   * @return Reactants and products with their coefficients and compositions.
+   * @throws ParserError    on grammar errors or symbols not in the periodic table.
+   * @throws TokenizerError on mid-parse lex errors.
+   * @throws OverflowError  if a count exceeds 64 bits.
+   */
+  Equation parseEquation()
+    requires G::EQUATIONS;
+
+  /**
+   * @brief Parse a formula whose group or unit multipliers may be parameters.
+   *
+   * A parameter may not multiply a group or unit that itself contains a
+   * parameter ("((CH2)n)m"), since the counts would not be linear.
+   *
+   * @return Constant part plus one coefficient composition per parameter.
+   * @throws ParserError    on grammar errors, nested parameters or unknown symbols.
+   * @throws TokenizerError on mid-parse lex errors.
+   * @throws OverflowError  if a count exceeds 64 bits.
+   */
+  ParametricComposition parseParametric()
+    requires G::PARAMETERS;
+
 private:
+  /// Entire input (species text is sliced from it).
+  std::string_view input_;
+
+  /// Resource limits (the tokenizer checks length, tokens and numbers).
+  ParseLimits limits_;
+
+  /// Groups open at the current position.
+  size_t depth_{0};
+
+  /// Open '(' and '[' groups (a recovering parser closes inner groups at an outer closer).
+  size_t open_parens_{0};
+  size_t open_brackets_{0};
+
+  /// Units started so far.
+  size_t unit_count_{0};
+
   /// Lexer for breaking input into tokens.
-  Tokenizer tokenizer_;
+  BasicTokenizer<G, Recovering> tokenizer_;
+
+  /// First element token whose symbol is not in the periodic table.
+  std::optional<Token> unknown_element_;
+
+  /// Parameter names in order of first appearance (if G::PARAMETERS).
+  std::vector<std::string_view> parameter_names_;
+
+  /// First parameter token, reported by the non-parametric entry points.
+  std::optional<Token> first_parameter_;
+
+  /// Parameter multipliers seen so far; a change across a group means nesting.
+  size_t parameter_uses_{0};
+
+  /// Receives the problems of a recovering parser.
+  DiagnosticSink *sink_{nullptr};
+
+  /**
+   * @brief Throw a ParserError, or report it as a diagnostic when recovering.
+   * @param token    Offending token.
+   * @param kind     Diagnostic category.
+   * @param message  Short description, as for the exception.
+   */
+  void fail(const Token &token, DiagnosticKind kind, std::string message) const;
+
+  /**
+   * @brief Report a problem of a recovering parser.
+   * @param offset   Input position of the problem.
+   * @param kind     Diagnostic category.
+   * @param message  Short description.
+   */
+  void report(size_t offset, DiagnosticKind kind, std::string message) const
+    requires(Recovering);
+
+  /**
+   * @brief Evaluate unit by unit, leaving out (and reporting) units that overflow.
+   * @param root  Tree from parseAST() of a recovering parser.
+   * @throws LimitError if a total exceeds max_count.
+   */
+  Composition evaluateRecovering(const GroupNode &root) const
+    requires(Recovering);
+
+  /**
+   * @brief Register a parameter multiplier.
+   * @param token  Parameter token.
+   * @return       Its term index (p + 1 for the p-th distinct name).
+   */
+  size_t parameterTerm(const Token &token);
+
+  /**
+   * @brief Reject a parameter that would multiply another parameter.
+   * @param token        Parameter token of the outer multiplier.
+   * @param uses_before  parameter_uses_ before the multiplied content was parsed.
+   * @throws ParserError if the content used a parameter.
+   */
+  void checkLinear(const Token &token, size_t uses_before) const;
+
+  /// @throws ParserError if the formula has parameters (for numeric evaluation; reported when recovering).
+  void rejectParameters() const;
+
+  /**
+   * @brief Evaluate a tree and apply the count limit to the totals.
+   * @param root    Tree to evaluate.
+   * @param counts  Result (a vector of terms for parametric formulas, each is checked).
+   * @param args    Evaluation arguments after the result.
+   * @throws LimitError    if a total exceeds max_count, or the count range while max_count is set.
+   * @throws OverflowError if a total exceeds the count range and max_count is not set.
+   */
+  template <typename Counts, typename... Args>
+  void evaluateWithin(const GroupNode &root, Counts &counts, Args... args) const;
+
+  /// @throws LimitError if a count exceeds max_count.
+  template <typename Counts>
+  void checkCounts(const Counts &counts) const;
+
+  /// Input position of a token (the input length for End).
+  [[nodiscard]] size_t offsetOf(const Token &token) const noexcept;
+
+  /// Input text in [begin, end) without trailing whitespace.
+  [[nodiscard]] std::string_view sourceText(size_t begin, size_t end) const noexcept;
 
   /**
    * @brief Build AST tree of units separated by *.
@@ -49,6 +271,32 @@ private:
    */
   std::unique_ptr<GroupNode> parseAST();
 
+  /**
+   * @brief Parse one or more units separated by '*', each with an optional prefix multiplier.
+   * @return A GroupNode with one child per unit.
+   */
+  std::unique_ptr<GroupNode> parseUnits();
+
+  /**
+   * @brief Parse the species of one equation side, separated by '+'.
+   * @param side  Receives the species in order.
+   */
+  void parseSide(std::vector<Species> &side)
+    requires G::EQUATIONS;
+
+  /**
+   * @brief Parse one species: [coefficient] units.
+   * @return The species with its formula text and per-unit composition.
+   */
+  Species parseSpecies()
+    requires G::EQUATIONS;
+
+  /**
+   * @brief Check whether a token ends the formula: End, or an equation operator.
+   * @param kind  Token kind to test.
+   */
+  static constexpr bool isTerminator(TokenKind kind) noexcept;
+
   /**
    * @brief Parse a (sub-)formula: zero or more groups up to closing token.
    * @param closing  Token that ends this sub-formula (RParen, RBracket, Star).
@@ -61,10 +309,633 @@ private:
    *  - ElementNode (symbol + optional number), or
    *  - GroupNode (parenthesized/bracketed formula + optional multiplier)
    *
-   * @return ElementNode or GroupNode
+   * @return ElementNode or GroupNode (null for a token skipped when recovering)
    * @throws ParserError if neither element nor paren/bracket is found
    */
   std::unique_ptr<Node> parseGroup();
 };
 
+/// Parser for the full formula grammar.
+using Parser = BasicParser<FullGrammar>;
+
+/// Parser that reports errors to a DiagnosticSink and resynchronizes (see parse_recovering()).
+using RecoveringParser = BasicParser<FullGrammar, true>;
+
+/// Parser for chemical equations.
+using EquationParser = BasicParser<EquationGrammar>;
+
+/// Parser for formulas with parameter multipliers.
+using ParametricParser = BasicParser<ParametricGrammar>;
+
+extern template class BasicParser<FullGrammar>;
+extern template class BasicParser<EquationGrammar>;
+extern template class BasicParser<ParametricGrammar>;
+extern template class BasicParser<FullGrammar, true>;
+
+template <GrammarPolicy G, bool Recovering>
+BasicParser<G, Recovering>::BasicParser(std::string_view input, const ParseLimits &limits)
+  requires(!Recovering)
+    : input_{input}, limits_{limits}, tokenizer_(input, limits) {}
+
+template <GrammarPolicy G, bool Recovering>
+BasicParser<G, Recovering>::BasicParser(std::string_view input, DiagnosticSink &sink, const ParseLimits &limits)
+  requires(Recovering)
+    : input_{input}, limits_{limits}, tokenizer_(input, sink, limits), sink_{&sink} {}
+
+template <GrammarPolicy G, bool Recovering>
+std::unordered_map<std::string, uint64_t> BasicParser<G, Recovering>::parse() {
+  auto root = parseAST();
+  rejectParameters();
+
+  std::unordered_map<std::string, uint64_t> counts;
+  evaluateWithin(*root, counts, /*mult=*/uint64_t{1});
+
+  return counts;
+}
+
+template <GrammarPolicy G, bool Recovering>
+Composition BasicParser<G, Recovering>::parseComposition() {
+  auto root = parseAST();
+  rejectParameters();
+
+  if constexpr (Recovering) {
+    return evaluateRecovering(*root);
+  } else {
+    if (unknown_element_) {
+      throw ParserError{*unknown_element_, std::format("unknown element '{}'", unknown_element_->text)};
+    }
+
+    Composition counts;
+    evaluateWithin(*root, counts, /*mult=*/uint64_t{1});
+
+    return counts;
+  }
+}
+
+template <GrammarPolicy G, bool Recovering>
+WideComposition BasicParser<G, Recovering>::parseWide() {
+  auto root = parseAST();
+  rejectParameters();
+
+  if (unknown_element_) {
+    throw ParserError{*unknown_element_, std::format("unknown element '{}'", unknown_element_->text)};
+  }
+
+  WideComposition counts;
+  evaluateWithin(*root, counts, /*mult=*/wide_count{1});
+
+  return counts;
+}
+
+template <GrammarPolicy G, bool Recovering>
+Breakdown BasicParser<G, Recovering>::parseBreakdown(bool groups) {
+  auto root = parseAST();
+  rejectParameters();
+
+  if (unknown_element_) {
+    throw ParserError{*unknown_element_, std::format("unknown element '{}'", unknown_element_->text)};
+  }
+
+  Breakdown breakdown;
+  evaluateWithin(*root, breakdown, input_, groups);
+
+  return breakdown;
+}
+
+template <GrammarPolicy G, bool Recovering>
+FormulaFingerprints BasicParser<G, Recovering>::parseFingerprints() {
+  auto root = parseAST();
+  rejectParameters();
+
+  if (unknown_element_) {
+    throw ParserError{*unknown_element_, std::format("unknown element '{}'", unknown_element_->text)};
+  }
+
+  return detail::fingerprint_tree(*root);
+}
+
+template <GrammarPolicy G, bool Recovering>
+ParametricComposition BasicParser<G, Recovering>::parseParametric()
+  requires G::PARAMETERS
+{
+  auto root = parseAST();
+
+  if (unknown_element_) {
+    throw ParserError{*unknown_element_, std::format("unknown element '{}'", unknown_element_->text)};
+  }
+
+  std::vector<Composition> terms(parameter_names_.size() + 1);
+  evaluateWithin(*root, terms, /*mult=*/uint64_t{1}, /*term=*/size_t{0});
+
+  return ParametricComposition{{parameter_names_.begin(), parameter_names_.end()}, std::move(terms)};
+}
+
+template <GrammarPolicy G, bool Recovering>
+size_t BasicParser<G, Recovering>::parameterTerm(const Token &token) {
+  if (!first_parameter_) {
+    first_parameter_ = token;
+  }
+
+  parameter_uses_ += 1;
+
+  for (size_t idx = 0; idx < parameter_names_.size(); idx++) {
+    if (parameter_names_[idx] == token.text) {
+      return idx + 1;
+    }
+  }
+
+  parameter_names_.push_back(token.text);
+  return parameter_names_.size();
+}
+
+template <GrammarPolicy G, bool Recovering>
+void BasicParser<G, Recovering>::checkLinear(const Token &token, size_t uses_before) const {
+  if (parameter_uses_ != uses_before) {
+    fail(token, DiagnosticKind::UnexpectedToken,
+         std::format("parameter '{}' multiplies another parameter (counts would not be linear)", token.text));
+  }
+}
+
+template <GrammarPolicy G, bool Recovering>
+void BasicParser<G, Recovering>::rejectParameters() const {
+  if constexpr (G::PARAMETERS) {
+    if (first_parameter_) {
+      fail(*first_parameter_, DiagnosticKind::UnexpectedToken,
+           std::format("formula has parameter '{}'; use parseParametric()", first_parameter_->text));
+    }
+  }
+}
+
+template <GrammarPolicy G, bool Recovering>
+void BasicParser<G, Recovering>::fail(const Token &token, DiagnosticKind kind, std::string message) const {
+  if constexpr (Recovering) {
+    report(offsetOf(token), kind, std::move(message));
+  } else {
+    throw ParserError{token, message};
+  }
+}
+
+template <GrammarPolicy G, bool Recovering>
+void BasicParser<G, Recovering>::report(size_t offset, DiagnosticKind kind, std::string message) const
+  requires(Recovering)
+{
+  sink_->push_back({.offset = offset, .kind = kind, .message = std::move(message)});
+}
+
+template <GrammarPolicy G, bool Recovering>
+Composition BasicParser<G, Recovering>::evaluateRecovering(const GroupNode &root) const
+  requires(Recovering)
+{
+  Composition total;
+
+  for (const auto &child : root.children) {
+    const auto &unit = static_cast<const GroupNode &>(*child);
+
+    // into a copy: an overflowing unit leaves the total as it was
+    Composition sum = total;
+
+    try {
+      unit.evaluate(sum, /*mult=*/uint64_t{1});
+      total = sum;
+    } catch (const OverflowError &error) {
+      const size_t offset = error.offset.value_or(static_cast<size_t>(unit.text.data() - input_.data()));
+      report(offset, DiagnosticKind::CountOverflow, error.what());
+    }
+  }
+
+  if (limits_.max_count != std::numeric_limits<uint64_t>::max()) {
+    checkCounts(total);
+  }
+
+  return total;
+}
+
+template <GrammarPolicy G, bool Recovering>
+template <typename Counts, typename... Args>
+void BasicParser<G, Recovering>::evaluateWithin(const GroupNode &root, Counts &counts, Args... args) const {
+  try {
+    if constexpr (std::is_same_v<Counts, Breakdown>) {
+      counts = detail::evaluate_breakdown(root, args...);
+    } else {
+      root.evaluate(counts, args...);
+    }
+  } catch (const OverflowError &) {
+    if (limits_.max_count == std::numeric_limits<uint64_t>::max()) {
+      throw;
+    }
+
+    throw LimitError{input_.size(), LimitKind::Count, limits_.max_count, "element count beyond the count range"};
+  }
+
+  if (limits_.max_count != std::numeric_limits<uint64_t>::max()) {
+    checkCounts(counts);
+  }
+}
+
+template <GrammarPolicy G, bool Recovering>
+template <typename Counts>
+void BasicParser<G, Recovering>::checkCounts(const Counts &counts) const {
+  const auto check = [this](std::string_view symbol, const auto count) {
+    if (count > limits_.max_count) {
+      throw LimitError{input_.size(), LimitKind::Count, limits_.max_count,
+                       std::format("count of {} is too large", symbol)};
+    }
+  };
+
+  if constexpr (std::is_same_v<Counts, Breakdown>) {
+    checkCounts(counts.total);
+  } else if constexpr (std::is_same_v<Counts, std::vector<Composition>>) {
+    for (const auto &term : counts) {
+      checkCounts(term);
+    }
+  } else if constexpr (std::is_same_v<Counts, WideComposition>) {
+    for (const auto &[id, count] : counts.entries()) {
+      check(ELEMENT_SYMBOLS[id], count);
+    }
+  } else if constexpr (std::is_same_v<Counts, Composition>) {
+    for (const auto [id, count] : counts) {
+      check(ELEMENT_SYMBOLS[id], count);
+    }
+  } else {
+    for (const auto &[symbol, count] : counts) {
+      check(symbol, count);
+    }
+  }
+}
+
+template <GrammarPolicy G, bool Recovering>
+size_t BasicParser<G, Recovering>::offsetOf(const Token &token) const noexcept {
+  return token.kind == TokenKind::End ? input_.size() : static_cast<size_t>(token.text.data() - input_.data());
+}
+
+template <GrammarPolicy G, bool Recovering>
+std::string_view BasicParser<G, Recovering>::sourceText(size_t begin, size_t end) const noexcept {
+  while (end > begin && std::isspace(static_cast<unsigned char>(input_[end - 1]))) {
+    end -= 1;
+  }
+
+  return input_.substr(begin, end - begin);
+}
+
+template <GrammarPolicy G, bool Recovering>
+Equation BasicParser<G, Recovering>::parseEquation()
+  requires G::EQUATIONS
+{
+  // empty equation check
+  if (const auto token = tokenizer_.peek(); token.kind == TokenKind::End) {
+    throw ParserError{token, "empty equation"};
+  }
+
+  Equation equation;
+  parseSide(equation.reactants);
+
+  if (const auto token = tokenizer_.peek(); token.kind != TokenKind::Arrow && token.kind != TokenKind::Equals) {
+    throw ParserError{token, "expected '->' or '=' after reactants"};
+  }
+
+  tokenizer_.next();
+  parseSide(equation.products);
+
+  // no trailing tokens allowed
+  if (const auto token = tokenizer_.peek(); token.kind != TokenKind::End) {
+    throw ParserError{token, std::format("unexpected token '{}' after products", token.text)};
+  }
+
+  return equation;
+}
+
+template <GrammarPolicy G, bool Recovering>
+void BasicParser<G, Recovering>::parseSide(std::vector<Species> &side)
+  requires G::EQUATIONS
+{
+  while (true) {
+    side.push_back(parseSpecies());
+
+    if (tokenizer_.peek().kind != TokenKind::Plus) {
+      break;
+    }
+
+    tokenizer_.next();
+  }
+}
+
+template <GrammarPolicy G, bool Recovering>
+Species BasicParser<G, Recovering>::parseSpecies()
+  requires G::EQUATIONS
+{
+  if (const auto token = tokenizer_.peek(); isTerminator(token.kind)) {
+    throw ParserError{token, "expected species"};
+  }
+
+  // optional coefficient; a leading number is never a unit multiplier here
+  Species species;
+
+  if (const auto token = tokenizer_.peek(); token.kind == TokenKind::Number) {
+    species.coefficient = *token.value;
+    tokenizer_.next();
+  }
+
+  const auto first = tokenizer_.peek();
+
+  if (isTerminator(first.kind)) {
+    throw ParserError{first, std::format("expected formula after coefficient ({})", species.coefficient)};
+  }
+
+  unknown_element_.reset();
+  auto root = parseUnits();
+
+  if (unknown_element_) {
+    throw ParserError{*unknown_element_, std::format("unknown element '{}'", unknown_element_->text)};
+  }
+
+  evaluateWithin(*root, species.composition, /*mult=*/uint64_t{1});
+
+  // the species runs up to the next token, minus the spaces before it
+  species.formula = sourceText(offsetOf(first), offsetOf(tokenizer_.peek()));
+
+  return species;
+}
+
+template <GrammarPolicy G, bool Recovering>
+std::unique_ptr<GroupNode> BasicParser<G, Recovering>::parseAST() {
+  // empty formula check
+  if (const auto token = tokenizer_.peek(); token.kind == TokenKind::End) {
+    fail(token, DiagnosticKind::EmptyUnit, "empty formula");
+    return std::make_unique<GroupNode>(/*mult=*/1);
+  }
+
+  auto root = parseUnits();
+
+  // no trailing tokens allowed
+  if (const auto token = tokenizer_.peek(); token.kind != TokenKind::End) {
+    fail(token, DiagnosticKind::UnexpectedToken, std::format("unexpected token '{}' after unit", token.text));
+  }
+
+  return root;
+}
+
+template <GrammarPolicy G, bool Recovering>
+std::unique_ptr<GroupNode> BasicParser<G, Recovering>::parseUnits() {
+  // top-level group (may contain multiple units separated by Star)
+  auto root = std::make_unique<GroupNode>(/*mult=*/1);
+
+  if constexpr (!G::LIGANDS) {
+    // a single unit without prefix multiplier
+    const size_t begin = offsetOf(tokenizer_.peek());
+    auto unit = parseFormula();
+    unit->text = sourceText(begin, offsetOf(tokenizer_.peek()));
+    root->children.emplace_back(std::move(unit));
+  } else {
+    // one or more units separated by '*'
+    while (true) {
+      if (unit_count_ == limits_.max_units) {
+        throw LimitError{offsetOf(tokenizer_.peek()), LimitKind::Units, limits_.max_units, "too many units"};
+      }
+
+      unit_count_ += 1;
+
+      const size_t begin = offsetOf(tokenizer_.peek());
+
+      // optional prefix multiplier
+      uint64_t unit_mult = 1;
+      std::optional<Token> unit_parameter;
+
+      if (const auto token = tokenizer_.peek(); token.kind == TokenKind::Number) {
+        unit_mult = *token.value;
+        tokenizer_.next();
+      } else if constexpr (G::PARAMETERS) {
+        if (token.kind == TokenKind::Parameter) {
+          unit_parameter = token;
+          tokenizer_.next();
+        }
+      }
+
+      const auto first = tokenizer_.peek();
+      const bool no_formula = first.kind == TokenKind::Star || isTerminator(first.kind);
+
+      if (no_formula) {
+        fail(first, DiagnosticKind::EmptyUnit,
+             unit_parameter ? std::format("expected formula after multiplier ({})", unit_parameter->text)
+                            : std::format("expected formula after multiplier ({})", unit_mult));
+      }
+
+      // parse one formula unit (stops at Star or End)
+      const size_t uses_before = parameter_uses_;
+      auto unit = parseFormula(TokenKind::Star);
+
+      // only a recovering parser gets here with nothing left of the unit
+      if (unit->children.empty() && !no_formula) {
+        fail(tokenizer_.peek(), DiagnosticKind::EmptyUnit, "empty unit between '*'");
+      }
+
+      if (unit_parameter) {
+        checkLinear(*unit_parameter, uses_before);
+        unit->term = parameterTerm(*unit_parameter);
+      }
+
+      unit->multiplier = unit_mult;
+      unit->text = sourceText(begin, offsetOf(tokenizer_.peek()));
+      unit->offset = begin;
+      root->children.emplace_back(std::move(unit));
+
+      // if there is a Star, consume it and handle the next unit
+      if (const auto token = tokenizer_.peek(); token.kind == TokenKind::Star) {
+        tokenizer_.next();
+        continue;
+      }
+
+      // no units left
+      break;
+    }
+  }
+
+  return root;
+}
+
+template <GrammarPolicy G, bool Recovering>
+std::unique_ptr<GroupNode> BasicParser<G, Recovering>::parseFormula(TokenKind closing) {
+  auto group = std::make_unique<GroupNode>(/*mult=*/1);
+
+  while (true) {
+    const auto token = tokenizer_.peek();
+
+    // handle mismatched brackets/paren (only possible with both kinds enabled)
+    if constexpr (G::PARENS && G::BRACKETS) {
+      // clang-format off
+      if ((closing == TokenKind::RParen || closing == TokenKind::RBracket) &&
+          (token.kind == TokenKind::RParen || token.kind == TokenKind::RBracket) &&
+          token.kind != closing) {
+        if constexpr (Recovering) {
+          // the closer of an outer group closes this one implicitly
+          if ((token.kind == TokenKind::RParen ? open_parens_ : open_brackets_) > 0) {
+            break;
+          }
+
+          report(offsetOf(token), DiagnosticKind::UnmatchedCloser, std::format("unmatched '{}'", token.text));
+          tokenizer_.next();
+          continue;
+        } else {
+          throw ParserError{
+            token,
+            std::format(
+              "unmatched '{}' - expected '{}'",
+              token.text, closing == TokenKind::RParen ? ")" : "]"
+            )
+          };
+        }
+      }
+      // clang-format on
+    }
+
+    if (token.kind == closing || isTerminator(token.kind)) {
+      break;  // reached the end of formula
+    }
+
+    // recovering: a '*' closes the open groups implicitly
+    if constexpr (Recovering && G::LIGANDS) {
+      if (token.kind == TokenKind::Star) {
+        break;
+      }
+    }
+
+    if (auto child = parseGroup()) {
+      group->children.emplace_back(std::move(child));
+    }
+  }
+
+  return group;
+}
+
+template <GrammarPolicy G, bool Recovering>
+std::unique_ptr<Node> BasicParser<G, Recovering>::parseGroup() {
+  const auto token = tokenizer_.peek();
+
+  // invalid '*' inside the group
+  if constexpr (G::LIGANDS) {
+    if (token.kind == TokenKind::Star) {
+      throw ParserError{token, "unexpected '*' inside group"};
+    }
+  }
+
+  // invalid closing brackets/paren inside the group
+  if constexpr (HAS_GROUPS<G>) {
+    if (token.kind == TokenKind::RParen || token.kind == TokenKind::RBracket) {
+      fail(token, DiagnosticKind::UnmatchedCloser, std::format("unmatched '{}'", token.text));
+      tokenizer_.next();
+      return nullptr;
+    }
+  }
+
+  // Element [Number]
+  if (token.kind == TokenKind::Element) {
+    tokenizer_.next();
+
+    uint64_t count = 1;
+    size_t count_offset = offsetOf(token);
+
+    if (const auto next_token = tokenizer_.peek(); next_token.kind == TokenKind::Number) {
+      count = *next_token.value;
+      count_offset = offsetOf(next_token);
+      tokenizer_.next();
+    }
+
+    auto element = std::make_unique<ElementNode>(token.text, count);
+    element->offset = count_offset;
+
+    if (element->id == 0) {
+      if (!unknown_element_) {
+        unknown_element_ = token;
+      }
+
+      // a strict-element tokenizer has reported it already
+      if constexpr (Recovering && !G::STRICT_ELEMENTS) {
+        report(offsetOf(token), DiagnosticKind::UnknownElement, std::format("unknown element '{}'", token.text));
+      }
+    }
+
+    return element;
+  }
+
+  // '(' formula ')' [Number] or '[' formula ']' [Number]
+  if constexpr (HAS_GROUPS<G>) {
+    if (token.kind == TokenKind::LParen || token.kind == TokenKind::LBracket) {
+      const bool is_paren = (token.kind == TokenKind::LParen);
+      const auto matching_closer = is_paren ? TokenKind::RParen : TokenKind::RBracket;
+
+      // bounds the recursion below
+      if (depth_ == limits_.max_depth) {
+        throw LimitError{offsetOf(token), LimitKind::Depth, limits_.max_depth, "groups nested too deeply"};
+      }
+
+      tokenizer_.next();
+
+      // parse inner formula up to matching bracket/paren
+      const size_t uses_before = parameter_uses_;
+      auto &open = is_paren ? open_parens_ : open_brackets_;
+      depth_ += 1;
+      open += 1;
+      auto subgroup = parseFormula(matching_closer);
+      depth_ -= 1;
+      open -= 1;
+
+      if (const auto closer = tokenizer_.peek(); closer.kind != matching_closer) {
+        const auto *message = is_paren ? "unmatched '(' - expected ')'" : "unmatched '[' - expected ']'";
+
+        if constexpr (!Recovering) {
+          throw ParserError{closer, message};
+        } else {
+          // closed implicitly, without a multiplier
+          report(offsetOf(token), DiagnosticKind::UnclosedGroup, message);
+          subgroup->text = sourceText(offsetOf(token), offsetOf(closer));
+          return subgroup;
+        }
+      }
+
+      if (subgroup->children.empty()) {
+        fail(token, DiagnosticKind::EmptyGroup, "empty group not allowed");
+      }
+
+      tokenizer_.next();
+
+      // optional multiplier
+      uint64_t group_mult = 1;
+      subgroup->offset = offsetOf(token);
+
+      if constexpr (G::GROUP_MULTIPLIERS) {
+        if (const auto next_token = tokenizer_.peek(); next_token.kind == TokenKind::Number) {
+          group_mult = *next_token.value;
+          subgroup->offset = offsetOf(next_token);
+          tokenizer_.next();
+        } else if constexpr (G::PARAMETERS) {
+          if (next_token.kind == TokenKind::Parameter) {
+            checkLinear(next_token, uses_before);
+            subgroup->term = parameterTerm(next_token);
+            tokenizer_.next();
+          }
+        }
+      }
+
+      subgroup->multiplier = group_mult;
+      subgroup->text = sourceText(offsetOf(token), offsetOf(tokenizer_.peek()));
+      return subgroup;
+    }
+  }
+
+  // anything else is an error
+  fail(token, DiagnosticKind::UnexpectedToken, "expected element or group");
+  tokenizer_.next();
+  return nullptr;
+}
+
+template <GrammarPolicy G, bool Recovering>
+constexpr bool BasicParser<G, Recovering>::isTerminator(TokenKind kind) noexcept {
+  if constexpr (G::EQUATIONS) {
+    if (kind == TokenKind::Plus || kind == TokenKind::Arrow || kind == TokenKind::Equals) {
+      return true;
+    }
+  }
+
+  return kind == TokenKind::End;
+}
+
 }  // namespace cfp
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint64_t
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/limits.hpp"
+#include "cfp/token.hpp"
+#include "cfp/token_kind.hpp"
+#include "cfp/tokenizer.hpp"
+
+namespace cfp {
+
+/**
+ * @class ParserContext
+ * @brief Long-lived parser that keeps its buffers between calls.
+ *
+ * Accepts the same language as cfp::Parser and reports the same errors, but
+ * instead of building a heap-allocated AST per input it keeps a token
+ * buffer, a flat unit table, a multiplier stack and the output composition
+ * alive across calls. Once the buffers have grown to the largest formula
+ * seen, parsing performs no allocations.
+ *
+ * Evaluation walks each unit's tokens right to left: a group multiplier is
+ * then known before the group's content, so a stack of running multipliers
+ * replaces the tree. Hence when several counts of a unit overflow their sum,
+ * OverflowError::offset may name a different one than cfp::Parser does.
+ *
+ * ParseLimits apply to every call, with the same LimitError diagnostics as
+ * cfp::Parser: tokens are lexed as the grammar pass reaches them, so an
+ * input exceeding several limits reports the one the parser reports.
+ *
+ * Not thread-safe; use one context per thread (see forThread()).
+ *
+ * Example:
+ *   cfp::ParserContext ctx;
+ *   for (auto formula : formulas) {
+ *     const auto &comp = ctx.parse(formula);  // valid until the next call
+ *   }
+ */
+class ParserContext {
+public:
+  ParserContext() = default;
+
+  /// Context that rejects inputs exceeding @a limits.
+  explicit ParserContext(const ParseLimits &limits) : limits_{limits} {}
+
+  /**
+   * @brief Parse and evaluate a formula.
+   * @param input  Non-empty formula string.
+   * @return       Element counts; the reference stays valid until the next parse() or reset().
+   * @throws TokenizerError on lex errors.
+   * @throws ParserError    on grammar errors or symbols not in the periodic table.
+   * @throws OverflowError  if a count exceeds 64 bits.
+   * @throws LimitError     if the input exceeds limits().
+   */
+  const Composition &parse(std::string_view input);
+
+  /// Limits applied to each parse().
+  [[nodiscard]] const ParseLimits &limits() const noexcept {
+    return limits_;
+  }
+
+  /// Change the limits, e.g. of a forThread() context.
+  void setLimits(const ParseLimits &limits) noexcept {
+    limits_ = limits;
+  }
+
+  /// Forget the last input and result; buffer capacity is retained.
+  void reset() noexcept;
+
+  /// Result of the last successful parse() (empty after reset() or a failed parse()).
+  [[nodiscard]] const Composition &result() const noexcept {
+    return result_;
+  }
+
+  /// Tokens of the last parse() (without the End token); they view the caller's input.
+  [[nodiscard]] std::span<const Token> tokens() const noexcept;
+
+  /// Context owned by the calling thread.
+  static ParserContext &forThread();
+
+private:
+  /// Tokens of one '*'-separated unit, [begin, end), and its prefix multiplier.
+  struct Unit {
+    size_t begin{0};
+    size_t end{0};
+    uint64_t multiplier{1};
+  };
+
+  /// Lexer of the current parse(); tokens_ holds what it has lexed so far.
+  std::optional<Tokenizer> tokenizer_;
+
+  std::vector<Token> tokens_;
+  std::vector<Unit> units_;
+  std::vector<uint64_t> multipliers_;
+  Composition result_;
+  ParseLimits limits_;
+
+  /// Input of the current parse().
+  std::string_view input_;
+
+  /// Cursor into tokens_ during the grammar pass.
+  size_t pos_{0};
+
+  /// Groups open at pos_.
+  size_t depth_{0};
+
+  /// Token at pos_, lexing it first if needed (by value: lexing may grow tokens_).
+  [[nodiscard]] Token peek();
+
+  void parseUnits();
+  void parseFormula(TokenKind closing);
+  void parseGroup();
+  void evaluate();
+
+  /// Evaluate units_ into result_; @a unknown is set to the leftmost unknown symbol, if any.
+  void evaluateUnits(const Token *&unknown);
+  void checkCounts();
+
+  /// Input position of a token (the input length for End).
+  [[nodiscard]] size_t offsetOf(const Token &token) const noexcept;
+};
+
+}  // namespace cfp
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <concepts>  // convertible_to
+#include <cstddef>  // size_t
+#include <exception>  // exception_ptr
+#include <functional>
+#include <iosfwd>  // istream
+#include <memory>  // make_shared
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>  // forward
+
+#include "cfp/composition.hpp"
+#include "cfp/generator.hpp"
+#include "cfp/limits.hpp"
+
+namespace cfp {
+
+/**
+ * @struct PipelineOptions
+ * @brief Sizes of the pipelined parser's stages and queues.
+ */
+struct PipelineOptions {
+  /// Bytes per read from a stream source.
+  size_t chunk_size{size_t{1} << 16};
+
+  /// Formulas per parse task.
+  size_t batch_size{256};
+
+  /// Chunks or batches buffered between two stages; a full queue blocks the stage feeding it.
+  size_t queue_capacity{8};
+
+  /// Parse workers (0 = hardware concurrency).
+  unsigned threads{0};
+
+  /// Limits applied to each formula; max_length also caps the bytes kept of an overlong line.
+  ParseLimits limits{};
+};
+
+/**
+ * @struct ParsedFormula
+ * @brief One pipeline result: a formula and its composition or error.
+ */
+struct ParsedFormula {
+  /// Position in the input (0-based line or element index).
+  size_t index{0};
+
+  /// The formula as read (without its line terminator).
+  std::string formula;
+
+  /// Element counts, compact so that results are cheap to queue; empty if the formula failed.
+  SparseComposition composition;
+
+  /// The TokenizerError, ParserError, OverflowError or LimitError of a failed formula, else null.
+  std::exception_ptr error;
+
+  [[nodiscard]] bool ok() const noexcept {
+    return !error;
+  }
+
+  /// The composition, or rethrow the formula's error.
+  [[nodiscard]] const SparseComposition &value() const {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return composition;
+  }
+};
+
+/**
+ * @brief Parse newline-separated formulas pulled chunk by chunk, as a pipeline.
+ *
+ * Reading, line splitting and parsing run concurrently, connected by bounded
+ * queues: a stage that gets ahead blocks on its full output queue, so memory
+ * stays bounded and throughput is that of the slowest stage. Parsing runs on
+ * PipelineOptions::threads workers; results are reassembled and yielded in
+ * input order by the consuming coroutine.
+ *
+ * The stages start when the generator is first advanced. Lines end at '\n'
+ * (a preceding '\r' is dropped); no record follows a final newline. A
+ * formula's error is reported in its result and does not stop the pipeline.
+ *
+ * Example:
+ *   std::ifstream file{"formulas.txt"};
+ *   for (auto &result : cfp::parse_lines(file)) {
+ *     if (result.ok()) { use(result.composition); }
+ *   }
+ *
+ * @param pull  Returns the next chunk; an empty view ends the input. Called
+ *              on the reader thread only, so it may block (e.g. on a socket).
+ * @throws std::invalid_argument if an option size is 0 or the source is empty.
+ *
+ * An exception thrown by @a pull is rethrown by the generator after the
+ * results of all lines completed before it. Destroying the generator early
+ * stops the stages; it waits for a pull in progress to return.
+ */
+Generator<ParsedFormula> parse_lines(std::function<std::string_view()> pull, const PipelineOptions &options = {});
+
+/**
+ * @brief Parse newline-separated formulas read from a stream, as a pipeline.
+ * @param input  Source stream; read in chunks until EOF. Must outlive the generator.
+ * @throws std::invalid_argument if an option size is 0 or the source is empty.
+ */
+Generator<ParsedFormula> parse_lines(std::istream &input, const PipelineOptions &options = {});
+
+/**
+ * @brief Parse formulas produced one at a time, as a pipeline (no line splitting).
+ * @param next  Stores the next formula and returns true, or returns false at the end.
+ *              Called on the reader thread only.
+ * @throws std::invalid_argument if an option size is 0 or the source is empty.
+ */
+Generator<ParsedFormula> parse_each(std::function<bool(std::string &)> next, const PipelineOptions &options = {});
+
+/**
+ * @brief Parse a range of formulas (e.g. a lazy view over records), as a pipeline.
+ *
+ * The range is iterated on the reader thread. An lvalue range is referenced
+ * and must outlive the generator; an rvalue container is moved in.
+ *
+ * @param formulas  Range whose elements convert to std::string_view.
+ * @throws std::invalid_argument if an option size is 0 or the source is empty.
+ */
+template <std::ranges::input_range R>
+  requires std::ranges::viewable_range<R> &&
+           std::convertible_to<std::ranges::range_reference_t<R>, std::string_view>
+Generator<ParsedFormula> parse_each(R &&formulas, const PipelineOptions &options = {}) {
+  // built in place: iterators into an owned container must not move
+  struct Cursor {
+    std::views::all_t<R> view;
+    std::ranges::iterator_t<std::views::all_t<R>> it;
+
+    explicit Cursor(R &&range) : view{std::views::all(std::forward<R>(range))}, it{std::ranges::begin(view)} {}
+  };
+
+  auto cursor = std::make_shared<Cursor>(std::forward<R>(formulas));
+
+  return parse_each(
+      [cursor](std::string &formula) {
+        if (cursor->it == std::ranges::end(cursor->view)) {
+          return false;
+        }
+
+        formula = std::string_view{*cursor->it};
+        ++cursor->it;
+        return true;
+      },
+      options);
+}
+
+}  // namespace cfp
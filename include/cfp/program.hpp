@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t, uint64_t
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/element.hpp"
+
+namespace cfp {
+
+/**
+ * @class FormulaProgram
+ * @brief A formula compiled to flat (element ID, folded count) pairs.
+ *
+ * Compilation parses once and folds every nested multiplier into the
+ * counts, so evaluating with an outer scale factor is one multiply per
+ * element. The counts are stored structure-of-arrays and the overflow
+ * bound is checked once per call, so the loop has no per-element branch
+ * and is vectorized. Programs serialize to a compact, endian-independent
+ * byte format and load back without re-parsing.
+ *
+ * Example:
+ *   auto recipe = cfp::FormulaProgram::compile("Fe2(SO4)3");  // O: 12, S: 3, Fe: 2
+ *   auto batch  = recipe.evaluate(250);                        // O: 3000, S: 750, Fe: 500
+ */
+class FormulaProgram {
+public:
+  /// First bytes of every serialized program.
+  static constexpr std::string_view MAGIC = "CFPP";
+
+  /// Serialization format version written by serialize().
+  static constexpr uint8_t FORMAT_VERSION = 1;
+
+  FormulaProgram() = default;
+
+  /// Program that evaluates to @a comp times the scale.
+  explicit FormulaProgram(const Composition &comp);
+
+  /**
+   * @brief Parse and fold a formula.
+   * @throws TokenizerError, ParserError on invalid input (see Parser::parseComposition()).
+   * @throws OverflowError  if a folded count exceeds 64 bits.
+   */
+  static FormulaProgram compile(std::string_view formula);
+
+  /**
+   * @brief Load a program written by serialize().
+   * @throws std::invalid_argument on a bad header, truncated data, or an
+   *         unknown, repeated, unordered or zero-count element.
+   */
+  static FormulaProgram deserialize(std::span<const uint8_t> bytes);
+
+  /// Compact binary form: MAGIC, version, entry count, then (ID, count) pairs, little-endian.
+  [[nodiscard]] std::vector<uint8_t> serialize() const;
+
+  /// Element IDs, ascending.
+  [[nodiscard]] std::span<const ElementId> elements() const noexcept {
+    return ids_;
+  }
+
+  /// Folded counts, parallel to elements().
+  [[nodiscard]] std::span<const uint64_t> counts() const noexcept {
+    return counts_;
+  }
+
+  [[nodiscard]] size_t size() const noexcept {
+    return ids_.size();
+  }
+
+  /**
+   * @brief Scaled counts in program order: out[i] = counts()[i] * scale.
+   * @param out  At least size() slots.
+   * @throws std::invalid_argument if @a out has fewer than size() slots.
+   * @throws OverflowError         if a scaled count exceeds 64 bits (nothing is written).
+   */
+  void evaluate(uint64_t scale, std::span<uint64_t> out) const;
+
+  /**
+   * @brief Real-valued scaling, e.g. for fractional batch sizes: out[i] = counts()[i] * scale.
+   * @throws std::invalid_argument if @a out has fewer than size() slots.
+   */
+  void evaluate(double scale, std::span<double> out) const;
+
+  /**
+   * @brief Scaled composition.
+   * @throws OverflowError if a scaled count exceeds 64 bits.
+   */
+  [[nodiscard]] Composition evaluate(uint64_t scale = 1) const;
+
+  bool operator==(const FormulaProgram &) const = default;
+
+private:
+  std::vector<ElementId> ids_;
+  std::vector<uint64_t> counts_;
+
+  /// Largest folded count; evaluate() checks scale against it once.
+  uint64_t max_count_{0};
+};
+
+}  // namespace cfp
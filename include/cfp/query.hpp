@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>  // uint64_t
+#include <initializer_list>
+#include <span>
+#include <string_view>
+
+#include "cfp/element.hpp"
+
+namespace cfp {
+
+/**
+ * @brief Count one element of a formula without evaluating the others.
+ *
+ * Streams the tokens once; each group contributes only the requested
+ * element's subtotal, scaled by its multiplier when the group closes.
+ *
+ * Example: count_of("Fe2(SO4)3", element_id("O")) == 12
+ *
+ * @param formula  Formula string.
+ * @param id       Element to count.
+ * @return         Total count of @a id (0 if absent).
+ * @throws TokenizerError on lex errors.
+ * @throws ParserError    on unbalanced, mismatched or empty groups, empty units, misplaced numbers or '*'
+ *                        inside a group (the grammar errors cfp::Parser reports).
+ * @throws OverflowError  if the count exceeds 64 bits; its offset is the multiplier being applied, which
+ *                        for nested groups may be an outer one than cfp::Parser names.
+ */
+uint64_t count_of(std::string_view formula, ElementId id);
+
+/**
+ * @brief Count one element given by symbol.
+ * @throws std::invalid_argument if @a symbol is not in the periodic table.
+ */
+uint64_t count_of(std::string_view formula, std::string_view symbol);
+
+/**
+ * @brief Check whether a formula contains any of the given elements.
+ *
+ * Multipliers are always positive, so presence needs no evaluation: the scan
+ * returns at the first matching element. Input after the match is not
+ * checked; a negative answer has lexed the whole formula.
+ *
+ * Example: contains_any("CH2Cl2", {element_id("Cl"), element_id("Br")}) == true
+ *
+ * @param formula  Formula string.
+ * @param ids      Elements to look for.
+ * @return         True if at least one of @a ids occurs.
+ * @throws TokenizerError on lex errors before the first match.
+ */
+bool contains_any(std::string_view formula, std::span<const ElementId> ids);
+
+/// Convenience overload: contains_any(formula, {id1, id2, ...}).
+bool contains_any(std::string_view formula, std::initializer_list<ElementId> ids);
+
+}  // namespace cfp
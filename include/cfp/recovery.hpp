@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string_view>
+
+#include "cfp/composition.hpp"
+#include "cfp/error/diagnostic.hpp"
+#include "cfp/limits.hpp"
+
+namespace cfp {
+
+/**
+ * @brief Parse a formula, reporting every problem instead of stopping at the first.
+ *
+ * Runs a RecoveringParser (see BasicParser): valid input takes the regular
+ * code path and adds no diagnostics. Otherwise each problem is appended to
+ * @a sink and parsing resynchronizes: invalid characters are skipped up to
+ * the next ')', ']', '*', uppercase letter or whitespace, stray tokens are
+ * dropped, and groups left open at '*', at an outer closer or at the end are
+ * closed implicitly. A unit whose counts overflow is left out.
+ *
+ * Example: "Fe2(SO4*3 cl" reports the unclosed '(', the whitespace, the
+ * unexpected 'c' and the empty second unit, and still returns
+ * {Fe: 2, S: 1, O: 4}.
+ *
+ * Other grammars recover the same way through BasicParser<G, true>{input, sink}.parseComposition().
+ *
+ * @param input   Formula string.
+ * @param sink    Receives one Diagnostic per problem, in input order.
+ * @param limits  Resource limits; exceeding one still throws.
+ * @return        Best-effort composition of the well-formed parts.
+ * @throws LimitError if a bound of @a limits is exceeded.
+ */
+Composition parse_recovering(std::string_view input, DiagnosticSink &sink, const ParseLimits &limits = {});
+
+}  // namespace cfp
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t, uint16_t, uint32_t, uint64_t
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/element.hpp"
+
+namespace cfp {
+
+/**
+ * @enum SimilarityMetric
+ * @brief How two compositions are compared, as element-count vectors a and b.
+ */
+enum class SimilarityMetric : uint8_t {
+  /// a.b / (|a|^2 + |b|^2 - a.b), in [0, 1]; higher is closer.
+  Tanimoto,
+
+  /// a.b / (|a| |b|), in [0, 1]; higher is closer.
+  Cosine,
+
+  /// Sum over elements of average mass * |a - b|, in Da; lower is closer.
+  MassDistance
+};
+
+/**
+ * @brief Exact score of two compositions (the reference for SimilarityIndex).
+ * @return Similarity, or distance for MassDistance; 0 similarity if either is empty.
+ */
+double similarity(const Composition &lhs, const Composition &rhs, SimilarityMetric metric) noexcept;
+
+/**
+ * @struct Neighbor
+ * @brief One search result.
+ */
+struct Neighbor {
+  /// Index of the composition in the indexed corpus.
+  size_t record{0};
+
+  /// Similarity (Tanimoto, Cosine) or distance (MassDistance).
+  double score{0.0};
+
+  bool operator==(const Neighbor &) const = default;
+};
+
+/**
+ * @class SimilarityIndex
+ * @brief k-nearest-composition search over a large corpus.
+ *
+ * Records are stored as dense 16-bit count vectors over the elements that
+ * occur in the corpus, padded to a SIMD-friendly width and ordered by norm.
+ * A record with a count beyond 16 bits is quantized by its own power-of-two
+ * shift (see shift()), so its scores are approximate; other records, however
+ * large their neighbors' counts, are stored and scored exactly.
+ *
+ * A query scans blocks of records in parallel, one top-k heap per worker.
+ * Blocks and records whose score bound cannot beat the worker's current
+ * k-th result are skipped without scoring:
+ *  - Tanimoto and Cosine bound a.b by the query norm over the elements the
+ *    record's presence bitmask shares with it; Tanimoto also uses the
+ *    record norm, and sorted norms bound whole blocks.
+ *  - MassDistance is at least the difference of the two formula masses.
+ * The scoring loops have no branches and are vectorized by the compiler.
+ *
+ * Results are ordered best first, ties by ascending record. Similarity
+ * searches return only records with a positive score.
+ */
+class SimilarityIndex {
+public:
+  /// Records per block: the unit of parallel work and of block pruning.
+  static constexpr size_t BLOCK_SIZE = 1024;
+
+  SimilarityIndex() = default;
+
+  /**
+   * @brief Index compositions; record i is @a compositions[i].
+   * @throws std::invalid_argument if there are 2^32 records or more.
+   */
+  explicit SimilarityIndex(std::span<const Composition> compositions);
+
+  /**
+   * @brief Parse and index formulas in parallel.
+   * @param threads  Worker threads (0 = hardware concurrency).
+   * @throws TokenizerError, ParserError of the first invalid formula (lowest index).
+   * @throws OverflowError         if a count exceeds 64 bits.
+   * @throws std::invalid_argument if there are 2^32 formulas or more.
+   */
+  static SimilarityIndex build(std::span<const std::string_view> formulas, unsigned threads = 0);
+
+  /**
+   * @brief The k records closest to a query.
+   * @param threads  Worker threads (0 = hardware concurrency).
+   */
+  [[nodiscard]] std::vector<Neighbor> search(const Composition &query, size_t k, SimilarityMetric metric,
+                                             unsigned threads = 0) const;
+
+  /**
+   * @brief Search for a formula.
+   * @throws TokenizerError, ParserError, OverflowError on an invalid formula.
+   */
+  [[nodiscard]] std::vector<Neighbor> search(std::string_view formula, size_t k, SimilarityMetric metric,
+                                             unsigned threads = 0) const;
+
+  /// Many queries, in parallel across queries; result i belongs to @a queries[i].
+  [[nodiscard]] std::vector<std::vector<Neighbor>> searchBatch(std::span<const Composition> queries, size_t k,
+                                                               SimilarityMetric metric, unsigned threads = 0) const;
+
+  [[nodiscard]] size_t size() const noexcept {
+    return records_.size();
+  }
+
+  /// Vector dimensions: elements occurring in the corpus, ascending.
+  [[nodiscard]] std::span<const ElementId> elements() const noexcept {
+    return columns_;
+  }
+
+  /**
+   * @brief Quantization of a record: its stored counts are counts / 2^shift, rounded.
+   *
+   * Linear in size(); meant for diagnostics.
+   *
+   * @return 0 unless one of the record's counts exceeds 16 bits.
+   * @throws std::out_of_range if @a record >= size().
+   */
+  [[nodiscard]] unsigned shift(size_t record) const;
+
+private:
+  struct Query;
+  class TopK;
+
+  /// Columns per stored vector (elements().size() rounded up to the SIMD width).
+  size_t width_{0};
+
+  std::vector<ElementId> columns_;
+
+  /// Column of each element ID, or -1 if it occurs in no record.
+  std::array<int16_t, Composition::CAPACITY> column_of_{};
+
+  // per stored record, in norm order
+  std::vector<uint16_t> values_;
+  std::vector<std::array<uint64_t, Composition::MASK_WORDS>> masks_;
+  std::vector<float> norms_;
+  std::vector<double> masses_;
+  std::vector<uint8_t> shifts_;
+  std::vector<uint32_t> records_;
+
+  // per block of stored records
+  std::vector<std::array<uint64_t, Composition::MASK_WORDS>> block_masks_;
+  std::vector<float> block_min_norm_;
+  std::vector<float> block_max_norm_;
+  std::vector<double> block_min_mass_;
+  std::vector<double> block_max_mass_;
+
+  static SimilarityIndex fromSparse(std::span<const SparseComposition> compositions);
+
+  [[nodiscard]] Query prepare(const Composition &query, SimilarityMetric metric) const;
+  void scanBlock(const Query &query, size_t block, TopK &top) const;
+};
+
+}  // namespace cfp
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <concepts>  // convertible_to
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t, uint64_t
+#include <functional>
+#include <iosfwd>  // istream
+#include <ranges>
+#include <string_view>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/element.hpp"
+#include "cfp/error/stream_error.hpp"
+
+namespace cfp {
+
+/**
+ * @class StreamParser
+ * @brief Incremental parser for formulas that arrive in chunks.
+ *
+ * Accepts the formulas that cfp::Parser::parseComposition() accepts (so
+ * unknown symbols such as "Xx2" are rejected, unlike Parser::parse()), but
+ * never needs the whole input at once: chunks are fed one by one and tokens
+ * may be split across chunk boundaries ("F|e12", "12|34"). Groups are
+ * evaluated as soon as they close, so memory is one Composition per open
+ * nesting level, independent of the input length. Error offsets are
+ * absolute stream positions; an error is reported as soon as it is seen,
+ * so with several errors the first one may differ from the parser's.
+ *
+ * Example:
+ *   cfp::StreamParser parser;
+ *   parser.feed("Fe2(SO");
+ *   parser.feed("4)3");
+ *   auto comp = parser.finish();  // {Fe: 2, S: 3, O: 12}
+ *
+ * After a StreamError the parser must be reset() before reuse.
+ */
+class StreamParser {
+public:
+  StreamParser();
+
+  /**
+   * @brief Consume the next chunk of the formula.
+   * @param chunk  Next bytes of the stream (may be empty).
+   * @throws StreamError on the first invalid character, token, grammar error or count overflow.
+   */
+  void feed(std::string_view chunk);
+
+  /**
+   * @brief Mark the end of the stream and return the result.
+   *
+   * The parser is reset afterwards and can take a new stream.
+   *
+   * @return Element counts of the whole stream.
+   * @throws StreamError on empty input, unclosed groups or empty units.
+   */
+  Composition finish();
+
+  /// Discard all state (also after a StreamError).
+  void reset() noexcept;
+
+  /// Number of characters consumed so far.
+  [[nodiscard]] size_t offset() const noexcept {
+    return offset_;
+  }
+
+private:
+  /// Token being lexed when a chunk ends.
+  enum class Lexing : uint8_t { None, Element, Number };
+
+  /// What the next Number token would multiply.
+  enum class Pending : uint8_t { None, Element, Group };
+
+  /// Symbol characters kept for lookup; longer symbols are unknown anyway.
+  static constexpr size_t SYMBOL_CAPACITY = 3;
+
+  /// Evaluation state of one nesting level (frames_[0] is the current unit).
+  struct Frame {
+    Composition comp;
+    size_t offset{0};
+    char closer{'\0'};
+    bool filled{false};
+  };
+
+  size_t offset_{0};
+
+  // lexer state
+  Lexing lexing_{Lexing::None};
+  size_t token_start_{0};
+  std::array<char, SYMBOL_CAPACITY> symbol_{};
+  size_t symbol_length_{0};
+  uint64_t number_{0};
+  bool number_overflow_{false};
+  bool number_leading_zero_{false};
+
+  // parser state: frames_ only grows, depth_ is the current level
+  std::vector<Frame> frames_;
+  size_t depth_{0};
+  Composition total_;
+  uint64_t unit_mult_{1};
+  bool unit_mult_seen_{false};
+  Pending pending_{Pending::None};
+  ElementId pending_element_{0};
+
+  /// Start of the pending element or group.
+  size_t pending_offset_{0};
+
+  void dispatch(char chr);
+  void finishToken();
+  void onElement();
+  void onNumber();
+  void onOpen(char closer);
+  void onClose(char closer);
+  void onStar();
+  void endUnit(size_t offset);
+
+  /// Add the pending term times @a mult; an overflow is reported at @a offset (of the multiplier or the term).
+  void resolvePending(uint64_t mult, size_t offset);
+
+  [[noreturn]] static void fail(size_t offset, DiagnosticKind kind, std::string_view message);
+};
+
+/**
+ * @brief Parse a formula pulled chunk by chunk.
+ * @param pull  Returns the next chunk; an empty view ends the stream.
+ * @throws StreamError on invalid input.
+ */
+Composition parse_stream(const std::function<std::string_view()> &pull);
+
+/**
+ * @brief Parse a formula read from a stream (e.g. a pipe) in fixed-size chunks.
+ * @param input       Source stream; read until EOF.
+ * @param chunk_size  Read buffer size in bytes (the only input-sized allocation).
+ * @throws StreamError on invalid input.
+ */
+Composition parse_stream(std::istream &input, size_t chunk_size = size_t{1} << 16);
+
+/**
+ * @brief Parse a formula given as a range of chunks (e.g. a vector of buffers).
+ * @param chunks  Range whose elements convert to std::string_view.
+ * @throws StreamError on invalid input.
+ */
+template <std::ranges::input_range R>
+  requires std::convertible_to<std::ranges::range_reference_t<R>, std::string_view>
+Composition parse_stream(R &&chunks) {
+  StreamParser parser;
+
+  for (auto &&chunk : chunks) {
+    parser.feed(std::string_view{chunk});
+  }
+
+  return parser.finish();
+}
+
+}  // namespace cfp
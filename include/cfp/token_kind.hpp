@@ -31,6 +31,18 @@ enum class TokenKind : uint8_t {
   /// Asterisk '*' used as a ligand/hydrate separator.
   Star,
 
+  /// Plus '+' separating species of an equation side.
+  Plus,
+
+  /// Reaction arrow "->" between reactants and products.
+  Arrow,
+
+  /// Equals sign '=' (alternative reaction arrow).
+  Equals,
+
+  /// Lowercase parameter name in a multiplier position, e.g. "n" in "(C2H4)n".
+  Parameter,
+
   /// EOF marker (no more tokens).
   End,
 
@@ -47,16 +59,20 @@ enum class TokenKind : uint8_t {
 constexpr std::string_view to_string(TokenKind kind) noexcept {
   // clang-format off
   switch (kind) {
-    case TokenKind::Element:  return "Element";
-    case TokenKind::Number:   return "Number";
-    case TokenKind::LParen:   return "LParen";
-    case TokenKind::RParen:   return "RParen";
-    case TokenKind::LBracket: return "LBracket";
-    case TokenKind::RBracket: return "RBracket";
-    case TokenKind::Star:     return "Star";
-    case TokenKind::End:      return "End";
-    case TokenKind::Invalid:  [[fallthrough]];
-    default:                  return "Invalid";
+    case TokenKind::Element:   return "Element";
+    case TokenKind::Number:    return "Number";
+    case TokenKind::LParen:    return "LParen";
+    case TokenKind::RParen:    return "RParen";
+    case TokenKind::LBracket:  return "LBracket";
+    case TokenKind::RBracket:  return "RBracket";
+    case TokenKind::Star:      return "Star";
+    case TokenKind::Plus:      return "Plus";
+    case TokenKind::Arrow:     return "Arrow";
+    case TokenKind::Equals:    return "Equals";
+    case TokenKind::Parameter: return "Parameter";
+    case TokenKind::End:       return "End";
+    case TokenKind::Invalid:   [[fallthrough]];
+    default:                   return "Invalid";
   }
   // clang-format on
 }
@@ -1,36 +1,78 @@
 #pragma once
 
+#include <cassert>
+#include <cctype>  // std::isspace, std::isupper, std::islower, std::isdigit
 #include <cstddef>  // size_t
+#include <cstdint>  // uint64_t
+#include <format>
+#include <limits>
+#include <string>
 #include <string_view>
+#include <utility>  // move
 
+#include "cfp/element.hpp"
+#include "cfp/error/diagnostic.hpp"
+#include "cfp/error/limit_error.hpp"
+#include "cfp/error/tokenizer_error.hpp"
+#include "cfp/grammar.hpp"
+#include "cfp/limits.hpp"
 #include "cfp/token.hpp"
 
 namespace cfp {
 
 /**
- * @class Tokenizer
+ * @class BasicTokenizer
  * @brief Lexical analyzer for chemical-formula tokens.
  *
  * Recognizes the following tokens:
  *   - Element:  uppercase letter followed by zero or more lowercase letters
  *   - Number:   a sequence of digits (positive integer, no leading zeros)
- *   - LParen:   '('
- *   - RParen:   ')'
- *   - LBracket: '['
- *   - RBracket: ']'
- *   - Star:     '*' (ligand separator)
+ *   - LParen:   '('           (if G::PARENS)
+ *   - RParen:   ')'           (if G::PARENS)
+ *   - LBracket: '['           (if G::BRACKETS)
+ *   - RBracket: ']'           (if G::BRACKETS)
+ *   - Star:     '*' (ligand separator, if G::LIGANDS)
+ *   - Plus:     '+'           (if G::EQUATIONS)
+ *   - Arrow:    "->"          (if G::EQUATIONS)
+ *   - Equals:   '='           (if G::EQUATIONS)
+ *   - Parameter: lowercase letters starting a lexeme (if G::PARAMETERS)
  *   - End:      EOF marker
  *
- * Throws TokenizerError on any invalid lexeme.
+ * Whitespace is rejected, except that equation grammars allow it next to
+ * '+', "->" and '=' and at either end of the input.
+ *
+ * Throws TokenizerError on any invalid lexeme, and LimitError when the input
+ * length, the token count or a number exceeds the given ParseLimits. A
+ * recovering tokenizer reports invalid lexemes to a DiagnosticSink instead:
+ * whitespace and unexpected characters are skipped up to the next token
+ * start, invalid numbers and unknown symbols are kept (an overflowing number
+ * as 1). Limits are never recovered from.
+ *
+ * @tparam G           Grammar policy (see grammar.hpp).
+ * @tparam Recovering  Report invalid lexemes to a DiagnosticSink (otherwise recovery is compiled out).
  */
-class Tokenizer {
+template <GrammarPolicy G, bool Recovering = false>
+class BasicTokenizer {
 public:
   /**
    * @brief Construct and consume the first token.
-   * @param input  Formula string to tokenize (must not be empty).
+   * @param input   Formula string to tokenize (must not be empty).
+   * @param limits  Length, token and number limits (default: none).
    * @throws TokenizerError if input is empty or the first lexeme is invalid.
+   * @throws LimitError     if the input is too long or the first token breaks a limit.
    */
-  explicit Tokenizer(std::string_view input);
+  explicit BasicTokenizer(std::string_view input, const ParseLimits &limits = {})
+    requires(!Recovering);
+
+  /**
+   * @brief Construct a recovering tokenizer and consume the first token.
+   * @param input   Formula string to tokenize (empty input lexes End).
+   * @param sink    Receives one Diagnostic per invalid lexeme; must outlive the tokenizer.
+   * @param limits  Length, token and number limits (default: none).
+   * @throws LimitError if the input is too long or the first token breaks a limit.
+   */
+  BasicTokenizer(std::string_view input, DiagnosticSink &sink, const ParseLimits &limits = {})
+    requires(Recovering);
 
   /**
    * @brief Peek at the current token without consuming it.
@@ -40,7 +82,8 @@ public:
 
   /**
    * @brief Consume the current token and advance to the next one.
-   * @throws TokenizerError if the next lexeme is invalid.
+   * @throws TokenizerError if the next lexeme is invalid (unless recovering).
+   * @throws LimitError     past max_tokens tokens or on a number above max_count.
    */
   void next();
 
@@ -54,25 +97,405 @@ private:
   // Most recently lexed token.
   Token curr_token_;
 
+  /// Limits checked while lexing.
+  ParseLimits limits_;
+
+  /// Tokens lexed so far, excluding End.
+  size_t token_count_{0};
+
+  /// Receives invalid lexemes (if Recovering).
+  DiagnosticSink *sink_{nullptr};
+
+  BasicTokenizer(std::string_view input, const ParseLimits &limits, DiagnosticSink *sink);
+
+  /**
+   * @brief Lex the token at the current position into curr_token_.
+   * @return False if a recovering tokenizer skipped an invalid lexeme instead.
+   */
+  bool lexToken();
+
+  /**
+   * @brief Throw a TokenizerError, or report it as a diagnostic when recovering.
+   * @param start    Input position of the lexeme.
+   * @param token    Offending lexeme.
+   * @param kind     Diagnostic category.
+   * @param message  Short description, as for the exception.
+   */
+  void fail(size_t start, const Token &token, DiagnosticKind kind, std::string message);
+
+  /**
+   * @brief Check whether a skipped run of invalid input ends before a character.
+   * @param chr  Character to test.
+   */
+  static bool isSync(char chr) noexcept;
+
+  /**
+   * @brief Check whether a character is a delimiter enabled by the grammar.
+   * @param chr  Character to test.
+   */
+  static constexpr bool isDelimiter(char chr) noexcept;
+
+  /**
+   * @brief Check whether a character starts an equation operator ('+', "->", '=').
+   * @param chr  Character to test.
+   */
+  static constexpr bool isOperatorStart(char chr) noexcept;
+
+  /**
+   * @brief Skip a whitespace run that touches an operator or an end of the input.
+   * @throws TokenizerError on whitespace anywhere else (unless recovering).
+   */
+  void skipWhitespace();
+
   /**
    * @brief Lex an Element token at the current position.
    * @return A Token of kind Element with its text.
+   * @throws TokenizerError on unknown symbols (if G::STRICT_ELEMENTS).
    */
   Token lexElementToken();
 
   /**
    * @brief Lex a Number token at the current position.
    * @return A Token of kind Number with its text and numeric value.
-   * @throws TokenizerError on zero value or leading zero.
+   * @throws TokenizerError on zero value, leading zero or a value beyond 64 bits.
+   * @throws LimitError     on a value above max_count, as soon as the digits read exceed it.
    */
   Token lexNumberToken();
 
+  /**
+   * @brief Lex a Parameter token: a run of lowercase letters.
+   * @return A Token of kind Parameter with the name as text.
+   */
+  Token lexParameterToken();
+
   /**
    * @brief Lex a single‐character token: '(', ')', '[', ']', or '*'.
    * @param del The delimiter character.
    * @return A Token of the corresponding kind.
    */
   Token lexSingleCharToken(char del);
+
+  /**
+   * @brief Lex an equation operator: '+', "->" or '='.
+   * @return A Token of kind Plus, Arrow or Equals (Invalid for a skipped '-' when recovering).
+   * @throws TokenizerError on a '-' not followed by '>'.
+   */
+  Token lexOperatorToken();
 };
 
+/// Tokenizer for the full formula grammar.
+using Tokenizer = BasicTokenizer<FullGrammar>;
+
+/// Tokenizer for chemical equations.
+using EquationTokenizer = BasicTokenizer<EquationGrammar>;
+
+/// Tokenizer for formulas with parameter multipliers.
+using ParametricTokenizer = BasicTokenizer<ParametricGrammar>;
+
+extern template class BasicTokenizer<FullGrammar>;
+extern template class BasicTokenizer<EquationGrammar>;
+extern template class BasicTokenizer<ParametricGrammar>;
+extern template class BasicTokenizer<FullGrammar, true>;
+
+template <GrammarPolicy G, bool Recovering>
+BasicTokenizer<G, Recovering>::BasicTokenizer(std::string_view input, const ParseLimits &limits)
+  requires(!Recovering)
+    : BasicTokenizer(input, limits, nullptr) {}
+
+template <GrammarPolicy G, bool Recovering>
+BasicTokenizer<G, Recovering>::BasicTokenizer(std::string_view input, DiagnosticSink &sink,
+                                              const ParseLimits &limits)
+  requires(Recovering)
+    : BasicTokenizer(input, limits, &sink) {}
+
+template <GrammarPolicy G, bool Recovering>
+BasicTokenizer<G, Recovering>::BasicTokenizer(std::string_view input, const ParseLimits &limits, DiagnosticSink *sink) :
+    input_{input}, limits_{limits}, sink_{sink} {
+  if constexpr (!Recovering) {
+    if (input.empty()) {
+      throw TokenizerError{0, input_, {.kind = TokenKind::Invalid, .text = {}}, "empty input not allowed"};
+    }
+  }
+
+  // rejected before any lexing, in constant time
+  if (input.size() > limits_.max_length) {
+    throw LimitError{limits_.max_length, LimitKind::Length, limits_.max_length,
+                     std::format("input of {} bytes is too long", input.size())};
+  }
+  // consume the first token
+  next();
+}
+
+template <GrammarPolicy G, bool Recovering>
+const Token &BasicTokenizer<G, Recovering>::peek() const noexcept {
+  return curr_token_;
+}
+
+template <GrammarPolicy G, bool Recovering>
+void BasicTokenizer<G, Recovering>::next() {
+  // only a recovering tokenizer skips lexemes; each counts as a token, so this is bounded
+  while (!lexToken()) {
+  }
+}
+
+template <GrammarPolicy G, bool Recovering>
+bool BasicTokenizer<G, Recovering>::lexToken() {
+  if constexpr (G::EQUATIONS) {
+    skipWhitespace();
+  }
+
+  if (offset_ >= input_.size()) {
+    curr_token_ = {.kind = TokenKind::End, .text = {}};
+    return true;
+  }
+
+  if (token_count_ == limits_.max_tokens) {
+    throw LimitError{offset_, LimitKind::Tokens, limits_.max_tokens, "too many tokens"};
+  }
+
+  token_count_ += 1;
+
+  const size_t start = offset_;
+  const char curr_char = input_[offset_];
+
+  if (std::isspace(static_cast<unsigned char>(curr_char))) {
+    fail(start, {.kind = TokenKind::Invalid, .text = input_.substr(start, 1)}, DiagnosticKind::Whitespace,
+         "whitespace not allowed");
+
+    while (offset_ < input_.size() && std::isspace(static_cast<unsigned char>(input_[offset_]))) {
+      offset_ += 1;
+    }
+    return false;
+  }
+
+  if (std::isupper(static_cast<unsigned char>(curr_char))) {
+    curr_token_ = lexElementToken();
+    return true;
+  }
+
+  if (std::isdigit(static_cast<unsigned char>(curr_char))) {
+    curr_token_ = lexNumberToken();
+    return true;
+  }
+
+  // lowercase letters right after an element belong to its symbol, so only a lexeme start gets here
+  if constexpr (G::PARAMETERS) {
+    if (std::islower(static_cast<unsigned char>(curr_char))) {
+      curr_token_ = lexParameterToken();
+      return true;
+    }
+  }
+
+  if (isDelimiter(curr_char)) {
+    curr_token_ = lexSingleCharToken(curr_char);
+    return true;
+  }
+
+  if constexpr (G::EQUATIONS) {
+    if (isOperatorStart(curr_char)) {
+      curr_token_ = lexOperatorToken();
+      return curr_token_.kind != TokenKind::Invalid;
+    }
+  }
+
+  fail(start, {.kind = TokenKind::Invalid, .text = input_.substr(start, 1)}, DiagnosticKind::UnexpectedCharacter,
+       std::format("unexpected character '{}'", curr_char));
+
+  // resynchronize at the next token start
+  offset_ += 1;
+
+  while (offset_ < input_.size() && !isSync(input_[offset_])) {
+    offset_ += 1;
+  }
+  return false;
+}
+
+template <GrammarPolicy G, bool Recovering>
+void BasicTokenizer<G, Recovering>::fail(size_t start, const Token &token, DiagnosticKind kind, std::string message) {
+  if constexpr (Recovering) {
+    sink_->push_back({.offset = start, .kind = kind, .message = std::move(message)});
+  } else {
+    throw TokenizerError{start, input_, token, message};
+  }
+}
+
+template <GrammarPolicy G, bool Recovering>
+bool BasicTokenizer<G, Recovering>::isSync(char chr) noexcept {
+  return isDelimiter(chr) || isOperatorStart(chr) || std::isupper(static_cast<unsigned char>(chr)) ||
+         std::isspace(static_cast<unsigned char>(chr));
+}
+
+template <GrammarPolicy G, bool Recovering>
+constexpr bool BasicTokenizer<G, Recovering>::isDelimiter(char chr) noexcept {
+  return (G::PARENS && (chr == '(' || chr == ')')) || (G::BRACKETS && (chr == '[' || chr == ']')) ||
+         (G::LIGANDS && chr == '*');
+}
+
+template <GrammarPolicy G, bool Recovering>
+constexpr bool BasicTokenizer<G, Recovering>::isOperatorStart(char chr) noexcept {
+  return G::EQUATIONS && (chr == '+' || chr == '-' || chr == '=');
+}
+
+template <GrammarPolicy G, bool Recovering>
+void BasicTokenizer<G, Recovering>::skipWhitespace() {
+  const size_t start = offset_;
+
+  while (offset_ < input_.size() && std::isspace(static_cast<unsigned char>(input_[offset_]))) {
+    offset_ += 1;
+  }
+
+  if (offset_ == start) {
+    return;
+  }
+
+  // spaces may separate species from operators, never split a formula
+  const auto prev = curr_token_.kind;
+  const bool after_operator =
+      start == 0 || prev == TokenKind::Plus || prev == TokenKind::Arrow || prev == TokenKind::Equals;
+  const bool before_operator = offset_ == input_.size() || isOperatorStart(input_[offset_]);
+
+  if (!after_operator && !before_operator) {
+    fail(start, {.kind = TokenKind::Invalid, .text = input_.substr(start, 1)}, DiagnosticKind::Whitespace,
+         "whitespace not allowed inside a species");
+  }
+}
+
+template <GrammarPolicy G, bool Recovering>
+Token BasicTokenizer<G, Recovering>::lexElementToken() {
+  assert(std::isupper(static_cast<unsigned char>(input_[offset_])));
+
+  const size_t start = offset_;
+  offset_ += 1;
+
+  while (offset_ < input_.size() && std::islower(static_cast<unsigned char>(input_[offset_]))) {
+    offset_ += 1;
+  }
+
+  const auto text = input_.substr(start, offset_ - start);
+  const Token token{.kind = TokenKind::Element, .text = text};
+
+  if constexpr (G::STRICT_ELEMENTS) {
+    if (element_id(text) == 0) {
+      fail(start, token, DiagnosticKind::UnknownElement, std::format("unknown element '{}'", text));
+    }
+  }
+
+  return token;
+}
+
+template <GrammarPolicy G, bool Recovering>
+Token BasicTokenizer<G, Recovering>::lexNumberToken() {
+  assert(std::isdigit(static_cast<unsigned char>(input_[offset_])));
+
+  const size_t start = offset_;
+  const bool count_limited = limits_.max_count != std::numeric_limits<uint64_t>::max();
+
+  // checked accumulation: digit runs past 2^64 - 1 are rejected, not wrapped
+  uint64_t value = 0;
+  bool overflow = false;
+
+  while (offset_ < input_.size() && std::isdigit(static_cast<unsigned char>(input_[offset_]))) {
+    overflow |= __builtin_mul_overflow(value, uint64_t{10}, &value);
+    overflow |= __builtin_add_overflow(value, static_cast<uint64_t>(input_[offset_] - '0'), &value);
+    offset_ += 1;
+
+    // no count is smaller than a number multiplying it; stop reading at once
+    if (count_limited && (overflow || value > limits_.max_count)) {
+      throw LimitError{start, LimitKind::Count, limits_.max_count, "number is too large"};
+    }
+  }
+
+  const auto text = input_.substr(start, offset_ - start);
+  Token token{.kind = TokenKind::Number, .text = text, .value = value};
+
+  if (overflow) {
+    fail(start, token, DiagnosticKind::CountOverflow, "invalid number (exceeds 64 bits)");
+    token.value = 1;  // recovering: the wrapped value means nothing
+  } else if (value == 0) {
+    fail(start, token, DiagnosticKind::InvalidNumber, "invalid number (non-positive integer)");
+  } else if (text.starts_with('0')) {
+    fail(start, token, DiagnosticKind::InvalidNumber, "invalid number (leading zero)");
+  }
+
+  return token;
+}
+
+template <GrammarPolicy G, bool Recovering>
+Token BasicTokenizer<G, Recovering>::lexParameterToken() {
+  assert(std::islower(static_cast<unsigned char>(input_[offset_])));
+
+  const size_t start = offset_;
+  offset_ += 1;
+
+  while (offset_ < input_.size() && std::islower(static_cast<unsigned char>(input_[offset_]))) {
+    offset_ += 1;
+  }
+
+  return Token{.kind = TokenKind::Parameter, .text = input_.substr(start, offset_ - start)};
+}
+
+template <GrammarPolicy G, bool Recovering>
+Token BasicTokenizer<G, Recovering>::lexSingleCharToken(char del) {
+  assert(isDelimiter(del));
+
+  TokenKind kind;
+
+  // clang-format off
+  switch (del) {
+    case '(': kind = TokenKind::LParen;
+      break;
+    case ')': kind = TokenKind::RParen;
+      break;
+    case '[': kind = TokenKind::LBracket;
+      break;
+    case ']': kind = TokenKind::RBracket;
+      break;
+    case '*': kind = TokenKind::Star;
+      break;
+    default:  kind = TokenKind::Invalid;
+      break;
+  }
+  // clang-format on
+
+  const auto text = input_.substr(offset_, 1);
+  offset_ += 1;
+
+  return Token{.kind = kind, .text = text};
+}
+
+template <GrammarPolicy G, bool Recovering>
+Token BasicTokenizer<G, Recovering>::lexOperatorToken() {
+  assert(isOperatorStart(input_[offset_]));
+
+  const size_t start = offset_;
+  TokenKind kind = TokenKind::Invalid;
+
+  // clang-format off
+  switch (input_[start]) {
+    case '+': kind = TokenKind::Plus;
+      break;
+    case '=': kind = TokenKind::Equals;
+      break;
+    default:  kind = TokenKind::Arrow;
+      break;
+  }
+  // clang-format on
+
+  const size_t length = (kind == TokenKind::Arrow) ? 2 : 1;
+
+  if (kind == TokenKind::Arrow && (start + 1 >= input_.size() || input_[start + 1] != '>')) {
+    const Token token{.kind = TokenKind::Invalid, .text = input_.substr(start, 1)};
+    fail(start, token, DiagnosticKind::UnexpectedCharacter, "unexpected character '-' (expected \"->\")");
+
+    // recovering: skip the '-'
+    offset_ += 1;
+    return token;
+  }
+
+  const auto text = input_.substr(start, length);
+  offset_ += length;
+
+  return Token{.kind = kind, .text = text};
+}
+
 }  // namespace cfp
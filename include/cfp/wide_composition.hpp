@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstddef>  // size_t
+#include <cstdint>  // uint64_t
+#include <stdexcept>  // out_of_range
+#include <string>
+#include <utility>  // pair
+#include <vector>
+
+#include "cfp/checked.hpp"
+#include "cfp/composition.hpp"
+#include "cfp/element.hpp"
+
+namespace cfp {
+
+/// 128-bit unsigned count (GCC/Clang extension; __extension__ silences -Wpedantic).
+__extension__ using wide_count = unsigned __int128;
+
+/**
+ * @class WideComposition
+ * @brief Element counts with 128-bit range, for extreme multipliers.
+ *
+ * Opt-in counterpart of Composition for polymer or supercell formulas whose
+ * nested multipliers exceed 64 bits. Arithmetic is still checked: a count
+ * beyond 2^128 - 1 throws OverflowError.
+ *
+ * Example: "((C)18446744073709551615)2" => {C: 36893488147419103230}
+ */
+class WideComposition {
+public:
+  using count_type = wide_count;
+  using Entry = std::pair<ElementId, count_type>;
+
+  static constexpr size_t CAPACITY = Composition::CAPACITY;
+  static constexpr size_t MASK_WORDS = Composition::MASK_WORDS;
+
+  WideComposition() = default;
+
+  /// Count of an element, or 0 if absent.
+  [[nodiscard]] count_type operator[](ElementId id) const noexcept {
+    return id < CAPACITY ? counts_[id] : 0;
+  }
+
+  /**
+   * @brief Add atoms of a single element.
+   * @throws std::out_of_range if @a id is CAPACITY or more.
+   * @throws OverflowError     if the count leaves the 128-bit range.
+   */
+  void add(ElementId id, count_type count) {
+    if (id >= CAPACITY) {
+      throw std::out_of_range{"element ID beyond the composition capacity"};
+    }
+
+    counts_[id] = checked_add(counts_[id], count);
+    if (count != 0) {
+      mask_[id / 64] |= uint64_t{1} << (id % 64);
+    }
+  }
+
+  /// Check whether an element is present.
+  [[nodiscard]] bool contains(ElementId id) const noexcept {
+    return id < CAPACITY && ((mask_[id / 64] >> (id % 64)) & 1U) != 0;
+  }
+
+  /// True if no element is present.
+  [[nodiscard]] bool empty() const noexcept {
+    return (mask_[0] | mask_[1]) == 0;
+  }
+
+  /// Present elements and their counts, by ascending element ID.
+  [[nodiscard]] std::vector<Entry> entries() const;
+
+  /// True if every count fits Composition::count_type.
+  [[nodiscard]] bool fitsNarrow() const noexcept;
+
+  /**
+   * @brief Convert to a 64-bit Composition.
+   * @throws OverflowError if a count does not fit 64 bits.
+   */
+  [[nodiscard]] Composition narrow() const;
+
+  friend bool operator==(const WideComposition &lhs, const WideComposition &rhs) noexcept {
+    return lhs.mask_ == rhs.mask_ && lhs.counts_ == rhs.counts_;
+  }
+
+private:
+  std::array<count_type, CAPACITY> counts_{};
+  std::array<uint64_t, MASK_WORDS> mask_{};
+};
+
+/**
+ * @brief Decimal representation of a 128-bit count.
+ * @param value  Count to render.
+ * @return       Digits without sign or separators, e.g. "36893488147419103230".
+ */
+std::string to_string(wide_count value);
+
+}  // namespace cfp
@@ -0,0 +1,148 @@
+#include "cfp/aggregate.hpp"
+
+#include <algorithm>  // min
+#include <cstddef>  // size_t
+#include <exception>  // exception_ptr
+#include <limits>
+#include <stdexcept>  // invalid_argument
+#include <utility>  // move
+#include <vector>
+
+#include "cfp/checked.hpp"
+#include "cfp/parser_context.hpp"
+#include "parallel.hpp"
+
+namespace cfp {
+
+namespace {
+
+/// Rows per task: large enough to amortize the hand-out, small enough to balance.
+constexpr size_t BLOCK_SIZE = 1024;
+
+/// Per-worker state. Accumulators are cache-line aligned, so workers never share a line.
+template <typename Accumulator>
+struct Worker {
+  Accumulator totals;
+  ParserContext context;
+
+  /// Lowest failing row seen by this worker and its exception.
+  size_t failed_row{std::numeric_limits<size_t>::max()};
+  std::exception_ptr error;
+};
+
+/// Integer accumulation: checked, so the total is exact or OverflowError.
+struct CountSum {
+  Composition totals;
+
+  void add(const Composition &comp, uint64_t weight) {
+    for (const auto [id, count] : comp) {
+      totals.add(id, checked_mul(count, weight));
+    }
+  }
+
+  CountSum &operator+=(const CountSum &other) {
+    totals += other.totals;
+    return *this;
+  }
+};
+
+/// Real-valued accumulation.
+struct WeightedSum {
+  WeightedTotals totals;
+
+  void add(const Composition &comp, double weight) noexcept {
+    for (const auto [id, count] : comp) {
+      totals.totals[id] += static_cast<double>(count) * weight;
+    }
+  }
+
+  WeightedSum &operator+=(const WeightedSum &other) noexcept {
+    // fixed-size, branch-free: vectorized
+    for (size_t slot = 0; slot < Composition::CAPACITY; slot++) {
+      totals.totals[slot] += other.totals.totals[slot];
+    }
+    return *this;
+  }
+};
+
+/**
+ * @brief Parse all rows into per-worker accumulators and reduce them.
+ * @param weight  Callable weight(row) returning the row's multiplier.
+ */
+template <typename Accumulator, typename Weight>
+Accumulator run(std::span<const std::string_view> formulas, unsigned threads, Weight &&weight) {
+  const size_t blocks = (formulas.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  const unsigned workers = detail::resolve_threads(threads, blocks);
+
+  std::vector<Worker<Accumulator>> state(workers);
+
+  detail::parallel_for(blocks, workers, [&](size_t block, unsigned worker) {
+    auto &own = state[worker];
+    const size_t end = std::min(formulas.size(), (block + 1) * BLOCK_SIZE);
+
+    for (size_t row = block * BLOCK_SIZE; row < end; row++) {
+      try {
+        own.totals.add(own.context.parse(formulas[row]), weight(row));
+      } catch (...) {
+        // keep going: the caller gets the lowest failing row, whatever the schedule
+        if (row < own.failed_row) {
+          own.failed_row = row;
+          own.error = std::current_exception();
+        }
+      }
+    }
+  });
+
+  const Worker<Accumulator> *first_failure = nullptr;
+
+  for (const auto &own : state) {
+    if (own.error && (first_failure == nullptr || own.failed_row < first_failure->failed_row)) {
+      first_failure = &own;
+    }
+  }
+
+  if (first_failure != nullptr) {
+    std::rethrow_exception(first_failure->error);
+  }
+
+  // pairwise tree reduction: log2(workers) rounds, each round's merges run in parallel
+  for (size_t stride = 1; stride < workers; stride *= 2) {
+    const size_t pairs = (workers + (2 * stride) - 1) / (2 * stride);
+
+    detail::parallel_for(pairs, detail::resolve_threads(threads, pairs), [&](size_t pair, unsigned /*worker*/) {
+      const size_t left = pair * 2 * stride;
+
+      if (left + stride < workers) {
+        state[left].totals += state[left + stride].totals;
+      }
+    });
+  }
+
+  return std::move(state[0].totals);
+}
+
+}  // namespace
+
+Composition aggregate(std::span<const std::string_view> formulas, unsigned threads) {
+  return run<CountSum>(formulas, threads, [](size_t /*row*/) { return uint64_t{1}; }).totals;
+}
+
+Composition aggregate(std::span<const std::string_view> formulas, std::span<const uint64_t> weights,
+                      unsigned threads) {
+  if (weights.size() != formulas.size()) {
+    throw std::invalid_argument{"aggregate needs one weight per formula"};
+  }
+
+  return run<CountSum>(formulas, threads, [&](size_t row) { return weights[row]; }).totals;
+}
+
+WeightedTotals aggregate(std::span<const std::string_view> formulas, std::span<const double> weights,
+                         unsigned threads) {
+  if (weights.size() != formulas.size()) {
+    throw std::invalid_argument{"aggregate needs one weight per formula"};
+  }
+
+  return run<WeightedSum>(formulas, threads, [&](size_t row) { return weights[row]; }).totals;
+}
+
+}  // namespace cfp
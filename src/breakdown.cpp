@@ -0,0 +1,55 @@
+#include "cfp/breakdown.hpp"
+
+#include "cfp/ast.hpp"
+#include "cfp/checked.hpp"
+
+namespace cfp::detail {
+
+namespace {
+
+/// Subtotal of a unit or group node, its source text located in @a input.
+Subtotal subtotal(const GroupNode &node, std::string_view input, size_t unit, const Composition &counts) {
+  return {
+      .offset = static_cast<size_t>(node.text.data() - input.data()),
+      .length = node.text.size(),
+      .unit = unit,
+      .multiplier = node.multiplier,
+      .counts = SparseComposition{counts},
+  };
+}
+
+}  // namespace
+
+Breakdown evaluate_breakdown(const GroupNode &root, std::string_view input, bool groups) {
+  Breakdown result;
+  result.units.reserve(root.children.size());
+
+  for (size_t unit = 0; unit < root.children.size(); unit++) {
+    // the parser makes every unit a GroupNode
+    const auto &node = static_cast<const GroupNode &>(*root.children[unit]);
+    Composition unit_counts;
+
+    // each node is evaluated once; a group's counts are folded into its unit's
+    for (const auto &child : node.children) {
+      const auto *group = groups ? dynamic_cast<const GroupNode *>(child.get()) : nullptr;
+
+      if (group == nullptr) {
+        child->evaluate(unit_counts, node.multiplier);
+        continue;
+      }
+
+      Composition group_counts;
+      group->evaluate(group_counts, node.multiplier);
+      at_offset(group->offset, [&] { unit_counts += group_counts; });
+
+      result.groups.push_back(subtotal(*group, input, unit, group_counts));
+    }
+
+    at_offset(node.offset, [&] { result.total += unit_counts; });
+    result.units.push_back(subtotal(node, input, unit, unit_counts));
+  }
+
+  return result;
+}
+
+}  // namespace cfp::detail
@@ -0,0 +1,232 @@
+#include "cfp/cfp.h"
+
+#include <algorithm>  // min
+#include <cstring>  // strlen
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/error/limit_error.hpp"
+#include "cfp/error/overflow_error.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/error/tokenizer_error.hpp"
+#include "cfp/parser_context.hpp"
+#include "parallel.hpp"
+
+// Nothing below may throw into C: every entry point ends in catch (...).
+
+namespace {
+
+using cfp::Composition;
+using cfp::ParserContext;
+
+/// Formulas per parallel task; large enough to amortize the task hand-out.
+constexpr size_t BLOCK_SIZE = 256;
+
+/// Byte offset of a token inside the formula it was lexed from (End tokens point past the end).
+size_t token_offset(const cfp::Token &token, std::string_view formula) noexcept {
+  const char *data = token.text.data();
+
+  if (data == nullptr || data < formula.data() || data > formula.data() + formula.size()) {
+    return formula.size();
+  }
+
+  return static_cast<size_t>(data - formula.data());
+}
+
+/// Buffers of cfp_parse() on the calling thread; not ParserContext::forThread(), whose result C++ code may hold.
+ParserContext &thread_context() {
+  thread_local ParserContext context;
+  return context;
+}
+
+/// ParseLimits of a C call; NULL and 0 fields read as "no limit", so C callers can zero-initialize.
+cfp::ParseLimits to_limits(const cfp_limits *limits) noexcept {
+  cfp::ParseLimits parse_limits;
+
+  if (limits != nullptr) {
+    const auto pick = [](auto value, auto unlimited) { return value != 0 ? value : unlimited; };
+
+    parse_limits.max_length = pick(limits->max_length, cfp::ParseLimits::UNLIMITED);
+    parse_limits.max_depth = pick(limits->max_depth, cfp::ParseLimits::UNLIMITED);
+    parse_limits.max_tokens = pick(limits->max_tokens, cfp::ParseLimits::UNLIMITED);
+    parse_limits.max_units = pick(limits->max_units, cfp::ParseLimits::UNLIMITED);
+    parse_limits.max_count = pick(limits->max_count, std::numeric_limits<uint64_t>::max());
+  }
+
+  return parse_limits;
+}
+
+/// Parse into the context, mapping library exceptions to status codes.
+int32_t parse_into(ParserContext &context, std::string_view formula, size_t &error_offset) noexcept {
+  error_offset = 0;
+
+  try {
+    context.parse(formula);
+    return CFP_OK;
+  } catch (const cfp::TokenizerError &err) {
+    error_offset = err.offset;
+    return CFP_ERROR_TOKENIZER;
+  } catch (const cfp::ParserError &err) {
+    error_offset = token_offset(err.token, formula);
+    return CFP_ERROR_PARSER;
+  } catch (const cfp::OverflowError &err) {
+    error_offset = err.offset.value_or(0);
+    return CFP_ERROR_OVERFLOW;
+  } catch (const cfp::LimitError &err) {
+    error_offset = err.offset;
+    return CFP_ERROR_LIMIT;
+  } catch (...) {
+    return CFP_ERROR_INTERNAL;
+  }
+}
+
+/// Formula @a idx of a batch; a null pointer reads as empty input.
+std::string_view formula_at(const char *const *formulas, const size_t *lengths, size_t idx) noexcept {
+  const char *formula = formulas[idx];
+
+  if (formula == nullptr) {
+    return {};
+  }
+
+  return {formula, lengths != nullptr ? lengths[idx] : std::strlen(formula)};
+}
+
+}  // namespace
+
+extern "C" {
+
+const char *cfp_status_string(int32_t status) {
+  // clang-format off
+  switch (status) {
+    case CFP_OK:                     return "ok";
+    case CFP_ERROR_TOKENIZER:        return "tokenizer error";
+    case CFP_ERROR_PARSER:           return "parser error";
+    case CFP_ERROR_OVERFLOW:         return "count overflow";
+    case CFP_ERROR_CAPACITY:         return "output buffer too small";
+    case CFP_ERROR_INVALID_ARGUMENT: return "invalid argument";
+    case CFP_ERROR_INTERNAL:         return "internal error";
+    case CFP_ERROR_LIMIT:            return "limit exceeded";
+    default:                         return "unknown status";
+  }
+  // clang-format on
+}
+
+int32_t cfp_parse(const char *formula, size_t length, const cfp_limits *limits, uint8_t *element_ids,
+                  uint64_t *counts, size_t capacity, size_t *written, size_t *error_offset) {
+  if ((formula == nullptr && length != 0) || written == nullptr ||
+      (capacity != 0 && (element_ids == nullptr || counts == nullptr))) {
+    return CFP_ERROR_INVALID_ARGUMENT;
+  }
+
+  try {
+    auto &context = thread_context();
+    context.setLimits(to_limits(limits));
+
+    size_t position = 0;
+    const int32_t status = parse_into(context, {formula, length}, position);
+
+    if (error_offset != nullptr) {
+      *error_offset = position;
+    }
+
+    *written = 0;
+
+    if (status != CFP_OK) {
+      return status;
+    }
+
+    const auto &result = context.result();
+    *written = result.size();
+
+    if (*written > capacity) {
+      return CFP_ERROR_CAPACITY;
+    }
+
+    size_t idx = 0;
+
+    for (const auto [id, count] : result) {
+      element_ids[idx] = id;
+      counts[idx] = count;
+      idx += 1;
+    }
+
+    return CFP_OK;
+  } catch (...) {
+    return CFP_ERROR_INTERNAL;
+  }
+}
+
+int32_t cfp_parse_batch(const char *const *formulas, const size_t *lengths, size_t count, const cfp_limits *limits,
+                        uint8_t *element_ids, uint64_t *counts, size_t capacity, size_t *offsets, int32_t *statuses,
+                        size_t *error_offsets, unsigned threads, size_t *required) {
+  if (offsets == nullptr || (count != 0 && (formulas == nullptr || statuses == nullptr)) ||
+      (capacity != 0 && (element_ids == nullptr || counts == nullptr))) {
+    return CFP_ERROR_INVALID_ARGUMENT;
+  }
+
+  try {
+    const size_t blocks = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const unsigned workers = cfp::detail::resolve_threads(threads, blocks);
+
+    std::vector<ParserContext> contexts(workers, ParserContext{to_limits(limits)});
+    std::vector<std::vector<Composition::Entry>> pairs(blocks);
+
+    // pass 1: parse each block into its own pair list; offsets[i + 1] holds formula i's pair count
+    cfp::detail::parallel_for(blocks, workers, [&](size_t block, unsigned worker) {
+      auto &context = contexts[worker];
+      auto &out = pairs[block];
+
+      const size_t end = std::min(count, (block + 1) * BLOCK_SIZE);
+
+      for (size_t idx = block * BLOCK_SIZE; idx < end; idx++) {
+        size_t position = 0;
+        statuses[idx] = parse_into(context, formula_at(formulas, lengths, idx), position);
+
+        if (error_offsets != nullptr) {
+          error_offsets[idx] = position;
+        }
+
+        const size_t before = out.size();
+
+        if (statuses[idx] == CFP_OK) {
+          out.insert(out.end(), context.result().begin(), context.result().end());
+        }
+
+        offsets[idx + 1] = out.size() - before;
+      }
+    });
+
+    offsets[0] = 0;
+
+    for (size_t idx = 0; idx < count; idx++) {
+      offsets[idx + 1] += offsets[idx];
+    }
+
+    if (required != nullptr) {
+      *required = offsets[count];
+    }
+
+    if (offsets[count] > capacity) {
+      return CFP_ERROR_CAPACITY;
+    }
+
+    // pass 2: every block knows where its pairs start
+    cfp::detail::parallel_for(blocks, workers, [&](size_t block, unsigned /*worker*/) {
+      size_t slot = offsets[block * BLOCK_SIZE];
+
+      for (const auto &[id, value] : pairs[block]) {
+        element_ids[slot] = id;
+        counts[slot] = value;
+        slot += 1;
+      }
+    });
+
+    return CFP_OK;
+  } catch (...) {
+    return CFP_ERROR_INTERNAL;
+  }
+}
+
+}  // extern "C"
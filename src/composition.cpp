@@ -0,0 +1,278 @@
+#include "cfp/composition.hpp"
+
+#include <algorithm>  // lower_bound, sort
+#include <array>
+#include <numeric>  // gcd
+#include <stdexcept>  // underflow_error
+#include <utility>  // move
+
+namespace cfp {
+
+namespace {
+
+/// Element IDs ordered alphabetically by symbol.
+constexpr auto ALPHABETICAL_ORDER = [] {
+  std::array<ElementId, ELEMENT_COUNT> order{};
+
+  for (size_t idx = 0; idx < ELEMENT_COUNT; idx++) {
+    order[idx] = static_cast<ElementId>(idx + 1);
+  }
+
+  std::sort(order.begin(), order.end(),
+            [](ElementId lhs, ElementId rhs) { return ELEMENT_SYMBOLS[lhs] < ELEMENT_SYMBOLS[rhs]; });
+
+  return order;
+}();
+
+constexpr ElementId CARBON = 6;
+constexpr ElementId HYDROGEN = 1;
+
+void appendElement(std::string &out, ElementId id, Composition::count_type count) {
+  out += element_symbol(id);
+
+  if (count > 1) {
+    out += std::to_string(count);
+  }
+}
+
+}  // namespace
+
+// The element-wise loops below run over the full, fixed-size count array
+// without early exits, so they are compiled to SIMD code.
+
+void Composition::const_iterator::seek(size_t from) noexcept {
+  slot_ = CAPACITY;
+
+  for (size_t word = from / 64; word < MASK_WORDS; word++) {
+    uint64_t bits = owner_->mask_[word];
+
+    if (word == from / 64) {
+      bits &= ~uint64_t{0} << (from % 64);
+    }
+
+    if (bits != 0) {
+      slot_ = word * 64 + static_cast<size_t>(std::countr_zero(bits));
+      return;
+    }
+  }
+}
+
+Composition::count_type Composition::total() const {
+  count_type sum = 0;
+
+  for (size_t idx = 0; idx < CAPACITY; idx++) {
+    sum = checked_add(sum, counts_[idx]);
+  }
+
+  return sum;
+}
+
+void Composition::clear() noexcept {
+  counts_.fill(0);
+  mask_.fill(0);
+}
+
+Composition &Composition::operator+=(const Composition &other) {
+  bool carry = false;
+
+  // wrap-around check as a compare, so the loop still vectorizes
+  for (size_t idx = 0; idx < CAPACITY; idx++) {
+    const count_type sum = counts_[idx] + other.counts_[idx];
+    carry |= sum < counts_[idx];
+    counts_[idx] = sum;
+  }
+
+  if (carry) [[unlikely]] {
+    detail::throw_count_overflow("element count exceeds the count range");
+  }
+
+  for (size_t word = 0; word < MASK_WORDS; word++) {
+    mask_[word] |= other.mask_[word];
+  }
+
+  return *this;
+}
+
+Composition &Composition::operator-=(const Composition &other) {
+  if (!other.isSubsetOf(*this)) {
+    throw std::underflow_error{"composition subtraction underflow (not a subset)"};
+  }
+
+  for (size_t idx = 0; idx < CAPACITY; idx++) {
+    counts_[idx] -= other.counts_[idx];
+  }
+
+  updateMask();
+  return *this;
+}
+
+Composition &Composition::operator*=(count_type factor) {
+  if (factor == 0) {
+    clear();
+    return *this;
+  }
+
+  bool overflow = false;
+
+  for (size_t idx = 0; idx < CAPACITY; idx++) {
+    overflow |= __builtin_mul_overflow(counts_[idx], factor, &counts_[idx]);
+  }
+
+  if (overflow) [[unlikely]] {
+    detail::throw_count_overflow("multiplier product exceeds the count range");
+  }
+
+  return *this;
+}
+
+bool operator==(const Composition &lhs, const Composition &rhs) noexcept {
+  if (lhs.mask_ != rhs.mask_) {
+    return false;  // cheap reject on different element sets
+  }
+
+  bool equal = true;
+
+  for (size_t idx = 0; idx < Composition::CAPACITY; idx++) {
+    equal &= lhs.counts_[idx] == rhs.counts_[idx];
+  }
+
+  return equal;
+}
+
+bool Composition::isSubsetOf(const Composition &other) const noexcept {
+  for (size_t word = 0; word < MASK_WORDS; word++) {
+    if ((mask_[word] & ~other.mask_[word]) != 0) {
+      return false;  // an element missing from other
+    }
+  }
+
+  bool subset = true;
+
+  for (size_t idx = 0; idx < CAPACITY; idx++) {
+    subset &= counts_[idx] <= other.counts_[idx];
+  }
+
+  return subset;
+}
+
+Composition::count_type Composition::gcd() const noexcept {
+  count_type divisor = 0;
+
+  for (const auto &[id, count] : *this) {
+    divisor = std::gcd(divisor, count);
+
+    if (divisor == 1) {
+      break;
+    }
+  }
+
+  return divisor;
+}
+
+Composition Composition::empirical() const noexcept {
+  Composition reduced = *this;
+  const count_type divisor = gcd();
+
+  if (divisor > 1) {
+    for (size_t idx = 0; idx < CAPACITY; idx++) {
+      reduced.counts_[idx] /= divisor;
+    }
+  }
+
+  return reduced;
+}
+
+std::unordered_map<std::string, Composition::count_type> Composition::toDict() const {
+  std::unordered_map<std::string, count_type> dict;
+  dict.reserve(size());
+
+  for (const auto &[id, count] : *this) {
+    dict.emplace(element_symbol(id), count);
+  }
+
+  return dict;
+}
+
+void Composition::updateMask() noexcept {
+  mask_.fill(0);
+
+  for (size_t idx = 0; idx < CAPACITY; idx++) {
+    mask_[idx / 64] |= static_cast<uint64_t>(counts_[idx] != 0) << (idx % 64);
+  }
+}
+
+std::string to_string(const Composition &comp) {
+  std::string formula;
+  const bool hill = comp.contains(CARBON);
+
+  if (hill) {
+    appendElement(formula, CARBON, comp[CARBON]);
+
+    if (comp.contains(HYDROGEN)) {
+      appendElement(formula, HYDROGEN, comp[HYDROGEN]);
+    }
+  }
+
+  for (const ElementId id : ALPHABETICAL_ORDER) {
+    if (comp.contains(id) && !(hill && (id == CARBON || id == HYDROGEN))) {
+      appendElement(formula, id, comp[id]);
+    }
+  }
+
+  return formula;
+}
+
+SparseComposition::SparseComposition(const Composition &dense) {
+  entries_.reserve(dense.size());
+
+  for (const auto &entry : dense) {
+    entries_.push_back(entry);
+  }
+}
+
+Composition SparseComposition::toDense() const noexcept {
+  Composition dense;
+
+  // assigned, not added: each ID occurs once, so nothing can overflow
+  for (const auto &[id, count] : entries_) {
+    dense.counts_[id] = count;
+    dense.mask_[id / 64] |= uint64_t{count != 0} << (id % 64);
+  }
+
+  return dense;
+}
+
+SparseComposition::count_type SparseComposition::operator[](ElementId id) const noexcept {
+  const auto it = std::lower_bound(entries_.begin(), entries_.end(), id,
+                                   [](const Entry &entry, ElementId key) { return entry.first < key; });
+
+  return (it != entries_.end() && it->first == id) ? it->second : 0;
+}
+
+SparseComposition &SparseComposition::operator+=(const SparseComposition &other) {
+  std::vector<Entry> merged;
+  merged.reserve(entries_.size() + other.entries_.size());
+
+  auto lhs = entries_.begin();
+  auto rhs = other.entries_.begin();
+
+  while (lhs != entries_.end() && rhs != other.entries_.end()) {
+    if (lhs->first < rhs->first) {
+      merged.push_back(*lhs++);
+    } else if (rhs->first < lhs->first) {
+      merged.push_back(*rhs++);
+    } else {
+      merged.emplace_back(lhs->first, checked_add(lhs->second, rhs->second));
+      ++lhs;
+      ++rhs;
+    }
+  }
+
+  merged.insert(merged.end(), lhs, entries_.end());
+  merged.insert(merged.end(), rhs, other.entries_.end());
+
+  entries_ = std::move(merged);
+  return *this;
+}
+
+}  // namespace cfp
@@ -0,0 +1,267 @@
+#include "cfp/equation.hpp"
+
+#include <array>
+#include <cstdlib>  // abs
+#include <exception>
+#include <format>
+#include <limits>
+#include <numeric>  // gcd
+#include <stdexcept>  // invalid_argument
+#include <utility>  // swap
+
+#include "cfp/checked.hpp"
+#include "cfp/parser.hpp"
+#include "parallel.hpp"
+
+namespace cfp {
+
+namespace {
+
+__extension__ using wide_int = __int128;
+
+/// Narrow an exact intermediate back to a matrix entry.
+int64_t narrow(wide_int value) {
+  // symmetric range, so std::abs of an entry is always defined
+  constexpr wide_int LIMIT = std::numeric_limits<int64_t>::max();
+
+  if (value < -LIMIT || value > LIMIT) [[unlikely]] {
+    detail::throw_count_overflow("balancing intermediate exceeds 64 bits");
+  }
+
+  return static_cast<int64_t>(value);
+}
+
+/// Composition of one side, each species scaled by its coefficient.
+Composition side_total(const std::vector<Species> &side) {
+  Composition total;
+
+  for (const auto &species : side) {
+    auto scaled = species.composition;
+    scaled *= species.coefficient;
+    total += scaled;
+  }
+
+  return total;
+}
+
+void append_side(std::string &out, const std::vector<Species> &side) {
+  for (size_t idx = 0; idx < side.size(); idx++) {
+    if (idx != 0) {
+      out += " + ";
+    }
+
+    if (side[idx].coefficient != 1) {
+      out += std::to_string(side[idx].coefficient);
+    }
+
+    out += side[idx].formula;
+  }
+}
+
+}  // namespace
+
+Equation parse_equation(std::string_view input) {
+  EquationParser parser{input};
+  return parser.parseEquation();
+}
+
+std::string to_string(const Equation &equation) {
+  std::string out;
+
+  append_side(out, equation.reactants);
+  out += " -> ";
+  append_side(out, equation.products);
+
+  return out;
+}
+
+bool is_balanced(const Equation &equation) {
+  return side_total(equation.reactants) == side_total(equation.products);
+}
+
+void Balancer::balance(Equation &equation) {
+  build(equation);
+  eliminate();
+  solve();
+
+  size_t col = 0;
+
+  for (auto &species : equation.reactants) {
+    species.coefficient = static_cast<uint64_t>(solution_[col++]);
+  }
+
+  for (auto &species : equation.products) {
+    species.coefficient = static_cast<uint64_t>(solution_[col++]);
+  }
+}
+
+void Balancer::build(const Equation &equation) {
+  cols_ = equation.reactants.size() + equation.products.size();
+
+  if (equation.reactants.empty() || equation.products.empty()) {
+    throw std::invalid_argument{"equation needs reactants and products"};
+  }
+
+  // one row per element present anywhere, in ascending element order
+  std::array<size_t, Composition::CAPACITY> row_of{};
+  row_of.fill(Composition::CAPACITY);
+  rows_ = 0;
+
+  for (const auto *side : {&equation.reactants, &equation.products}) {
+    for (const auto &species : *side) {
+      for (const auto [id, count] : species.composition) {
+        row_of[id] = 0;
+      }
+    }
+  }
+
+  for (auto &row : row_of) {
+    if (row == 0) {
+      row = rows_++;
+    }
+  }
+
+  matrix_.assign(rows_ * cols_, 0);
+
+  size_t col = 0;
+
+  for (const auto *side : {&equation.reactants, &equation.products}) {
+    const wide_int sign = (side == &equation.reactants) ? 1 : -1;
+
+    for (const auto &species : *side) {
+      for (const auto [id, count] : species.composition) {
+        at(row_of[id], col) = narrow(sign * static_cast<wide_int>(count));
+      }
+      col += 1;
+    }
+  }
+}
+
+void Balancer::eliminate() {
+  pivots_.clear();
+
+  size_t rank = 0;
+
+  for (size_t col = 0; col < cols_ && rank < rows_; col++) {
+    // smallest non-zero pivot keeps the cross-multiplied entries small
+    size_t pivot = rows_;
+
+    for (size_t row = rank; row < rows_; row++) {
+      if (at(row, col) != 0 && (pivot == rows_ || std::abs(at(row, col)) < std::abs(at(pivot, col)))) {
+        pivot = row;
+      }
+    }
+
+    if (pivot == rows_) {
+      continue;  // free column
+    }
+
+    for (size_t idx = 0; idx < cols_; idx++) {
+      std::swap(at(rank, idx), at(pivot, idx));
+    }
+
+    // clear the column in every other row (reduced echelon form)
+    const wide_int lead = at(rank, col);
+
+    for (size_t row = 0; row < rows_; row++) {
+      const wide_int factor = at(row, col);
+
+      if (row == rank || factor == 0) {
+        continue;
+      }
+
+      int64_t divisor = 0;
+
+      for (size_t idx = 0; idx < cols_; idx++) {
+        at(row, idx) = narrow((lead * at(row, idx)) - (factor * at(rank, idx)));
+        divisor = std::gcd(divisor, at(row, idx));
+      }
+
+      if (divisor > 1) {
+        for (size_t idx = 0; idx < cols_; idx++) {
+          at(row, idx) /= divisor;
+        }
+      }
+    }
+
+    pivots_.push_back(col);
+    rank += 1;
+  }
+}
+
+void Balancer::solve() {
+  const size_t rank = pivots_.size();
+
+  if (rank + 1 != cols_) {
+    if (rank == cols_) {
+      throw std::invalid_argument{"reaction cannot be balanced"};
+    }
+    throw std::invalid_argument{
+        std::format("reaction has {} independent balancings; coefficients are not unique", cols_ - rank)};
+  }
+
+  // the single free column
+  size_t free = 0;
+
+  while (free < rank && pivots_[free] == free) {
+    free += 1;
+  }
+
+  // pivot rows read lead * x[pivot] + entry * x[free] = 0; choose x[free] so every x[pivot] is integral
+  int64_t scale = 1;
+
+  for (size_t row = 0; row < rank; row++) {
+    const int64_t lead = std::abs(at(row, pivots_[row]));
+    scale = narrow(static_cast<wide_int>(scale / std::gcd(scale, lead)) * lead);
+  }
+
+  solution_.assign(cols_, 0);
+  solution_[free] = scale;
+
+  for (size_t row = 0; row < rank; row++) {
+    const wide_int lead = at(row, pivots_[row]);
+    solution_[pivots_[row]] = narrow(-static_cast<wide_int>(at(row, free)) * scale / lead);
+  }
+
+  int64_t divisor = 0;
+
+  for (const auto value : solution_) {
+    divisor = std::gcd(divisor, value);
+  }
+
+  // x[free] > 0, so a balancing exists only if every other coefficient is positive too
+  for (auto &value : solution_) {
+    value /= divisor;
+
+    if (value <= 0) {
+      throw std::invalid_argument{"reaction has no balancing with all coefficients positive"};
+    }
+  }
+}
+
+void balance(Equation &equation) {
+  Balancer balancer;
+  balancer.balance(equation);
+}
+
+std::vector<BalancedReaction> balance_batch(std::span<const std::string_view> reactions, unsigned threads) {
+  std::vector<BalancedReaction> results(reactions.size());
+
+  const unsigned workers = detail::resolve_threads(threads, reactions.size());
+  std::vector<Balancer> balancers(workers);
+
+  detail::parallel_for(reactions.size(), workers, [&](size_t task, unsigned worker) {
+    auto &result = results[task];
+
+    try {
+      result.equation = parse_equation(reactions[task]);
+      balancers[worker].balance(result.equation);
+    } catch (const std::exception &err) {
+      result.error = err.what();
+    }
+  });
+
+  return results;
+}
+
+}  // namespace cfp
@@ -0,0 +1,13 @@
+#include "cfp/error/limit_error.hpp"
+
+#include <format>
+
+namespace cfp {
+
+LimitError::LimitError(size_t pos, LimitKind knd, uint64_t lim, std::string_view msg) :
+    std::runtime_error{std::format("Limit exceeded: {} (limit {}) at pos {} (kind={})", msg, lim, pos, to_string(knd))},
+    offset{pos},
+    kind{knd},
+    limit{lim} {}
+
+}  // namespace cfp
@@ -0,0 +1,23 @@
+#include "cfp/error/overflow_error.hpp"
+
+#include <format>
+
+#include "cfp/checked.hpp"
+
+namespace cfp {
+
+OverflowError::OverflowError(std::string_view msg) :
+    std::overflow_error{std::format("Count overflow: {}", msg)} {}
+
+OverflowError::OverflowError(const OverflowError &cause, size_t pos) :
+    std::overflow_error{std::format("{} at pos {}", cause.what(), pos)}, offset{pos} {}
+
+namespace detail {
+
+void throw_count_overflow(const char *operation) {
+  throw OverflowError{operation};
+}
+
+}  // namespace detail
+
+}  // namespace cfp
@@ -0,0 +1,10 @@
+#include "cfp/error/stream_error.hpp"
+
+#include <format>
+
+namespace cfp {
+
+StreamError::StreamError(size_t pos, DiagnosticKind knd, std::string_view msg) :
+    std::runtime_error{std::format("{} at pos {} (kind={})", msg, pos, to_string(knd))}, offset{pos}, kind{knd} {}
+
+}  // namespace cfp
@@ -0,0 +1,291 @@
+#include "cfp/fingerprint.hpp"
+
+#include <algorithm>  // lower_bound, min, sort, stable_sort
+#include <cctype>  // std::isdigit
+#include <exception>  // exception_ptr
+#include <format>
+#include <limits>
+#include <optional>
+#include <stdexcept>  // invalid_argument
+
+#include "cfp/ast.hpp"
+#include "cfp/checked.hpp"
+#include "cfp/element.hpp"
+#include "cfp/parser.hpp"
+#include "parallel.hpp"
+
+namespace cfp {
+
+namespace {
+
+/// Records per task.
+constexpr size_t BLOCK_SIZE = 1024;
+
+/// Order-dependent 64-bit hash of a canonical sequence (splitmix64 finalizer per step).
+class Hasher {
+public:
+  void add(uint64_t value) noexcept {
+    uint64_t mixed = state_ + 0x9e3779b97f4a7c15 + value;
+    mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111eb;
+    state_ = mixed ^ (mixed >> 31);
+  }
+
+  [[nodiscard]] uint64_t value() const noexcept {
+    return state_;
+  }
+
+private:
+  uint64_t state_{0x6366705f67726f75};  // "cfp_grou"
+};
+
+/// Sort by key and merge equal keys by a checked sum.
+template <typename Pair>
+void canonicalize(std::vector<Pair> &pairs) {
+  std::sort(pairs.begin(), pairs.end(), [](const Pair &lhs, const Pair &rhs) { return lhs.first < rhs.first; });
+
+  size_t kept = 0;
+
+  for (size_t idx = 0; idx < pairs.size(); idx++) {
+    if (kept > 0 && pairs[kept - 1].first == pairs[idx].first) {
+      pairs[kept - 1].second = checked_add(pairs[kept - 1].second, pairs[idx].second);
+    } else {
+      pairs[kept++] = pairs[idx];
+    }
+  }
+
+  pairs.resize(kept);
+}
+
+/// Fingerprint of a group's content, and of its only child if that is a group.
+struct Content {
+  GroupFingerprint fingerprint{0};
+
+  /// Fingerprint of the only child if the content is one group and nothing else.
+  std::optional<GroupFingerprint> sole_group;
+};
+
+/**
+ * @brief Fingerprint the content of @a node and record its nested groups.
+ * @param node    Unit or bracketed group of the parser's tree.
+ * @param copies  Copies of @a node in the formula (all multipliers up to and including its own).
+ * @param found   Receives one occurrence per nested group, with its copies.
+ */
+Content fingerprint_content(const GroupNode &node, uint64_t copies, std::vector<GroupCount> &found) {
+  std::vector<std::pair<ElementId, uint64_t>> elements;
+  std::vector<std::pair<GroupFingerprint, uint64_t>> groups;
+
+  for (const auto &child : node.children) {
+    if (const auto *group = dynamic_cast<const GroupNode *>(child.get())) {
+      const uint64_t group_copies = at_offset(group->offset, [&] { return checked_mul(copies, group->multiplier); });
+      const GroupFingerprint inner = fingerprint_content(*group, group_copies, found).fingerprint;
+
+      found.push_back({.fingerprint = inner, .count = group_copies});
+      groups.emplace_back(inner, group->multiplier);
+    } else {
+      // the parser rejects unknown symbols before fingerprinting
+      const auto &element = static_cast<const ElementNode &>(*child);
+      elements.emplace_back(element.id, element.count);
+    }
+  }
+
+  Content result;
+
+  if (elements.empty() && groups.size() == 1) {
+    result.sole_group = groups[0].first;
+  }
+
+  at_offset(node.offset, [&] {
+    canonicalize(elements);
+    canonicalize(groups);
+  });
+
+  // sizes first, so element and group runs cannot be confused
+  Hasher hasher;
+  hasher.add(elements.size());
+  hasher.add(groups.size());
+
+  for (const auto &[id, count] : elements) {
+    hasher.add(id);
+    hasher.add(count);
+  }
+
+  for (const auto &[fingerprint, mult] : groups) {
+    hasher.add(fingerprint);
+    hasher.add(mult);
+  }
+
+  result.fingerprint = hasher.value();
+  return result;
+}
+
+}  // namespace
+
+namespace detail {
+
+FormulaFingerprints fingerprint_tree(const GroupNode &root) {
+  FormulaFingerprints result;
+  std::vector<GroupCount> found;
+
+  // the parser makes every unit a GroupNode
+  for (const auto &child : root.children) {
+    const auto &unit = static_cast<const GroupNode &>(*child);
+    const auto content = fingerprint_content(unit, unit.multiplier, found);
+
+    result.units.push_back(content.sole_group.value_or(content.fingerprint));
+  }
+
+  std::vector<std::pair<GroupFingerprint, uint64_t>> merged;
+  merged.reserve(found.size());
+
+  for (const auto &occurrence : found) {
+    merged.emplace_back(occurrence.fingerprint, occurrence.count);
+  }
+
+  canonicalize(merged);
+
+  result.groups.reserve(merged.size());
+
+  for (const auto &[fingerprint, count] : merged) {
+    result.groups.push_back({.fingerprint = fingerprint, .count = count});
+  }
+
+  return result;
+}
+
+}  // namespace detail
+
+GroupFingerprint group_fingerprint(std::string_view motif, const ParseLimits &limits) {
+  if (!motif.empty() && std::isdigit(static_cast<unsigned char>(motif.front())) != 0) {
+    throw std::invalid_argument{"motif must not have a unit multiplier"};
+  }
+
+  const auto units = Parser{motif, limits}.parseFingerprints().units;
+
+  if (units.size() != 1) {
+    throw std::invalid_argument{"motif must be a single unit"};
+  }
+
+  return units[0];
+}
+
+std::vector<GroupCount> group_fingerprints(std::string_view formula, const ParseLimits &limits) {
+  return Parser{formula, limits}.parseFingerprints().groups;
+}
+
+FingerprintIndex FingerprintIndex::build(std::span<const std::string_view> formulas, unsigned threads,
+                                         const ParseLimits &limits) {
+  if (formulas.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument{std::format("cannot index {} records (at most 2^32 - 1)", formulas.size())};
+  }
+
+  struct Posting {
+    GroupFingerprint fingerprint;
+    uint32_t record;
+    uint64_t count;
+  };
+
+  struct Block {
+    std::vector<Posting> postings;
+
+    /// First failing record of the block (records run in order within a block).
+    std::exception_ptr error;
+  };
+
+  const size_t blocks = (formulas.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  std::vector<Block> state(blocks);
+
+  detail::parallel_for(blocks, detail::resolve_threads(threads, blocks), [&](size_t block, unsigned /*worker*/) {
+    auto &own = state[block];
+    const size_t end = std::min(formulas.size(), (block + 1) * BLOCK_SIZE);
+
+    for (size_t record = block * BLOCK_SIZE; record < end; record++) {
+      try {
+        for (const auto &group : group_fingerprints(formulas[record], limits)) {
+          own.postings.push_back(
+              {.fingerprint = group.fingerprint, .record = static_cast<uint32_t>(record), .count = group.count});
+        }
+      } catch (...) {
+        own.error = std::current_exception();
+        return;
+      }
+    }
+  });
+
+  size_t total = 0;
+
+  for (const auto &block : state) {
+    if (block.error) {
+      std::rethrow_exception(block.error);
+    }
+
+    total += block.postings.size();
+  }
+
+  std::vector<Posting> postings;
+  postings.reserve(total);
+
+  for (auto &block : state) {
+    postings.insert(postings.end(), block.postings.begin(), block.postings.end());
+    block.postings = {};
+  }
+
+  // blocks are concatenated in record order, so a stable sort keeps records ascending per fingerprint
+  std::stable_sort(postings.begin(), postings.end(),
+                   [](const Posting &lhs, const Posting &rhs) { return lhs.fingerprint < rhs.fingerprint; });
+
+  FingerprintIndex index;
+  index.records_ = formulas.size();
+  index.limits_ = limits;
+  index.record_ids_.reserve(postings.size());
+  index.counts_.reserve(postings.size());
+
+  for (size_t idx = 0; idx < postings.size(); idx++) {
+    if (idx == 0 || postings[idx].fingerprint != postings[idx - 1].fingerprint) {
+      index.fingerprints_.push_back(postings[idx].fingerprint);
+      index.offsets_.push_back(idx);
+    }
+
+    index.record_ids_.push_back(postings[idx].record);
+    index.counts_.push_back(postings[idx].count);
+  }
+
+  index.offsets_.push_back(postings.size());
+
+  return index;
+}
+
+std::pair<size_t, size_t> FingerprintIndex::postings(GroupFingerprint fingerprint) const noexcept {
+  const auto found = std::lower_bound(fingerprints_.begin(), fingerprints_.end(), fingerprint);
+
+  if (found == fingerprints_.end() || *found != fingerprint) {
+    return {0, 0};
+  }
+
+  const auto slot = static_cast<size_t>(found - fingerprints_.begin());
+  return {offsets_[slot], offsets_[slot + 1]};
+}
+
+std::vector<MotifMatch> FingerprintIndex::find(GroupFingerprint fingerprint) const {
+  const auto [begin, end] = postings(fingerprint);
+
+  std::vector<MotifMatch> matches;
+  matches.reserve(end - begin);
+
+  for (size_t idx = begin; idx < end; idx++) {
+    matches.push_back({.record = record_ids_[idx], .count = counts_[idx]});
+  }
+
+  return matches;
+}
+
+std::vector<MotifMatch> FingerprintIndex::find(std::string_view motif) const {
+  return find(group_fingerprint(motif, limits_));
+}
+
+size_t FingerprintIndex::recordCount(GroupFingerprint fingerprint) const noexcept {
+  const auto [begin, end] = postings(fingerprint);
+  return end - begin;
+}
+
+}  // namespace cfp
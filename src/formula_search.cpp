@@ -0,0 +1,310 @@
+#include "cfp/formula_search.hpp"
+
+#include <algorithm>  // sort, max, min
+#include <array>
+#include <cmath>  // ceil, floor, abs
+#include <cstddef>  // size_t
+#include <format>
+#include <stdexcept>  // invalid_argument
+
+#include "cfp/isotope.hpp"
+#include "parallel.hpp"
+
+namespace cfp {
+
+namespace {
+
+/// Lowest common valence per element; elements not listed count as 2 (no RDBE contribution).
+constexpr auto VALENCES = [] {
+  std::array<uint8_t, ELEMENT_COUNT + 1> valences{};
+  valences.fill(2);
+
+  for (const auto symbol : {"H", "Li", "Na", "K", "Rb", "Cs", "F", "Cl", "Br", "I", "Ag"}) {
+    valences[element_id(symbol)] = 1;
+  }
+
+  for (const auto symbol : {"B", "Al", "N", "P", "As", "Sb"}) {
+    valences[element_id(symbol)] = 3;
+  }
+
+  for (const auto symbol : {"C", "Si", "Ge", "Sn"}) {
+    valences[element_id(symbol)] = 4;
+  }
+
+  return valences;
+}();
+
+/// An element of a search, with its monoisotopic mass.
+struct SearchElement {
+  ElementId id{0};
+  double mass{0.0};
+  uint32_t min{0};
+  uint32_t max{0};
+};
+
+/**
+ * @brief Branch-and-bound enumeration state for one query.
+ *
+ * Elements are ordered by descending mass; suffix bounds give the lightest
+ * and heaviest completion of the remaining elements.
+ */
+class Search {
+public:
+  explicit Search(const FormulaQuery &query) :
+      lower_{query.mass - query.tolerance}, upper_{query.mass + query.tolerance}, target_{query.mass},
+      filter_{query.filter} {
+    if (query.elements.empty()) {
+      throw std::invalid_argument{"formula search needs at least one element"};
+    }
+
+    if (query.tolerance < 0.0) {
+      throw std::invalid_argument{"formula search tolerance must be non-negative"};
+    }
+
+    Composition seen;
+
+    for (const auto &range : query.elements) {
+      const double mass = monoisotopic_mass(range.element);
+
+      if (mass <= 0.0) {
+        throw std::invalid_argument{std::format("no isotope mass for element id {}", range.element)};
+      }
+
+      if (range.min > range.max) {
+        throw std::invalid_argument{
+            std::format("invalid range {}..{} for '{}'", range.min, range.max, element_symbol(range.element))};
+      }
+
+      if (seen.contains(range.element)) {
+        throw std::invalid_argument{std::format("duplicate element '{}'", element_symbol(range.element))};
+      }
+
+      seen.add(range.element, 1);
+      elements_.push_back({.id = range.element, .mass = mass, .min = range.min, .max = range.max});
+    }
+
+    std::sort(elements_.begin(), elements_.end(),
+              [](const SearchElement &lhs, const SearchElement &rhs) { return lhs.mass > rhs.mass; });
+
+    suffix_min_.assign(elements_.size() + 1, 0.0);
+    suffix_max_.assign(elements_.size() + 1, 0.0);
+
+    for (size_t idx = elements_.size(); idx-- > 0;) {
+      suffix_min_[idx] = suffix_min_[idx + 1] + elements_[idx].mass * elements_[idx].min;
+      suffix_max_[idx] = suffix_max_[idx + 1] + elements_[idx].mass * elements_[idx].max;
+    }
+  }
+
+  /// Number of top-level tasks (counts of the heaviest element).
+  [[nodiscard]] size_t tasks() const noexcept {
+    return size_t{elements_[0].max} - elements_[0].min + 1;
+  }
+
+  /// Enumerate all candidates whose heaviest-element count is min + @a task.
+  void runTask(size_t task, std::vector<FormulaCandidate> &out) const {
+    std::vector<uint32_t> counts(elements_.size(), 0);
+    counts[0] = elements_[0].min + static_cast<uint32_t>(task);
+
+    const double mass = elements_[0].mass * counts[0];
+
+    if (mass + suffix_min_[1] > upper_ || mass + suffix_max_[1] < lower_) {
+      return;
+    }
+
+    visit(1, mass, counts, out);
+  }
+
+private:
+  std::vector<SearchElement> elements_;
+  std::vector<double> suffix_min_;
+  std::vector<double> suffix_max_;
+  double lower_;
+  double upper_;
+  double target_;
+  FormulaFilter filter_;
+
+  void visit(size_t depth, double mass, std::vector<uint32_t> &counts, std::vector<FormulaCandidate> &out) const {
+    if (depth == elements_.size()) {
+      emit(counts, out);
+      return;
+    }
+
+    const auto &element = elements_[depth];
+
+    // last element: solve the count range directly
+    if (depth + 1 == elements_.size()) {
+      const double first = std::max<double>(element.min, std::ceil((lower_ - mass) / element.mass));
+      const double last = std::min<double>(element.max, std::floor((upper_ - mass) / element.mass));
+
+      for (double count = first; count <= last; count += 1.0) {
+        counts[depth] = static_cast<uint32_t>(count);
+        emit(counts, out);
+      }
+      return;
+    }
+
+    for (uint32_t count = element.min; count <= element.max; count++) {
+      const double next = mass + element.mass * count;
+
+      if (next + suffix_min_[depth + 1] > upper_) {
+        break;  // heavier counts only overshoot further
+      }
+
+      if (next + suffix_max_[depth + 1] < lower_) {
+        continue;  // cannot reach the window yet
+      }
+
+      counts[depth] = count;
+      visit(depth + 1, next, counts, out);
+    }
+  }
+
+  void emit(const std::vector<uint32_t> &counts, std::vector<FormulaCandidate> &out) const {
+    Composition comp;
+    double mass = 0.0;
+
+    for (size_t idx = 0; idx < elements_.size(); idx++) {
+      comp.add(elements_[idx].id, counts[idx]);
+      mass += elements_[idx].mass * counts[idx];
+    }
+
+    if (comp.empty() || mass < lower_ || mass > upper_) {
+      return;
+    }
+
+    const double value = rdbe(comp);
+
+    if (value < filter_.min_rdbe || value > filter_.max_rdbe) {
+      return;
+    }
+
+    if (filter_.integer_rdbe && value != std::floor(value)) {
+      return;
+    }
+
+    if (filter_.golden_rules && !passes_golden_rules(comp)) {
+      return;
+    }
+
+    out.push_back({.composition = comp, .mass = mass, .error = mass - target_, .rdbe = value});
+  }
+};
+
+bool ratioAtMost(uint64_t count, uint64_t carbon, double ratio) noexcept {
+  return static_cast<double>(count) <= ratio * static_cast<double>(carbon);
+}
+
+}  // namespace
+
+double rdbe(const Composition &comp) noexcept {
+  double sum = 0.0;
+
+  for (const auto &[id, count] : comp) {
+    sum += static_cast<double>(count) * (VALENCES[id] - 2);
+  }
+
+  return 1.0 + sum / 2.0;
+}
+
+bool passes_golden_rules(const Composition &comp) noexcept {
+  // rule 2: LEWIS and SENIOR checks
+  uint64_t valence_sum = 0;
+  uint64_t max_valence = 0;
+  uint64_t atoms = 0;
+
+  for (const auto &[id, count] : comp) {
+    valence_sum += VALENCES[id] * count;
+    max_valence = std::max<uint64_t>(max_valence, VALENCES[id]);
+    atoms += count;
+  }
+
+  if (valence_sum % 2 != 0 || valence_sum < 2 * max_valence || (atoms > 0 && valence_sum < 2 * (atoms - 1))) {
+    return false;
+  }
+
+  const uint64_t carbon = comp.count("C");
+  const uint64_t nitrogen = comp.count("N");
+  const uint64_t oxygen = comp.count("O");
+  const uint64_t phosphorus = comp.count("P");
+  const uint64_t sulfur = comp.count("S");
+
+  // rules 4 and 5: element ratios relative to carbon (common range)
+  if (carbon > 0) {
+    const uint64_t hydrogen = comp.count("H");
+
+    // clang-format off
+    if (!ratioAtMost(hydrogen, carbon, 3.1) || static_cast<double>(hydrogen) < 0.2 * static_cast<double>(carbon) ||
+        !ratioAtMost(nitrogen, carbon, 1.3) || !ratioAtMost(oxygen, carbon, 1.2) ||
+        !ratioAtMost(phosphorus, carbon, 0.3) || !ratioAtMost(sulfur, carbon, 0.8) ||
+        !ratioAtMost(comp.count("F"), carbon, 1.5) || !ratioAtMost(comp.count("Cl"), carbon, 0.8) ||
+        !ratioAtMost(comp.count("Br"), carbon, 0.8) || !ratioAtMost(comp.count("Si"), carbon, 0.5)) {
+      return false;
+    }
+    // clang-format on
+  }
+
+  // rule 6: heteroatom probability checks
+  if (nitrogen > 1 && oxygen > 1 && phosphorus > 1 && sulfur > 1 &&
+      (nitrogen >= 10 || oxygen >= 20 || phosphorus >= 4 || sulfur >= 3)) {
+    return false;
+  }
+
+  if (nitrogen > 3 && oxygen > 3 && phosphorus > 3 && (nitrogen >= 11 || oxygen >= 22 || phosphorus >= 6)) {
+    return false;
+  }
+
+  if (oxygen > 1 && phosphorus > 1 && sulfur > 1 && (oxygen >= 14 || phosphorus >= 3 || sulfur >= 3)) {
+    return false;
+  }
+
+  if (phosphorus > 1 && sulfur > 1 && nitrogen > 1 && (phosphorus >= 3 || sulfur >= 3 || nitrogen >= 4)) {
+    return false;
+  }
+
+  if (nitrogen > 6 && oxygen > 6 && sulfur > 6 && (nitrogen >= 19 || oxygen >= 14 || sulfur >= 8)) {
+    return false;
+  }
+
+  return true;
+}
+
+std::vector<FormulaCandidate> find_formulas(const FormulaQuery &query, unsigned threads) {
+  const Search search{query};
+
+  const unsigned workers = detail::resolve_threads(threads, search.tasks());
+  std::vector<std::vector<FormulaCandidate>> partial(workers);
+
+  detail::parallel_for(search.tasks(), workers,
+                       [&](size_t task, unsigned worker) { search.runTask(task, partial[worker]); });
+
+  std::vector<FormulaCandidate> candidates;
+
+  for (auto &part : partial) {
+    candidates.insert(candidates.end(), part.begin(), part.end());
+  }
+
+  // deterministic order regardless of the thread schedule
+  std::sort(candidates.begin(), candidates.end(), [](const FormulaCandidate &lhs, const FormulaCandidate &rhs) {
+    const double lhs_error = std::abs(lhs.error);
+    const double rhs_error = std::abs(rhs.error);
+
+    if (lhs_error != rhs_error) {
+      return lhs_error < rhs_error;
+    }
+    return lhs.composition.counts() < rhs.composition.counts();
+  });
+
+  return candidates;
+}
+
+std::vector<std::vector<FormulaCandidate>> find_formulas_batch(std::span<const FormulaQuery> queries,
+                                                               unsigned threads) {
+  std::vector<std::vector<FormulaCandidate>> results(queries.size());
+
+  detail::parallel_for(queries.size(), detail::resolve_threads(threads, queries.size()),
+                       [&](size_t task, unsigned /*worker*/) { results[task] = find_formulas(queries[task], 1); });
+
+  return results;
+}
+
+}  // namespace cfp
@@ -0,0 +1,311 @@
+#include "cfp/isotope_pattern.hpp"
+
+#include <algorithm>  // make_heap, min, pop_heap, push_heap, sort
+#include <array>
+#include <bit>  // bit_cast, bit_width
+#include <cstdint>  // uint64_t
+#include <format>
+#include <limits>  // numeric_limits
+#include <stdexcept>  // invalid_argument
+#include <utility>  // move
+
+#include "cfp/checked.hpp"
+#include "cfp/isotope.hpp"
+
+namespace cfp {
+
+namespace {
+
+/// Share of the threshold that one intermediate convolution may discard.
+constexpr double PRUNE_BUDGET = 1.0 / 64;
+
+/**
+ * @class ExponentHistogram
+ * @brief Summed probability per binary exponent, for choosing a prune cutoff in one pass.
+ *
+ * Dropping whole exponent buckets, lowest first, keeps at most one bucket
+ * (a factor of two in probability) more than an exact selection would, at
+ * the cost of one addition per probability instead of a sort.
+ */
+class ExponentHistogram {
+public:
+  /// @param probability  Probability in [0, 1].
+  void add(double probability) noexcept {
+    const uint64_t exponent = std::bit_cast<uint64_t>(probability) >> 52;
+    sums_[exponent] += probability;
+    lowest_ = std::min(lowest_, exponent);
+  }
+
+  /**
+   * @brief Lowest probability to keep so that the dropped ones (all below it) sum to at most @a budget.
+   * @return A power of two (0 if the zero and subnormal bucket already exceeds the budget),
+   *         or infinity if everything fits.
+   */
+  [[nodiscard]] double cutoff(double budget) const noexcept {
+    double dropped = 0.0;
+
+    for (uint64_t exponent = lowest_; exponent < sums_.size(); exponent++) {
+      dropped += sums_[exponent];
+
+      if (dropped > budget) {
+        return std::bit_cast<double>(exponent << 52);
+      }
+    }
+
+    return std::numeric_limits<double>::infinity();
+  }
+
+private:
+  /// Indexed by the biased IEEE-754 exponent: 1023 for [1, 2), 0 for zero and subnormals.
+  std::array<double, 1024> sums_{};
+
+  uint64_t lowest_{sums_.size()};
+};
+
+/**
+ * @brief Drop the least probable bins while their summed probability stays within @a budget.
+ *
+ * Unlike a per-bin cutoff, this bounds the probability an intermediate
+ * pattern loses, and with it the error of every peak built from it.
+ */
+void prune(IsotopeDistribution &peaks, double budget) {
+  ExponentHistogram histogram;
+
+  for (const auto &peak : peaks) {
+    histogram.add(peak.probability);
+  }
+
+  const double cutoff = histogram.cutoff(budget);
+  std::erase_if(peaks, [cutoff](const Peak &peak) { return peak.probability < cutoff; });
+}
+
+}  // namespace
+
+IsotopeCalculator::IsotopeCalculator(IsotopeOptions options)
+    : options_{options}, powers_(ELEMENT_COUNT + 1), patterns_(ELEMENT_COUNT + 1) {}
+
+IsotopeDistribution IsotopeCalculator::compute(const Composition &comp) {
+  if (comp.empty()) {
+    return {};
+  }
+
+  IsotopeDistribution result{{.mass = 0.0, .probability = 1.0, .nominal = 0}};
+
+  for (const auto &[id, count] : comp) {
+    result = convolve(result, elementPattern(id, count));
+  }
+
+  std::erase_if(result, [this](const Peak &peak) { return peak.probability < options_.threshold; });
+  return result;
+}
+
+std::vector<IsotopeDistribution> IsotopeCalculator::computeBatch(std::span<const Composition> comps) {
+  std::vector<IsotopeDistribution> results;
+  results.reserve(comps.size());
+
+  for (const auto &comp : comps) {
+    results.push_back(compute(comp));
+  }
+
+  return results;
+}
+
+void IsotopeCalculator::clearCache() noexcept {
+  for (auto &powers : powers_) {
+    powers.clear();
+  }
+
+  for (auto &patterns : patterns_) {
+    patterns.clear();
+  }
+}
+
+const IsotopeDistribution &IsotopeCalculator::elementPattern(ElementId id, uint64_t count) {
+  auto &patterns = patterns_[id];
+
+  if (const auto it = patterns.find(count); it != patterns.end()) {
+    return it->second;
+  }
+
+  // n atoms = product of the 2^k patterns for the set bits of n
+  IsotopeDistribution pattern;
+  const auto bits = static_cast<uint8_t>(std::bit_width(count));
+
+  for (uint8_t exponent = 0; exponent < bits; exponent++) {
+    if (((count >> exponent) & 1U) == 0) {
+      continue;
+    }
+
+    pattern = pattern.empty() ? powerPattern(id, exponent) : convolve(pattern, powerPattern(id, exponent));
+  }
+
+  return patterns.emplace(count, std::move(pattern)).first->second;
+}
+
+const IsotopeDistribution &IsotopeCalculator::powerPattern(ElementId id, uint8_t exponent) {
+  auto &powers = powers_[id];
+
+  if (powers.empty()) {
+    const auto element_isotopes = isotopes(id);
+
+    if (element_isotopes.empty()) {
+      throw std::invalid_argument{std::format("no natural isotopes for element '{}'", element_symbol(id))};
+    }
+
+    IsotopeDistribution single;
+    single.reserve(element_isotopes.size());
+
+    for (const auto &isotope : element_isotopes) {
+      single.push_back({.mass = isotope.mass, .probability = isotope.abundance, .nominal = isotope.mass_number});
+    }
+
+    merge(single);
+    powers.push_back(std::move(single));
+  }
+
+  // repeated squaring up to the requested power
+  while (powers.size() <= exponent) {
+    powers.push_back(convolve(powers.back(), powers.back()));
+  }
+
+  return powers[exponent];
+}
+
+IsotopeDistribution IsotopeCalculator::convolve(const IsotopeDistribution &lhs, const IsotopeDistribution &rhs) const {
+  // half the budget skips terms, half prunes the merged bins
+  const double budget = options_.threshold * PRUNE_BUDGET / 2;
+
+  // skip the least probable products that fit the budget together; the
+  // histogram pass only multiplies, products are built once the cutoff is known
+  ExponentHistogram histogram;
+
+  for (const auto &right : rhs) {
+    for (const auto &left : lhs) {
+      histogram.add(left.probability * right.probability);
+    }
+  }
+
+  const double cutoff = histogram.cutoff(budget);
+
+  // both sides are sorted by bin key, so the products of one right peak form a
+  // sorted run; a k-way merge over the runs (a heap with one cursor per run)
+  // yields the products in bin order, straight into the coalesced bins,
+  // without storing them all first
+  const bool aggregated = options_.mode == IsotopeMode::Aggregated;
+
+  struct Cursor {
+    /// Bin key of the current product (masses are non-negative, so their bits sort like them).
+    uint64_t key;
+
+    size_t left;
+    size_t right;
+  };
+
+  // move a cursor to the first product of its run at or after @a left that reaches the cutoff
+  const auto seek = [&](Cursor &cursor, size_t left) {
+    const auto &right = rhs[cursor.right];
+
+    for (; left < lhs.size(); left++) {
+      if (lhs[left].probability * right.probability >= cutoff) {
+        cursor.key = aggregated ? checked_add(lhs[left].nominal, right.nominal)
+                                : std::bit_cast<uint64_t>(lhs[left].mass + right.mass);
+        cursor.left = left;
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  const auto later = [](const Cursor &lhs_cursor, const Cursor &rhs_cursor) { return lhs_cursor.key > rhs_cursor.key; };
+
+  std::vector<Cursor> heap;
+  heap.reserve(rhs.size());
+
+  for (size_t right = 0; right < rhs.size(); right++) {
+    Cursor cursor{.key = 0, .left = 0, .right = right};
+
+    if (seek(cursor, 0)) {
+      heap.push_back(cursor);
+    }
+  }
+
+  std::make_heap(heap.begin(), heap.end(), later);
+  IsotopeDistribution peaks;
+
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), later);
+    auto &cursor = heap.back();
+
+    const auto &left = lhs[cursor.left];
+    const auto &right = rhs[cursor.right];
+    const Peak product{
+        .mass = left.mass + right.mass,
+        .probability = left.probability * right.probability,
+        .nominal = checked_add(left.nominal, right.nominal),
+    };
+
+    if (peaks.empty() || !absorb(peaks.back(), product)) {
+      peaks.push_back(product);
+    }
+
+    if (seek(cursor, cursor.left + 1)) {
+      std::push_heap(heap.begin(), heap.end(), later);
+    } else {
+      heap.pop_back();
+    }
+  }
+
+  // many small terms can add up to a real peak: prune merged bins, not terms
+  prune(peaks, budget);
+  return peaks;
+}
+
+void IsotopeCalculator::merge(IsotopeDistribution &peaks) const {
+  const bool aggregated = options_.mode == IsotopeMode::Aggregated;
+
+  std::sort(peaks.begin(), peaks.end(), [aggregated](const Peak &lhs, const Peak &rhs) {
+    return aggregated ? lhs.nominal < rhs.nominal : lhs.mass < rhs.mass;
+  });
+
+  coalesce(peaks);
+}
+
+void IsotopeCalculator::coalesce(IsotopeDistribution &peaks) const {
+  if (peaks.empty()) {
+    return;
+  }
+
+  size_t out = 0;
+
+  for (size_t idx = 1; idx < peaks.size(); idx++) {
+    if (!absorb(peaks[out], peaks[idx])) {
+      peaks[++out] = peaks[idx];
+    }
+  }
+
+  peaks.resize(out + 1);
+}
+
+bool IsotopeCalculator::absorb(Peak &bin, const Peak &peak) const noexcept {
+  const bool same_bin = options_.mode == IsotopeMode::Aggregated ? peak.nominal == bin.nominal
+                                                                 : peak.mass - bin.mass < options_.resolution;
+
+  if (!same_bin) {
+    return false;
+  }
+
+  // probability-weighted centroid
+  const double probability = bin.probability + peak.probability;
+  bin.mass = (bin.mass * bin.probability + peak.mass * peak.probability) / probability;
+  bin.nominal = peak.probability > bin.probability ? peak.nominal : bin.nominal;
+  bin.probability = probability;
+  return true;
+}
+
+IsotopeDistribution isotope_distribution(const Composition &comp, IsotopeOptions options) {
+  IsotopeCalculator calculator{options};
+  return calculator.compute(comp);
+}
+
+}  // namespace cfp
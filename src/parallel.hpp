@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>  // min
+#include <atomic>
+#include <cstddef>  // size_t
+#include <exception>  // exception_ptr
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cfp::detail {
+
+/**
+ * @brief Number of workers for a parallel job.
+ * @param threads  Requested threads (0 = hardware concurrency).
+ * @param tasks    Number of tasks (no more workers than tasks).
+ * @return         At least 1.
+ */
+inline unsigned resolve_threads(unsigned threads, size_t tasks) noexcept {
+  if (threads == 0) {
+    threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+
+  return static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, tasks)));
+}
+
+/**
+ * @brief Run fn(task, worker) for every task in [0, count) on a pool of workers.
+ *
+ * Tasks are handed out dynamically (atomic counter), so uneven task costs
+ * balance out. The caller's thread is worker 0. The first exception thrown
+ * by any task is rethrown after all workers have stopped.
+ *
+ * @param count    Number of tasks.
+ * @param workers  Number of workers (see resolve_threads()).
+ * @param fn       Callable as fn(size_t task, unsigned worker).
+ */
+template <typename Fn>
+void parallel_for(size_t count, unsigned workers, Fn &&fn) {
+  if (workers <= 1) {
+    for (size_t task = 0; task < count; task++) {
+      fn(task, 0U);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  const auto work = [&](unsigned worker) {
+    try {
+      for (size_t task = next++; task < count; task = next++) {
+        fn(task, worker);
+      }
+    } catch (...) {
+      const std::lock_guard lock{error_mutex};
+      if (!error) {
+        error = std::current_exception();
+      }
+      next = count;  // stop handing out tasks
+    }
+  };
+
+  {
+    std::vector<std::jthread> pool;
+    pool.reserve(workers - 1);
+
+    for (unsigned worker = 1; worker < workers; worker++) {
+      pool.emplace_back(work, worker);
+    }
+
+    work(0);
+  }  // join
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace cfp::detail
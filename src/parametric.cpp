@@ -0,0 +1,139 @@
+#include "cfp/parametric.hpp"
+
+#include <algorithm>  // copy, find, max
+#include <array>
+#include <format>
+#include <stdexcept>  // invalid_argument, out_of_range
+#include <utility>  // move
+
+#include "cfp/checked.hpp"
+
+namespace cfp {
+
+ParametricComposition::ParametricComposition(std::vector<std::string> names, std::vector<Composition> terms) :
+    names_{std::move(names)}, terms_{std::move(terms)} {
+  if (terms_.size() != names_.size() + 1) {
+    throw std::invalid_argument{
+        std::format("{} parameters need {} terms, got {}", names_.size(), names_.size() + 1, terms_.size())};
+  }
+
+  // union of all terms' elements, ascending
+  std::array<uint64_t, Composition::MASK_WORDS> mask{};
+
+  for (const auto &term : terms_) {
+    for (size_t word = 0; word < mask.size(); word++) {
+      mask[word] |= term.mask()[word];
+    }
+  }
+
+  for (size_t id = 1; id < Composition::CAPACITY; id++) {
+    if (((mask[id / 64] >> (id % 64)) & 1U) != 0) {
+      elements_.push_back(static_cast<ElementId>(id));
+    }
+  }
+
+  constant_.reserve(elements_.size());
+  coefficients_.reserve(names_.size() * elements_.size());
+
+  for (const auto id : elements_) {
+    constant_.push_back(terms_[0][id]);
+  }
+
+  for (size_t param = 0; param < names_.size(); param++) {
+    for (const auto id : elements_) {
+      coefficients_.push_back(terms_[param + 1][id]);
+    }
+  }
+}
+
+std::optional<size_t> ParametricComposition::parameterIndex(std::string_view name) const noexcept {
+  const auto found = std::find(names_.begin(), names_.end(), name);
+
+  if (found == names_.end()) {
+    return std::nullopt;
+  }
+
+  return static_cast<size_t>(found - names_.begin());
+}
+
+const Composition &ParametricComposition::coefficient(size_t param) const {
+  if (param >= names_.size()) {
+    throw std::out_of_range{std::format("parameter index {} out of range ({} parameters)", param, names_.size())};
+  }
+
+  return terms_[param + 1];
+}
+
+Composition ParametricComposition::evaluate(std::span<const uint64_t> values) const {
+  if (values.size() != names_.size()) {
+    throw std::invalid_argument{std::format("expected {} parameter values, got {}", names_.size(), values.size())};
+  }
+
+  Composition result = terms_[0];
+
+  for (size_t param = 0; param < names_.size(); param++) {
+    result += terms_[param + 1] * values[param];
+  }
+
+  return result;
+}
+
+void ParametricComposition::evaluate(std::span<const uint64_t> values, std::span<uint64_t> out) const {
+  const size_t params = names_.size();
+  const size_t width = elements_.size();
+
+  if (params == 0) {
+    throw std::invalid_argument{"formula has no parameters; use constant()"};
+  }
+
+  if (values.size() % params != 0 || out.size() != (values.size() / params) * width) {
+    throw std::invalid_argument{std::format("{} values of {} parameters need {} output counts, got {}", values.size(),
+                                            params, (values.size() / params) * width, out.size())};
+  }
+
+  const size_t rows = values.size() / params;
+
+  // Bound every count by the per-parameter maxima once; if that bound fits,
+  // no row can overflow and the loops below need no per-element checks.
+  std::vector<uint64_t> max_value(params, 0);
+
+  for (size_t row = 0; row < rows; row++) {
+    for (size_t param = 0; param < params; param++) {
+      max_value[param] = std::max(max_value[param], values[(row * params) + param]);
+    }
+  }
+
+  bool bounded = true;
+
+  for (size_t col = 0; col < width; col++) {
+    uint64_t bound = constant_[col];
+
+    for (size_t param = 0; param < params; param++) {
+      uint64_t term = 0;
+      bounded &= !__builtin_mul_overflow(coefficients_[(param * width) + col], max_value[param], &term);
+      bounded &= !__builtin_add_overflow(bound, term, &bound);
+    }
+  }
+
+  for (size_t row = 0; row < rows; row++) {
+    uint64_t *dest = out.data() + (row * width);
+    std::copy(constant_.begin(), constant_.end(), dest);
+
+    for (size_t param = 0; param < params; param++) {
+      const uint64_t value = values[(row * params) + param];
+      const uint64_t *coefficients = coefficients_.data() + (param * width);
+
+      if (bounded) {
+        for (size_t col = 0; col < width; col++) {
+          dest[col] += coefficients[col] * value;
+        }
+      } else {
+        for (size_t col = 0; col < width; col++) {
+          dest[col] = checked_add(dest[col], checked_mul(coefficients[col], value));
+        }
+      }
+    }
+  }
+}
+
+}  // namespace cfp
@@ -0,0 +1,290 @@
+#include "cfp/parser_context.hpp"
+
+#include <algorithm>  // ranges::find_if
+#include <format>
+#include <limits>
+
+#include "cfp/checked.hpp"
+#include "cfp/element.hpp"
+#include "cfp/error/limit_error.hpp"
+#include "cfp/error/overflow_error.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/tokenizer.hpp"
+
+namespace cfp {
+
+const Composition &ParserContext::parse(std::string_view input) {
+  reset();
+
+  // a failed parse leaves no partial result behind
+  try {
+    input_ = input;
+    tokenizer_.emplace(input, limits_);
+    tokens_.push_back(tokenizer_->peek());
+
+    parseUnits();
+
+    try {
+      evaluate();
+    } catch (const OverflowError &) {
+      if (limits_.max_count == std::numeric_limits<uint64_t>::max()) {
+        throw;
+      }
+
+      throw LimitError{input_.size(), LimitKind::Count, limits_.max_count, "element count beyond the count range"};
+    }
+
+    checkCounts();
+  } catch (...) {
+    result_.clear();
+    throw;
+  }
+
+  return result_;
+}
+
+void ParserContext::reset() noexcept {
+  tokenizer_.reset();
+  tokens_.clear();
+  units_.clear();
+  multipliers_.clear();
+  result_.clear();
+  input_ = {};
+  pos_ = 0;
+  depth_ = 0;
+}
+
+std::span<const Token> ParserContext::tokens() const noexcept {
+  return tokens_.empty() ? std::span<const Token>{} : std::span{tokens_}.first(tokens_.size() - 1);
+}
+
+ParserContext &ParserContext::forThread() {
+  thread_local ParserContext context;
+  return context;
+}
+
+Token ParserContext::peek() {
+  // lexed on demand, so lex and limit errors come in the same order as from BasicParser
+  if (pos_ == tokens_.size()) {
+    tokenizer_->next();
+    tokens_.push_back(tokenizer_->peek());
+  }
+
+  return tokens_[pos_];
+}
+
+// The grammar pass mirrors BasicParser<FullGrammar> check for check, but
+// records unit boundaries instead of building nodes.
+
+void ParserContext::parseUnits() {
+  if (const auto token = peek(); token.kind == TokenKind::End) {
+    throw ParserError{token, "empty formula"};
+  }
+
+  while (true) {
+    if (units_.size() == limits_.max_units) {
+      throw LimitError{offsetOf(peek()), LimitKind::Units, limits_.max_units, "too many units"};
+    }
+
+    uint64_t unit_mult = 1;
+
+    if (const auto token = peek(); token.kind == TokenKind::Number) {
+      unit_mult = *token.value;
+      pos_ += 1;
+    }
+
+    if (const auto token = peek(); token.kind == TokenKind::Star || token.kind == TokenKind::End) {
+      throw ParserError{token, std::format("expected formula after multiplier ({})", unit_mult)};
+    }
+
+    const size_t begin = pos_;
+    parseFormula(TokenKind::Star);
+
+    if (pos_ == begin) {
+      throw ParserError{peek(), "empty unit between '*'"};
+    }
+
+    units_.push_back({.begin = begin, .end = pos_, .multiplier = unit_mult});
+
+    if (peek().kind == TokenKind::Star) {
+      pos_ += 1;
+      continue;
+    }
+
+    break;
+  }
+
+  if (const auto token = peek(); token.kind != TokenKind::End) {
+    throw ParserError{token, std::format("unexpected token '{}' after unit", token.text)};
+  }
+}
+
+void ParserContext::parseFormula(TokenKind closing) {
+  while (true) {
+    const auto token = peek();
+
+    // clang-format off
+    if ((closing == TokenKind::RParen || closing == TokenKind::RBracket) &&
+        (token.kind == TokenKind::RParen || token.kind == TokenKind::RBracket) &&
+        token.kind != closing) {
+      throw ParserError{
+        token,
+        std::format(
+          "unmatched '{}' - expected '{}'",
+          token.text, closing == TokenKind::RParen ? ")" : "]"
+        )
+      };
+    }
+    // clang-format on
+
+    if (token.kind == closing || token.kind == TokenKind::End) {
+      break;
+    }
+
+    parseGroup();
+  }
+}
+
+void ParserContext::parseGroup() {
+  const auto token = peek();
+
+  if (token.kind == TokenKind::Star) {
+    throw ParserError{token, "unexpected '*' inside group"};
+  }
+
+  if (token.kind == TokenKind::RParen || token.kind == TokenKind::RBracket) {
+    throw ParserError{token, std::format("unmatched '{}'", token.text)};
+  }
+
+  // Element [Number]
+  if (token.kind == TokenKind::Element) {
+    pos_ += 1;
+
+    if (peek().kind == TokenKind::Number) {
+      pos_ += 1;
+    }
+    return;
+  }
+
+  // '(' formula ')' [Number] or '[' formula ']' [Number]
+  if (token.kind == TokenKind::LParen || token.kind == TokenKind::LBracket) {
+    const bool is_paren = (token.kind == TokenKind::LParen);
+    const auto matching_closer = is_paren ? TokenKind::RParen : TokenKind::RBracket;
+    const size_t opener = pos_;
+
+    // bounds the recursion below
+    if (depth_ == limits_.max_depth) {
+      throw LimitError{offsetOf(token), LimitKind::Depth, limits_.max_depth, "groups nested too deeply"};
+    }
+
+    pos_ += 1;
+    depth_ += 1;
+    parseFormula(matching_closer);
+    depth_ -= 1;
+
+    if (peek().kind != matching_closer) {
+      throw ParserError{peek(), is_paren ? "unmatched '(' - expected ')'" : "unmatched '[' - expected ']'"};
+    }
+
+    if (pos_ == opener + 1) {
+      throw ParserError{tokens_[opener], "empty group not allowed"};
+    }
+
+    pos_ += 1;
+
+    if (peek().kind == TokenKind::Number) {
+      pos_ += 1;
+    }
+    return;
+  }
+
+  throw ParserError{token, "expected element or group"};
+}
+
+void ParserContext::checkCounts() {
+  if (limits_.max_count == std::numeric_limits<uint64_t>::max()) {
+    return;
+  }
+
+  for (const auto [id, count] : result_) {
+    if (count > limits_.max_count) {
+      throw LimitError{input_.size(), LimitKind::Count, limits_.max_count,
+                       std::format("count of {} is too large", ELEMENT_SYMBOLS[id])};
+    }
+  }
+}
+
+size_t ParserContext::offsetOf(const Token &token) const noexcept {
+  return token.kind == TokenKind::End ? input_.size() : static_cast<size_t>(token.text.data() - input_.data());
+}
+
+void ParserContext::evaluate() {
+  const Token *unknown = nullptr;
+
+  try {
+    evaluateUnits(unknown);
+  } catch (const OverflowError &) {
+    // like BasicParser, report an unknown symbol anywhere before an overflow
+    const auto it = std::ranges::find_if(tokens_, [](const Token &token) {
+      return token.kind == TokenKind::Element && element_id(token.text) == 0;
+    });
+
+    if (it == tokens_.end()) {
+      throw;
+    }
+
+    unknown = &*it;
+  }
+
+  if (unknown != nullptr) {
+    throw ParserError{*unknown, std::format("unknown element '{}'", unknown->text)};
+  }
+}
+
+void ParserContext::evaluateUnits(const Token *&unknown) {
+  for (const auto &unit : units_) {
+    multipliers_.clear();
+    multipliers_.push_back(unit.multiplier);
+
+    uint64_t count = 1;
+    const Token *count_token = nullptr;
+
+    // right to left: a multiplier is seen before the element or group it applies to
+    for (size_t idx = unit.end; idx-- > unit.begin;) {
+      const auto &token = tokens_[idx];
+      const size_t offset = offsetOf(count_token != nullptr ? *count_token : token);
+
+      switch (token.kind) {
+        case TokenKind::Number: count = *token.value;
+          count_token = &token;
+          break;
+        case TokenKind::Element:
+          if (const ElementId id = element_id(token.text); id != 0) {
+            at_offset(offset, [&] { result_.add(id, checked_mul(count, multipliers_.back())); });
+          } else {
+            unknown = &token;  // keeps the leftmost one
+          }
+          count = 1;
+          count_token = nullptr;
+          break;
+        case TokenKind::RParen: [[fallthrough]];
+        case TokenKind::RBracket:
+          multipliers_.push_back(at_offset(offset, [&] { return checked_mul(count, multipliers_.back()); }));
+          count = 1;
+          count_token = nullptr;
+          break;
+        case TokenKind::LParen: [[fallthrough]];
+        case TokenKind::LBracket: multipliers_.pop_back();
+          break;
+        default:
+          break;
+      }
+    }
+
+    if (unknown != nullptr) {
+      break;  // later units cannot hold an earlier symbol
+    }
+  }
+}
+
+}  // namespace cfp
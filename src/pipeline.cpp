@@ -0,0 +1,462 @@
+#include "cfp/pipeline.hpp"
+
+#include <algorithm>  // min
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <istream>
+#include <limits>
+#include <memory>  // unique_ptr
+#include <mutex>
+#include <optional>
+#include <stdexcept>  // invalid_argument
+#include <thread>
+#include <utility>  // exchange, move
+#include <vector>
+
+#include "cfp/parser_context.hpp"
+#include "parallel.hpp"
+
+namespace cfp {
+
+namespace {
+
+/// FIFO between two stages: push() blocks while full, pop() while empty.
+template <typename T>
+class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t capacity) : capacity_{capacity} {}
+
+  /// Blocks while full; false if the queue was cancelled.
+  bool push(T value) {
+    std::unique_lock lock{mutex_};
+    not_full_.wait(lock, [&] { return cancelled_ || items_.size() < capacity_; });
+
+    if (cancelled_) {
+      return false;
+    }
+
+    items_.push_back(std::move(value));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /// Blocks while empty; nothing once closed and drained, or cancelled.
+  std::optional<T> pop() {
+    std::unique_lock lock{mutex_};
+    not_empty_.wait(lock, [&] { return cancelled_ || closed_ || !items_.empty(); });
+
+    if (cancelled_ || items_.empty()) {
+      return std::nullopt;
+    }
+
+    T value = std::move(items_.front());
+    items_.pop_front();
+    not_full_.notify_one();
+    return value;
+  }
+
+  /// No more pushes; pop() drains what is queued.
+  void close() {
+    const std::lock_guard lock{mutex_};
+    closed_ = true;
+    not_empty_.notify_all();
+  }
+
+  /// Drop everything and wake all waiters.
+  void cancel() {
+    const std::lock_guard lock{mutex_};
+    cancelled_ = true;
+    items_.clear();
+    not_full_.notify_all();
+    not_empty_.notify_all();
+  }
+
+private:
+  size_t capacity_;
+  std::deque<T> items_;
+  bool closed_{false};
+  bool cancelled_{false};
+
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+};
+
+/**
+ * @brief Numbered values from several producers, popped in number order.
+ *
+ * push() blocks while its value is capacity or more ahead of the next one to
+ * pop, so at most capacity values wait here however late one of them is.
+ * The producer of the next value is never blocked, so this cannot deadlock.
+ */
+template <typename T>
+class ReorderBuffer {
+public:
+  explicit ReorderBuffer(size_t capacity) : slots_(capacity) {}
+
+  /// Blocks while @a sequence is too far ahead; false if the buffer was cancelled.
+  bool push(size_t sequence, T value) {
+    std::unique_lock lock{mutex_};
+    ahead_.wait(lock, [&] { return cancelled_ || sequence < next_ + slots_.size(); });
+
+    if (cancelled_) {
+      return false;
+    }
+
+    slots_[sequence % slots_.size()] = std::move(value);
+    ready_.notify_one();
+    return true;
+  }
+
+  /// The next value in order; nothing once closed and drained, or cancelled.
+  std::optional<T> pop() {
+    std::unique_lock lock{mutex_};
+    auto &slot = slots_[next_ % slots_.size()];
+    ready_.wait(lock, [&] { return cancelled_ || closed_ || slot.has_value(); });
+
+    if (cancelled_ || !slot.has_value()) {
+      return std::nullopt;
+    }
+
+    std::optional<T> value = std::exchange(slot, std::nullopt);
+    next_ += 1;
+    ahead_.notify_all();
+    return value;
+  }
+
+  /// All producers are done.
+  void close() {
+    const std::lock_guard lock{mutex_};
+    closed_ = true;
+    ready_.notify_all();
+  }
+
+  void cancel() {
+    const std::lock_guard lock{mutex_};
+    cancelled_ = true;
+    ahead_.notify_all();
+    ready_.notify_all();
+  }
+
+private:
+  std::vector<std::optional<T>> slots_;
+  size_t next_{0};
+  bool closed_{false};
+  bool cancelled_{false};
+
+  std::mutex mutex_;
+  std::condition_variable ahead_;
+  std::condition_variable ready_;
+};
+
+/// Formulas handed to one parse task.
+struct Batch {
+  size_t sequence{0};
+
+  /// Index of the first formula.
+  size_t first{0};
+
+  std::vector<std::string> formulas;
+};
+
+/**
+ * @brief The stages of one pipelined parse.
+ *
+ *   reader -> chunks -> splitter -> batches -> parse workers -> reorder -> consumer
+ *
+ * A formula source skips the splitter: its reader fills batches directly.
+ * Every stage closes its output when it ends, so the consumer sees the end
+ * once everything upstream has drained. A failing source records its
+ * exception and ends normally; any other failure cancels all queues.
+ */
+class Pipeline {
+public:
+  using ChunkSource = std::function<std::string_view()>;
+  using FormulaSource = std::function<bool(std::string &)>;
+
+  Pipeline(ChunkSource pull, FormulaSource next, const PipelineOptions &options)
+      : options_{options},
+        pull_{std::move(pull)},
+        next_{std::move(next)},
+        chunks_{options.queue_capacity},
+        batches_{options.queue_capacity},
+        parsed_{options.queue_capacity} {
+    if (!pull_ && !next_) {
+      throw std::invalid_argument{"pipeline source must not be empty"};
+    }
+
+    if (options.chunk_size == 0 || options.batch_size == 0 || options.queue_capacity == 0) {
+      throw std::invalid_argument{"pipeline chunk_size, batch_size and queue_capacity must be positive"};
+    }
+  }
+
+  Pipeline(const Pipeline &) = delete;
+  Pipeline &operator=(const Pipeline &) = delete;
+
+  ~Pipeline() {
+    cancel();
+    threads_.clear();  // join
+  }
+
+  void start() {
+    const unsigned workers = detail::resolve_threads(options_.threads, std::numeric_limits<size_t>::max());
+    active_workers_ = workers;
+
+    try {
+      if (pull_) {
+        threads_.emplace_back([this] { readChunks(); });
+        threads_.emplace_back([this] { splitLines(); });
+      } else {
+        threads_.emplace_back([this] { readFormulas(); });
+      }
+
+      for (unsigned worker = 0; worker < workers; worker++) {
+        threads_.emplace_back([this] { parse(); });
+      }
+    } catch (...) {
+      cancel();
+      throw;
+    }
+  }
+
+  /// Results of the next batch, in input order; nothing at the end.
+  std::optional<std::vector<ParsedFormula>> next() {
+    return parsed_.pop();
+  }
+
+  /// Rethrow the first stage failure, if any.
+  void rethrow() {
+    const std::lock_guard lock{error_mutex_};
+
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+private:
+  PipelineOptions options_;
+  ChunkSource pull_;
+  FormulaSource next_;
+
+  BoundedQueue<std::string> chunks_;
+  BoundedQueue<Batch> batches_;
+  ReorderBuffer<std::vector<ParsedFormula>> parsed_;
+
+  std::atomic<unsigned> active_workers_{0};
+
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+
+  // last: joined before the queues are destroyed
+  std::vector<std::jthread> threads_;
+
+  void cancel() {
+    chunks_.cancel();
+    batches_.cancel();
+    parsed_.cancel();
+  }
+
+  void fail(std::exception_ptr error) {
+    const std::lock_guard lock{error_mutex_};
+
+    if (!error_) {
+      error_ = std::move(error);
+    }
+  }
+
+  [[nodiscard]] bool failed() {
+    const std::lock_guard lock{error_mutex_};
+    return error_ != nullptr;
+  }
+
+  void readChunks() {
+    try {
+      for (auto chunk = pull_(); !chunk.empty(); chunk = pull_()) {
+        if (!chunks_.push(std::string{chunk})) {
+          return;
+        }
+      }
+    } catch (...) {
+      fail(std::current_exception());
+    }
+
+    chunks_.close();
+  }
+
+  void splitLines() {
+    // an overlong line keeps one byte beyond max_length, enough to fail its length check
+    const size_t keep = options_.limits.max_length == ParseLimits::UNLIMITED ? options_.limits.max_length
+                                                                             : options_.limits.max_length + 1;
+    Batch batch;
+    std::string line;
+    size_t sequence = 0;
+    size_t index = 0;
+
+    const auto emit = [&] {
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+
+      batch.formulas.push_back(std::move(line));
+      line.clear();
+
+      if (batch.formulas.size() < options_.batch_size) {
+        return true;
+      }
+
+      batch.sequence = sequence++;
+      batch.first = index;
+      index += batch.formulas.size();
+      return batches_.push(std::exchange(batch, Batch{}));
+    };
+
+    try {
+      while (auto chunk = chunks_.pop()) {
+        std::string_view rest{*chunk};
+
+        while (!rest.empty()) {
+          const size_t end = rest.find('\n');
+          const auto piece = rest.substr(0, end);
+          line.append(piece.substr(0, keep - std::min(keep, line.size())));
+
+          if (end == std::string_view::npos) {
+            break;
+          }
+
+          if (!emit()) {
+            return;
+          }
+
+          rest.remove_prefix(end + 1);
+        }
+      }
+
+      // a line cut off by a failing source is not a record
+      if (!line.empty() && !failed() && !emit()) {
+        return;
+      }
+
+      if (!batch.formulas.empty()) {
+        batch.sequence = sequence;
+        batch.first = index;
+
+        if (!batches_.push(std::move(batch))) {
+          return;
+        }
+      }
+    } catch (...) {
+      fail(std::current_exception());
+      cancel();
+      return;
+    }
+
+    batches_.close();
+  }
+
+  void readFormulas() {
+    Batch batch;
+    size_t sequence = 0;
+    size_t index = 0;
+
+    try {
+      std::string formula;
+
+      while (next_(formula)) {
+        batch.formulas.push_back(std::move(formula));
+        formula.clear();
+
+        if (batch.formulas.size() == options_.batch_size) {
+          batch.sequence = sequence++;
+          batch.first = index;
+          index += batch.formulas.size();
+
+          if (!batches_.push(std::exchange(batch, Batch{}))) {
+            return;
+          }
+        }
+      }
+    } catch (...) {
+      fail(std::current_exception());
+    }
+
+    if (!batch.formulas.empty()) {
+      batch.sequence = sequence;
+      batch.first = index;
+
+      if (!batches_.push(std::move(batch))) {
+        return;
+      }
+    }
+
+    batches_.close();
+  }
+
+  void parse() {
+    try {
+      ParserContext context{options_.limits};
+
+      while (auto batch = batches_.pop()) {
+        std::vector<ParsedFormula> results(batch->formulas.size());
+
+        for (size_t row = 0; row < results.size(); row++) {
+          auto &result = results[row];
+          result.index = batch->first + row;
+          result.formula = std::move(batch->formulas[row]);
+
+          try {
+            result.composition = SparseComposition{context.parse(result.formula)};
+          } catch (...) {
+            result.error = std::current_exception();
+          }
+        }
+
+        if (!parsed_.push(batch->sequence, std::move(results))) {
+          return;
+        }
+      }
+    } catch (...) {
+      fail(std::current_exception());
+      cancel();
+      return;
+    }
+
+    if (--active_workers_ == 0) {
+      parsed_.close();
+    }
+  }
+};
+
+/// The consuming stage: starts the pipeline on first resume, then yields in order.
+Generator<ParsedFormula> run(std::unique_ptr<Pipeline> pipeline) {
+  pipeline->start();
+
+  while (auto results = pipeline->next()) {
+    for (auto &result : *results) {
+      co_yield result;
+    }
+  }
+
+  pipeline->rethrow();
+}
+
+}  // namespace
+
+Generator<ParsedFormula> parse_lines(std::function<std::string_view()> pull, const PipelineOptions &options) {
+  return run(std::make_unique<Pipeline>(std::move(pull), nullptr, options));
+}
+
+Generator<ParsedFormula> parse_lines(std::istream &input, const PipelineOptions &options) {
+  return parse_lines(
+      [&input, buffer = std::vector<char>(std::max<size_t>(options.chunk_size, 1))]() mutable {
+        input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        return std::string_view{buffer.data(), static_cast<size_t>(input.gcount())};
+      },
+      options);
+}
+
+Generator<ParsedFormula> parse_each(std::function<bool(std::string &)> next, const PipelineOptions &options) {
+  return run(std::make_unique<Pipeline>(nullptr, std::move(next), options));
+}
+
+}  // namespace cfp
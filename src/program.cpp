@@ -0,0 +1,161 @@
+#include "cfp/program.hpp"
+
+#include <algorithm>  // max
+#include <format>
+#include <limits>
+#include <stdexcept>  // invalid_argument
+
+#include "cfp/checked.hpp"
+#include "cfp/parser.hpp"
+
+namespace cfp {
+
+namespace {
+
+/// MAGIC + version byte + 32-bit entry count.
+constexpr size_t HEADER_SIZE = FormulaProgram::MAGIC.size() + 1 + 4;
+
+/// One ID byte + 64-bit count.
+constexpr size_t ENTRY_SIZE = 1 + 8;
+
+void put_le(std::vector<uint8_t> &out, uint64_t value, size_t bytes) {
+  for (size_t idx = 0; idx < bytes; idx++) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * idx)));
+  }
+}
+
+uint64_t get_le(std::span<const uint8_t> bytes) noexcept {
+  uint64_t value = 0;
+
+  for (size_t idx = bytes.size(); idx-- > 0;) {
+    value = (value << 8) | bytes[idx];
+  }
+
+  return value;
+}
+
+/// Throw unless the largest count times @a scale fits 64 bits (then all do).
+void check_scale(uint64_t max_count, uint64_t scale) {
+  if (scale != 0 && max_count > std::numeric_limits<uint64_t>::max() / scale) {
+    detail::throw_count_overflow("scaled program count exceeds the count range");
+  }
+}
+
+/// Throw unless an output span of @a slots holds all @a entries.
+void check_output(size_t slots, size_t entries) {
+  if (slots < entries) {
+    throw std::invalid_argument{std::format("output has {} slots, the program needs {}", slots, entries)};
+  }
+}
+
+}  // namespace
+
+FormulaProgram::FormulaProgram(const Composition &comp) {
+  ids_.reserve(comp.size());
+  counts_.reserve(comp.size());
+
+  for (const auto [id, count] : comp) {
+    ids_.push_back(id);
+    counts_.push_back(count);
+    max_count_ = std::max(max_count_, count);
+  }
+}
+
+FormulaProgram FormulaProgram::compile(std::string_view formula) {
+  Parser parser{formula};
+  return FormulaProgram{parser.parseComposition()};
+}
+
+std::vector<uint8_t> FormulaProgram::serialize() const {
+  std::vector<uint8_t> out;
+  out.reserve(HEADER_SIZE + (size() * ENTRY_SIZE));
+
+  for (const char chr : MAGIC) {
+    out.push_back(static_cast<uint8_t>(chr));
+  }
+
+  out.push_back(FORMAT_VERSION);
+  put_le(out, size(), 4);
+
+  for (size_t idx = 0; idx < size(); idx++) {
+    out.push_back(ids_[idx]);
+    put_le(out, counts_[idx], 8);
+  }
+
+  return out;
+}
+
+FormulaProgram FormulaProgram::deserialize(std::span<const uint8_t> bytes) {
+  if (bytes.size() < HEADER_SIZE || !std::equal(MAGIC.begin(), MAGIC.end(), bytes.begin())) {
+    throw std::invalid_argument{"not a serialized formula program"};
+  }
+
+  if (const uint8_t version = bytes[MAGIC.size()]; version != FORMAT_VERSION) {
+    throw std::invalid_argument{std::format("unsupported formula program version {}", version)};
+  }
+
+  const uint64_t entries = get_le(bytes.subspan(MAGIC.size() + 1, 4));
+
+  if (bytes.size() != HEADER_SIZE + (entries * ENTRY_SIZE)) {
+    throw std::invalid_argument{
+        std::format("formula program of {} entries needs {} bytes, got {}", entries,
+                    HEADER_SIZE + (entries * ENTRY_SIZE), bytes.size())};
+  }
+
+  Composition comp;
+  ElementId previous = 0;
+
+  for (size_t idx = 0; idx < entries; idx++) {
+    const auto entry = bytes.subspan(HEADER_SIZE + (idx * ENTRY_SIZE), ENTRY_SIZE);
+    const ElementId id = entry[0];
+    const uint64_t count = get_le(entry.subspan(1));
+
+    if (id <= previous || id > ELEMENT_COUNT || count == 0) {
+      throw std::invalid_argument{std::format("invalid formula program entry {} (id {}, count {})", idx, id, count)};
+    }
+
+    comp.add(id, count);
+    previous = id;
+  }
+
+  return FormulaProgram{comp};
+}
+
+void FormulaProgram::evaluate(uint64_t scale, std::span<uint64_t> out) const {
+  check_output(out.size(), size());
+
+  // one bound check up front keeps the loop below branch-free
+  check_scale(max_count_, scale);
+
+  const uint64_t *counts = counts_.data();
+  uint64_t *dest = out.data();
+
+  for (size_t idx = 0; idx < counts_.size(); idx++) {
+    dest[idx] = counts[idx] * scale;
+  }
+}
+
+void FormulaProgram::evaluate(double scale, std::span<double> out) const {
+  check_output(out.size(), size());
+
+  const uint64_t *counts = counts_.data();
+  double *dest = out.data();
+
+  for (size_t idx = 0; idx < counts_.size(); idx++) {
+    dest[idx] = static_cast<double>(counts[idx]) * scale;
+  }
+}
+
+Composition FormulaProgram::evaluate(uint64_t scale) const {
+  check_scale(max_count_, scale);
+
+  Composition comp;
+
+  for (size_t idx = 0; idx < ids_.size(); idx++) {
+    comp.add(ids_[idx], counts_[idx] * scale);
+  }
+
+  return comp;
+}
+
+}  // namespace cfp
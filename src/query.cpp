@@ -0,0 +1,183 @@
+#include "cfp/query.hpp"
+
+#include <array>
+#include <cstddef>  // size_t
+#include <format>
+#include <stdexcept>  // invalid_argument
+
+#include "cfp/checked.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/tokenizer.hpp"
+
+namespace cfp {
+
+namespace {
+
+/**
+ * @brief Recursive-descent walk that keeps a single running count.
+ *
+ * Each call level holds the subtotal of one open group; the recursion is the
+ * multiplier stack, so memory is proportional to nesting depth only.
+ */
+class CountQuery {
+public:
+  CountQuery(std::string_view formula, ElementId id) :
+      input_{formula}, tokenizer_{formula}, symbol_{element_symbol(id)} {}
+
+  uint64_t run() {
+    uint64_t total = 0;
+
+    while (true) {
+      uint64_t unit_mult = 1;
+      const size_t unit_offset = offsetOf(tokenizer_.peek());
+
+      if (const auto &token = tokenizer_.peek(); token.kind == TokenKind::Number) {
+        unit_mult = *token.value;
+        tokenizer_.next();
+      }
+
+      if (const auto &token = tokenizer_.peek(); token.kind == TokenKind::Star || token.kind == TokenKind::End) {
+        throw ParserError{token, std::format("expected formula after multiplier ({})", unit_mult)};
+      }
+
+      const uint64_t unit = formula(TokenKind::Star);
+      total = at_offset(unit_offset, [&] { return checked_add(total, checked_mul(unit, unit_mult)); });
+
+      if (const auto &token = tokenizer_.peek(); token.kind == TokenKind::Star) {
+        tokenizer_.next();
+        continue;
+      }
+
+      break;
+    }
+
+    if (const auto &token = tokenizer_.peek(); token.kind != TokenKind::End) {
+      throw ParserError{token, std::format("unexpected token '{}' after unit", token.text)};
+    }
+
+    return total;
+  }
+
+private:
+  std::string_view input_;
+  Tokenizer tokenizer_;
+  std::string_view symbol_;
+
+  /// Elements read so far; unchanged across an empty group.
+  size_t terms_{0};
+
+  [[nodiscard]] size_t offsetOf(const Token &token) const noexcept {
+    return token.kind == TokenKind::End ? input_.size() : static_cast<size_t>(token.text.data() - input_.data());
+  }
+
+  /// Optional count or group multiplier; @a offset is moved to it if present.
+  uint64_t multiplier(size_t &offset) {
+    if (const auto &token = tokenizer_.peek(); token.kind == TokenKind::Number) {
+      const uint64_t value = *token.value;
+      offset = offsetOf(token);
+      tokenizer_.next();
+      return value;
+    }
+    return 1;
+  }
+
+  uint64_t formula(TokenKind closing) {
+    uint64_t sum = 0;
+
+    while (true) {
+      const auto token = tokenizer_.peek();
+
+      if (token.kind == closing || token.kind == TokenKind::End) {
+        return sum;
+      }
+
+      switch (token.kind) {
+        case TokenKind::Element: {
+          tokenizer_.next();
+          terms_ += 1;
+          size_t offset = offsetOf(token);
+          const uint64_t count = multiplier(offset);
+          sum = at_offset(offset, [&] { return checked_add(sum, token.text == symbol_ ? count : 0); });
+          break;
+        }
+        case TokenKind::LParen: [[fallthrough]];
+        case TokenKind::LBracket: {
+          const auto closer = token.kind == TokenKind::LParen ? TokenKind::RParen : TokenKind::RBracket;
+          tokenizer_.next();
+
+          const size_t terms_before = terms_;
+          const uint64_t inner = formula(closer);
+
+          if (tokenizer_.peek().kind != closer) {
+            throw ParserError{tokenizer_.peek(),
+                              closer == TokenKind::RParen ? "unmatched '(' - expected ')'"
+                                                          : "unmatched '[' - expected ']'"};
+          }
+
+          if (terms_ == terms_before) {
+            throw ParserError{token, "empty group not allowed"};
+          }
+
+          tokenizer_.next();
+          size_t offset = offsetOf(token);
+          const uint64_t mult = multiplier(offset);
+          sum = at_offset(offset, [&] { return checked_add(sum, checked_mul(inner, mult)); });
+          break;
+        }
+        case TokenKind::Star: throw ParserError{token, "unexpected '*' inside group"};
+        case TokenKind::RParen: [[fallthrough]];
+        case TokenKind::RBracket: throw ParserError{token, std::format("unmatched '{}'", token.text)};
+        default: throw ParserError{token, "expected element or group"};
+      }
+    }
+  }
+};
+
+}  // namespace
+
+uint64_t count_of(std::string_view formula, ElementId id) {
+  return CountQuery{formula, id}.run();
+}
+
+uint64_t count_of(std::string_view formula, std::string_view symbol) {
+  const ElementId id = element_id(symbol);
+
+  if (id == 0) {
+    throw std::invalid_argument{std::format("unknown element '{}'", symbol)};
+  }
+
+  return count_of(formula, id);
+}
+
+bool contains_any(std::string_view formula, std::span<const ElementId> ids) {
+  // presence bitmask of the requested elements
+  std::array<uint64_t, 2> wanted{};
+
+  for (const ElementId id : ids) {
+    if (id != 0 && id <= ELEMENT_COUNT) {
+      wanted[id / 64] |= uint64_t{1} << (id % 64);
+    }
+  }
+
+  if ((wanted[0] | wanted[1]) == 0) {
+    return false;
+  }
+
+  for (Tokenizer tokenizer{formula}; tokenizer.peek().kind != TokenKind::End; tokenizer.next()) {
+    if (const auto &token = tokenizer.peek(); token.kind == TokenKind::Element) {
+      const ElementId id = element_id(token.text);
+
+      if (((wanted[id / 64] >> (id % 64)) & 1U) != 0) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+bool contains_any(std::string_view formula, std::initializer_list<ElementId> ids) {
+  return contains_any(formula, std::span{ids.begin(), ids.size()});
+}
+
+}  // namespace cfp
@@ -0,0 +1,21 @@
+#include "cfp/recovery.hpp"
+
+#include <algorithm>  // stable_sort
+#include <cstddef>  // ptrdiff_t
+
+#include "cfp/parser.hpp"
+
+namespace cfp {
+
+Composition parse_recovering(std::string_view input, DiagnosticSink &sink, const ParseLimits &limits) {
+  const size_t first = sink.size();
+  auto comp = RecoveringParser{input, sink, limits}.parseComposition();
+
+  // lookahead and implicitly closed groups are reported late; restore input order
+  std::stable_sort(sink.begin() + static_cast<std::ptrdiff_t>(first), sink.end(),
+                   [](const Diagnostic &lhs, const Diagnostic &rhs) { return lhs.offset < rhs.offset; });
+
+  return comp;
+}
+
+}  // namespace cfp
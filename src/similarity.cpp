@@ -0,0 +1,532 @@
+#include "cfp/similarity.hpp"
+
+#include <algorithm>  // clamp, find, max, min, sort, stable_sort
+#include <cmath>  // abs, ldexp, sqrt
+#include <exception>  // exception_ptr
+#include <limits>
+#include <numeric>  // iota
+#include <queue>  // priority_queue
+#include <stdexcept>  // invalid_argument, out_of_range
+
+#include "cfp/isotope.hpp"
+#include "cfp/parser_context.hpp"
+#include "parallel.hpp"
+
+namespace cfp {
+
+namespace {
+
+/// Kernel lanes: stored vectors are padded to a multiple of this many columns.
+constexpr size_t LANES = 16;
+
+/// Relative slack on bounds, covering the rounding of the single-precision kernels.
+constexpr double BOUND_SLACK = 1e-4;
+
+using Mask = std::array<uint64_t, Composition::MASK_WORDS>;
+
+// The kernels keep LANES independent partial sums, so the inner loop carries
+// no dependency and is vectorized without reassociating floating-point math.
+
+float dot(const float *query, const uint16_t *values, size_t width) noexcept {
+  std::array<float, LANES> acc{};
+
+  for (size_t col = 0; col < width; col += LANES) {
+    for (size_t lane = 0; lane < LANES; lane++) {
+      acc[lane] += query[col + lane] * static_cast<float>(values[col + lane]);
+    }
+  }
+
+  float sum = 0.0F;
+
+  for (const float part : acc) {
+    sum += part;
+  }
+
+  return sum;
+}
+
+/// Weighted L1 distance to a stored vector whose counts are values * scale.
+float weighted_l1(const float *query, const float *weights, const uint16_t *values, float scale,
+                  size_t width) noexcept {
+  std::array<float, LANES> acc{};
+
+  for (size_t col = 0; col < width; col += LANES) {
+    for (size_t lane = 0; lane < LANES; lane++) {
+      acc[lane] +=
+          weights[col + lane] * std::abs(query[col + lane] - (scale * static_cast<float>(values[col + lane])));
+    }
+  }
+
+  float sum = 0.0F;
+
+  for (const float part : acc) {
+    sum += part;
+  }
+
+  return sum;
+}
+
+bool higher_is_better(SimilarityMetric metric) noexcept {
+  return metric != SimilarityMetric::MassDistance;
+}
+
+/// Tanimoto from a dot product and squared norms (0 for two empty vectors).
+double tanimoto(double dot, double lhs_sq, double rhs_sq) noexcept {
+  const double denom = lhs_sq + rhs_sq - dot;
+  return denom > 0.0 ? dot / denom : 0.0;
+}
+
+/// Cosine from a dot product and norms (0 if either vector is empty).
+double cosine(double dot, double lhs_norm, double rhs_norm) noexcept {
+  const double denom = lhs_norm * rhs_norm;
+  return denom > 0.0 ? dot / denom : 0.0;
+}
+
+/**
+ * Best Tanimoto for a record norm in [min_norm, max_norm], given a.b <= shared * |b|.
+ * The bound s r / (q^2 + r^2 - s r) peaks at r = q whatever s is.
+ */
+double tanimoto_bound(double shared, double norm, double min_norm, double max_norm) noexcept {
+  const double best = std::clamp(norm, min_norm, max_norm);
+  return tanimoto(shared * best, norm * norm, best * best);
+}
+
+}  // namespace
+
+double similarity(const Composition &lhs, const Composition &rhs, SimilarityMetric metric) noexcept {
+  double dot = 0.0;
+  double lhs_sq = 0.0;
+  double rhs_sq = 0.0;
+  double distance = 0.0;
+
+  for (size_t id = 1; id < Composition::CAPACITY; id++) {
+    const auto left = static_cast<double>(lhs[static_cast<ElementId>(id)]);
+    const auto right = static_cast<double>(rhs[static_cast<ElementId>(id)]);
+
+    dot += left * right;
+    lhs_sq += left * left;
+    rhs_sq += right * right;
+
+    if (left != right) {
+      distance += average_mass(static_cast<ElementId>(id)) * std::abs(left - right);
+    }
+  }
+
+  switch (metric) {
+    case SimilarityMetric::Tanimoto: return tanimoto(dot, lhs_sq, rhs_sq);
+    case SimilarityMetric::Cosine: return (lhs_sq > 0.0 && rhs_sq > 0.0) ? dot / std::sqrt(lhs_sq * rhs_sq) : 0.0;
+    case SimilarityMetric::MassDistance: [[fallthrough]];
+    default: return distance;
+  }
+}
+
+/// A query in the index's units: counts / 2^shift over the index columns.
+struct SimilarityIndex::Query {
+  SimilarityMetric metric{SimilarityMetric::Tanimoto};
+
+  std::vector<float> values;
+  std::vector<float> weights;
+  Mask mask{};
+
+  /// Query elements with a column and their squared values.
+  std::vector<std::pair<ElementId, double>> squares;
+
+  double norm{0.0};
+
+  /// Mass over the columns, and of elements that no record has.
+  double mass{0.0};
+  double outside_mass{0.0};
+
+  /// Norm of the query over the elements in @a present.
+  [[nodiscard]] double sharedNorm(const Mask &present) const noexcept;
+};
+
+/// The k best neighbors seen by one worker.
+class SimilarityIndex::TopK {
+public:
+  TopK(size_t k, SimilarityMetric metric) : k_{k}, higher_{higher_is_better(metric)}, heap_{Worse{higher_}} {}
+
+  /// Whether a result bounded by @a bound could still enter.
+  [[nodiscard]] bool admits(double bound) const noexcept {
+    if (higher_ && bound <= 0.0) {
+      return false;
+    }
+
+    if (heap_.size() < k_) {
+      return true;
+    }
+
+    const double worst = heap_.top().score;
+    return higher_ ? bound >= worst * (1.0 - BOUND_SLACK) : bound <= worst * (1.0 + BOUND_SLACK);
+  }
+
+  void push(const Neighbor &candidate) {
+    if ((higher_ && candidate.score <= 0.0) || k_ == 0) {
+      return;
+    }
+
+    if (heap_.size() < k_) {
+      heap_.push(candidate);
+    } else if (Worse{higher_}(candidate, heap_.top())) {
+      heap_.pop();
+      heap_.push(candidate);
+    }
+  }
+
+  /// Move all results out, best first.
+  [[nodiscard]] std::vector<Neighbor> take() {
+    std::vector<Neighbor> out;
+    out.reserve(heap_.size());
+
+    while (!heap_.empty()) {
+      out.push_back(heap_.top());
+      heap_.pop();
+    }
+
+    std::reverse(out.begin(), out.end());
+    return out;
+  }
+
+  /// Strict weak order: true if @a lhs ranks before @a rhs (better score, then lower record).
+  struct Worse {
+    bool higher;
+
+    bool operator()(const Neighbor &lhs, const Neighbor &rhs) const noexcept {
+      if (lhs.score != rhs.score) {
+        return higher ? lhs.score > rhs.score : lhs.score < rhs.score;
+      }
+      return lhs.record < rhs.record;
+    }
+  };
+
+private:
+  size_t k_;
+  bool higher_;
+
+  // the comparator ranks better first, so the top is the worst kept result
+  std::priority_queue<Neighbor, std::vector<Neighbor>, Worse> heap_;
+};
+
+SimilarityIndex::SimilarityIndex(std::span<const Composition> compositions) {
+  std::vector<SparseComposition> sparse;
+  sparse.reserve(compositions.size());
+
+  for (const auto &comp : compositions) {
+    sparse.emplace_back(comp);
+  }
+
+  *this = fromSparse(sparse);
+}
+
+SimilarityIndex SimilarityIndex::build(std::span<const std::string_view> formulas, unsigned threads) {
+  const size_t blocks = (formulas.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  const unsigned workers = detail::resolve_threads(threads, blocks);
+
+  std::vector<SparseComposition> sparse(formulas.size());
+  std::vector<std::exception_ptr> errors(blocks);
+  std::vector<ParserContext> contexts(workers);
+
+  detail::parallel_for(blocks, workers, [&](size_t block, unsigned worker) {
+    const size_t end = std::min(formulas.size(), (block + 1) * BLOCK_SIZE);
+
+    for (size_t row = block * BLOCK_SIZE; row < end; row++) {
+      try {
+        sparse[row] = SparseComposition{contexts[worker].parse(formulas[row])};
+      } catch (...) {
+        errors[block] = std::current_exception();  // rows run in order: the block's first failure
+        return;
+      }
+    }
+  });
+
+  for (const auto &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  return fromSparse(sparse);
+}
+
+SimilarityIndex SimilarityIndex::fromSparse(std::span<const SparseComposition> compositions) {
+  if (compositions.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument{"cannot index 2^32 or more compositions"};
+  }
+
+  SimilarityIndex index;
+
+  // columns: elements present anywhere; shifts: fit each record's largest count in 16 bits
+  const size_t records = compositions.size();
+  Mask present{};
+  std::vector<uint8_t> shifts(records, 0);
+
+  for (size_t row = 0; row < records; row++) {
+    uint64_t max_count = 0;
+
+    for (const auto &[id, count] : compositions[row]) {
+      present[id / 64] |= uint64_t{1} << (id % 64);
+      max_count = std::max(max_count, count);
+    }
+
+    while ((max_count >> shifts[row]) > std::numeric_limits<uint16_t>::max()) {
+      shifts[row] += 1;
+    }
+  }
+
+  index.column_of_.fill(-1);
+
+  for (size_t id = 1; id < Composition::CAPACITY; id++) {
+    if (((present[id / 64] >> (id % 64)) & 1U) != 0) {
+      index.column_of_[id] = static_cast<int16_t>(index.columns_.size());
+      index.columns_.push_back(static_cast<ElementId>(id));
+    }
+  }
+
+  index.width_ = (index.columns_.size() + LANES - 1) / LANES * LANES;
+
+  // round to nearest, saturating
+  const auto quantize = [](uint64_t count, unsigned shift) {
+    const uint64_t scaled = shift == 0 ? count : (count >> shift) + ((count >> (shift - 1)) & 1U);
+    return static_cast<uint16_t>(std::min<uint64_t>(scaled, std::numeric_limits<uint16_t>::max()));
+  };
+
+  // norms and masses of the stored vectors, scaled back to counts
+  std::vector<float> norms(records);
+  std::vector<double> masses(records);
+
+  for (size_t row = 0; row < records; row++) {
+    double square = 0.0;
+    double mass = 0.0;
+
+    for (const auto &[id, count] : compositions[row]) {
+      const double value = std::ldexp(static_cast<double>(quantize(count, shifts[row])), shifts[row]);
+      square += value * value;
+      mass += average_mass(id) * value;
+    }
+
+    norms[row] = static_cast<float>(std::sqrt(square));
+    masses[row] = mass;
+  }
+
+  // norm order makes blocks narrow norm ranges, which the Tanimoto block bound uses
+  std::vector<uint32_t> order(records);
+  std::iota(order.begin(), order.end(), uint32_t{0});
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) { return norms[lhs] < norms[rhs]; });
+
+  index.values_.assign(records * index.width_, 0);
+  index.masks_.resize(records);
+  index.norms_.resize(records);
+  index.masses_.resize(records);
+  index.shifts_.resize(records);
+  index.records_ = std::move(order);
+
+  for (size_t slot = 0; slot < records; slot++) {
+    const uint32_t row = index.records_[slot];
+    uint16_t *values = index.values_.data() + (slot * index.width_);
+
+    for (const auto &[id, count] : compositions[row]) {
+      values[static_cast<size_t>(index.column_of_[id])] = quantize(count, shifts[row]);
+      index.masks_[slot][id / 64] |= uint64_t{1} << (id % 64);
+    }
+
+    index.norms_[slot] = norms[row];
+    index.masses_[slot] = masses[row];
+    index.shifts_[slot] = shifts[row];
+  }
+
+  const size_t blocks = (records + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  index.block_masks_.assign(blocks, Mask{});
+  index.block_min_norm_.assign(blocks, std::numeric_limits<float>::max());
+  index.block_max_norm_.assign(blocks, 0.0F);
+  index.block_min_mass_.assign(blocks, std::numeric_limits<double>::max());
+  index.block_max_mass_.assign(blocks, 0.0);
+
+  for (size_t slot = 0; slot < records; slot++) {
+    const size_t block = slot / BLOCK_SIZE;
+
+    for (size_t word = 0; word < Composition::MASK_WORDS; word++) {
+      index.block_masks_[block][word] |= index.masks_[slot][word];
+    }
+
+    index.block_min_norm_[block] = std::min(index.block_min_norm_[block], index.norms_[slot]);
+    index.block_max_norm_[block] = std::max(index.block_max_norm_[block], index.norms_[slot]);
+    index.block_min_mass_[block] = std::min(index.block_min_mass_[block], index.masses_[slot]);
+    index.block_max_mass_[block] = std::max(index.block_max_mass_[block], index.masses_[slot]);
+  }
+
+  return index;
+}
+
+unsigned SimilarityIndex::shift(size_t record) const {
+  const auto found = std::find(records_.begin(), records_.end(), record);
+
+  if (found == records_.end()) {
+    throw std::out_of_range{"record beyond the index size"};
+  }
+
+  return shifts_[static_cast<size_t>(found - records_.begin())];
+}
+
+SimilarityIndex::Query SimilarityIndex::prepare(const Composition &query, SimilarityMetric metric) const {
+  Query prepared;
+  prepared.metric = metric;
+  prepared.values.assign(width_, 0.0F);
+  prepared.weights.assign(width_, 0.0F);
+
+  for (size_t col = 0; col < columns_.size(); col++) {
+    prepared.weights[col] = static_cast<float>(average_mass(columns_[col]));
+  }
+
+  double square = 0.0;
+
+  for (const auto [id, count] : query) {
+    const auto value = static_cast<double>(count);
+    square += value * value;
+
+    if (const int16_t col = column_of_[id]; col >= 0) {
+      prepared.values[static_cast<size_t>(col)] = static_cast<float>(value);
+      prepared.mask[id / 64] |= uint64_t{1} << (id % 64);
+      prepared.squares.emplace_back(id, value * value);
+      prepared.mass += average_mass(id) * value;
+    } else {
+      prepared.outside_mass += average_mass(id) * value;
+    }
+  }
+
+  prepared.norm = std::sqrt(square);
+  return prepared;
+}
+
+double SimilarityIndex::Query::sharedNorm(const Mask &present) const noexcept {
+  if (((present[0] & mask[0]) | (present[1] & mask[1])) == 0) {
+    return 0.0;
+  }
+
+  double shared_sq = 0.0;
+
+  for (const auto &[id, square] : squares) {
+    shared_sq += static_cast<double>((present[id / 64] >> (id % 64)) & 1U) * square;
+  }
+
+  return std::sqrt(shared_sq);
+}
+
+void SimilarityIndex::scanBlock(const Query &query, size_t block, TopK &top) const {
+  const size_t end = std::min(records_.size(), (block + 1) * BLOCK_SIZE);
+  const double query_sq = query.norm * query.norm;
+
+  for (size_t slot = block * BLOCK_SIZE; slot < end; slot++) {
+    const double norm = norms_[slot];
+    const int shift = shifts_[slot];
+    const uint16_t *values = values_.data() + (slot * width_);
+
+    if (query.metric == SimilarityMetric::MassDistance) {
+      if (!top.admits(std::abs(query.mass - masses_[slot]) + query.outside_mass)) {
+        continue;
+      }
+
+      const float scale = std::ldexp(1.0F, shift);
+      const double distance = weighted_l1(query.values.data(), query.weights.data(), values, scale, width_);
+      top.push({.record = records_[slot], .score = distance + query.outside_mass});
+      continue;
+    }
+
+    // a.b is at most the query norm over the shared elements times the record norm
+    const double shared = query.sharedNorm(masks_[slot]);
+    const double bound = query.metric == SimilarityMetric::Cosine ? shared / query.norm
+                                                                   : tanimoto(shared * norm, query_sq, norm * norm);
+
+    if (!top.admits(bound)) {
+      continue;
+    }
+
+    const double product = std::ldexp(static_cast<double>(dot(query.values.data(), values, width_)), shift);
+    const double score = query.metric == SimilarityMetric::Cosine ? cosine(product, query.norm, norm)
+                                                                  : tanimoto(product, query_sq, norm * norm);
+
+    top.push({.record = records_[slot], .score = score});
+  }
+}
+
+std::vector<Neighbor> SimilarityIndex::search(const Composition &query, size_t k, SimilarityMetric metric,
+                                              unsigned threads) const {
+  if (k == 0 || records_.empty() || query.empty()) {
+    return {};
+  }
+
+  const Query prepared = prepare(query, metric);
+  const size_t blocks = block_masks_.size();
+
+  // block bounds: skip hopeless blocks, scan the most promising first
+  std::vector<std::pair<double, size_t>> order;
+  order.reserve(blocks);
+
+  for (size_t block = 0; block < blocks; block++) {
+    if (metric == SimilarityMetric::MassDistance) {
+      const double gap =
+          std::max({0.0, block_min_mass_[block] - prepared.mass, prepared.mass - block_max_mass_[block]});
+      order.emplace_back(-(gap + prepared.outside_mass), block);
+      continue;
+    }
+
+    // blocks sharing no element with the query cannot score above 0
+    const double shared = prepared.sharedNorm(block_masks_[block]);
+
+    if (shared > 0.0) {
+      order.emplace_back(metric == SimilarityMetric::Cosine
+                             ? shared / prepared.norm
+                             : tanimoto_bound(shared, prepared.norm, block_min_norm_[block], block_max_norm_[block]),
+                         block);
+    }
+  }
+
+  std::stable_sort(order.begin(), order.end(), [](const auto &lhs, const auto &rhs) { return lhs.first > rhs.first; });
+
+  const unsigned workers = detail::resolve_threads(threads, order.size());
+  std::vector<TopK> tops(workers, TopK{k, metric});
+
+  detail::parallel_for(order.size(), workers, [&](size_t task, unsigned worker) {
+    const auto [bound, block] = order[task];
+    auto &top = tops[worker];
+
+    if (top.admits(metric == SimilarityMetric::MassDistance ? -bound : bound)) {
+      scanBlock(prepared, block, top);
+    }
+  });
+
+  // merge the per-worker heaps
+  std::vector<Neighbor> merged;
+
+  for (auto &top : tops) {
+    const auto part = top.take();
+    merged.insert(merged.end(), part.begin(), part.end());
+  }
+
+  std::sort(merged.begin(), merged.end(), TopK::Worse{higher_is_better(metric)});
+
+  if (merged.size() > k) {
+    merged.resize(k);
+  }
+
+  return merged;
+}
+
+std::vector<Neighbor> SimilarityIndex::search(std::string_view formula, size_t k, SimilarityMetric metric,
+                                              unsigned threads) const {
+  ParserContext context;
+  return search(context.parse(formula), k, metric, threads);
+}
+
+std::vector<std::vector<Neighbor>> SimilarityIndex::searchBatch(std::span<const Composition> queries, size_t k,
+                                                                SimilarityMetric metric, unsigned threads) const {
+  std::vector<std::vector<Neighbor>> results(queries.size());
+
+  detail::parallel_for(queries.size(), detail::resolve_threads(threads, queries.size()),
+                       [&](size_t query, unsigned /*worker*/) {
+                         results[query] = search(queries[query], k, metric, 1);
+                       });
+
+  return results;
+}
+
+}  // namespace cfp
@@ -0,0 +1,298 @@
+#include "cfp/stream_parser.hpp"
+
+#include <algorithm>  // max
+#include <cctype>  // std::isspace, std::isupper, std::islower, std::isdigit
+#include <format>
+#include <istream>
+#include <utility>  // exchange
+
+#include "cfp/checked.hpp"
+#include "cfp/error/overflow_error.hpp"
+
+namespace cfp {
+
+StreamParser::StreamParser() {
+  frames_.emplace_back();
+}
+
+void StreamParser::feed(std::string_view chunk) {
+  for (const char chr : chunk) {
+    const auto uchr = static_cast<unsigned char>(chr);
+
+    // continue a token split across chunks
+    if (lexing_ == Lexing::Element) {
+      if (std::islower(uchr)) {
+        if (symbol_length_ < SYMBOL_CAPACITY) {
+          symbol_[symbol_length_] = chr;
+        }
+        symbol_length_ += 1;
+        offset_ += 1;
+        continue;
+      }
+      finishToken();
+    } else if (lexing_ == Lexing::Number) {
+      if (std::isdigit(uchr)) {
+        number_overflow_ |= __builtin_mul_overflow(number_, uint64_t{10}, &number_);
+        number_overflow_ |= __builtin_add_overflow(number_, static_cast<uint64_t>(chr - '0'), &number_);
+        offset_ += 1;
+        continue;
+      }
+      finishToken();
+    }
+
+    dispatch(chr);
+    offset_ += 1;
+  }
+}
+
+Composition StreamParser::finish() {
+  finishToken();
+  resolvePending(1, pending_offset_);
+
+  if (offset_ == 0) {
+    fail(0, DiagnosticKind::EmptyUnit, "empty formula");
+  }
+
+  if (depth_ > 0) {
+    const auto &group = frames_[depth_];
+    fail(group.offset, DiagnosticKind::UnclosedGroup,
+         group.closer == ')' ? "unmatched '(' - expected ')'" : "unmatched '[' - expected ']'");
+  }
+
+  endUnit(offset_);
+
+  Composition result = total_;
+  reset();
+
+  return result;
+}
+
+void StreamParser::reset() noexcept {
+  offset_ = 0;
+  lexing_ = Lexing::None;
+  symbol_length_ = 0;
+  number_ = 0;
+
+  depth_ = 0;
+  frames_[0].comp.clear();
+  frames_[0].filled = false;
+  total_.clear();
+  unit_mult_ = 1;
+  unit_mult_seen_ = false;
+  pending_ = Pending::None;
+}
+
+void StreamParser::dispatch(char chr) {
+  const auto uchr = static_cast<unsigned char>(chr);
+
+  if (std::isspace(uchr)) {
+    fail(offset_, DiagnosticKind::Whitespace, "whitespace not allowed");
+  }
+
+  if (std::isupper(uchr)) {
+    lexing_ = Lexing::Element;
+    token_start_ = offset_;
+    symbol_[0] = chr;
+    symbol_length_ = 1;
+    return;
+  }
+
+  if (std::isdigit(uchr)) {
+    lexing_ = Lexing::Number;
+    token_start_ = offset_;
+    number_ = static_cast<uint64_t>(chr - '0');
+    number_overflow_ = false;
+    number_leading_zero_ = (chr == '0');
+    return;
+  }
+
+  // clang-format off
+  switch (chr) {
+    case '(': onOpen(')');
+      return;
+    case '[': onOpen(']');
+      return;
+    case ')': [[fallthrough]];
+    case ']': onClose(chr);
+      return;
+    case '*': onStar();
+      return;
+    default:
+      fail(offset_, DiagnosticKind::UnexpectedCharacter, std::format("unexpected character '{}'", chr));
+  }
+  // clang-format on
+}
+
+void StreamParser::finishToken() {
+  const auto lexed = lexing_;
+  lexing_ = Lexing::None;
+
+  if (lexed == Lexing::Element) {
+    onElement();
+  } else if (lexed == Lexing::Number) {
+    onNumber();
+  }
+}
+
+void StreamParser::onElement() {
+  resolvePending(1, pending_offset_);
+
+  const std::string_view symbol{symbol_.data(), std::min(symbol_length_, SYMBOL_CAPACITY)};
+  const ElementId id = symbol_length_ <= SYMBOL_CAPACITY ? element_id(symbol) : 0;
+
+  if (id == 0) {
+    fail(token_start_, DiagnosticKind::UnknownElement,
+         std::format("unknown element '{}{}'", symbol, symbol_length_ > SYMBOL_CAPACITY ? "..." : ""));
+  }
+
+  pending_ = Pending::Element;
+  pending_element_ = id;
+  pending_offset_ = token_start_;
+  frames_[depth_].filled = true;
+}
+
+void StreamParser::onNumber() {
+  if (number_overflow_) {
+    fail(token_start_, DiagnosticKind::CountOverflow, "invalid number (exceeds 64 bits)");
+  }
+
+  if (number_ == 0) {
+    fail(token_start_, DiagnosticKind::InvalidNumber, "invalid number (non-positive integer)");
+  }
+
+  if (number_leading_zero_) {
+    fail(token_start_, DiagnosticKind::InvalidNumber, "invalid number (leading zero)");
+  }
+
+  if (pending_ != Pending::None) {
+    resolvePending(number_, token_start_);
+    return;
+  }
+
+  // prefix multiplier of a unit: "5H2O"
+  if (depth_ == 0 && !frames_[0].filled && !unit_mult_seen_) {
+    unit_mult_ = number_;
+    unit_mult_seen_ = true;
+    return;
+  }
+
+  fail(token_start_, DiagnosticKind::UnexpectedToken, "expected element or group");
+}
+
+void StreamParser::onOpen(char closer) {
+  resolvePending(1, pending_offset_);
+
+  depth_ += 1;
+
+  if (frames_.size() <= depth_) {
+    frames_.emplace_back();
+  }
+
+  auto &frame = frames_[depth_];
+  frame.comp.clear();
+  frame.offset = offset_;
+  frame.closer = closer;
+  frame.filled = false;
+}
+
+void StreamParser::onClose(char closer) {
+  resolvePending(1, pending_offset_);
+
+  if (depth_ == 0) {
+    fail(offset_, DiagnosticKind::UnmatchedCloser, std::format("unmatched '{}'", closer));
+  }
+
+  const auto &group = frames_[depth_];
+
+  if (group.closer != closer) {
+    fail(offset_, DiagnosticKind::UnmatchedCloser, std::format("unmatched '{}' - expected '{}'", closer, group.closer));
+  }
+
+  if (!group.filled) {
+    fail(group.offset, DiagnosticKind::EmptyGroup, "empty group not allowed");
+  }
+
+  // the closed group stays in frames_[depth_ + 1] until its multiplier is known
+  depth_ -= 1;
+  pending_ = Pending::Group;
+  pending_offset_ = group.offset;
+  frames_[depth_].filled = true;
+}
+
+void StreamParser::onStar() {
+  resolvePending(1, pending_offset_);
+
+  if (depth_ > 0) {
+    fail(offset_, DiagnosticKind::UnexpectedToken, "unexpected '*' inside group");
+  }
+
+  endUnit(offset_);
+}
+
+void StreamParser::endUnit(size_t offset) {
+  auto &unit = frames_[0];
+
+  if (!unit.filled) {
+    if (unit_mult_seen_) {
+      fail(offset, DiagnosticKind::EmptyUnit, std::format("expected formula after multiplier ({})", unit_mult_));
+    }
+    fail(offset, DiagnosticKind::EmptyUnit, "empty unit between '*'");
+  }
+
+  try {
+    for (const auto &[id, count] : unit.comp) {
+      total_.add(id, checked_mul(count, unit_mult_));
+    }
+  } catch (const OverflowError &) {
+    fail(offset, DiagnosticKind::CountOverflow, "count overflow");
+  }
+
+  unit.comp.clear();
+  unit.filled = false;
+  unit_mult_ = 1;
+  unit_mult_seen_ = false;
+}
+
+void StreamParser::resolvePending(uint64_t mult, size_t offset) {
+  auto &target = frames_[depth_].comp;
+  const auto pending = std::exchange(pending_, Pending::None);
+
+  try {
+    if (pending == Pending::Element) {
+      target.add(pending_element_, mult);
+    } else if (pending == Pending::Group) {
+      for (const auto &[id, count] : frames_[depth_ + 1].comp) {
+        target.add(id, checked_mul(count, mult));
+      }
+    }
+  } catch (const OverflowError &) {
+    fail(offset, DiagnosticKind::CountOverflow, "count overflow");
+  }
+}
+
+void StreamParser::fail(size_t offset, DiagnosticKind kind, std::string_view message) {
+  throw StreamError{offset, kind, message};
+}
+
+Composition parse_stream(const std::function<std::string_view()> &pull) {
+  StreamParser parser;
+
+  for (auto chunk = pull(); !chunk.empty(); chunk = pull()) {
+    parser.feed(chunk);
+  }
+
+  return parser.finish();
+}
+
+Composition parse_stream(std::istream &input, size_t chunk_size) {
+  StreamParser parser;
+  std::vector<char> buffer(std::max<size_t>(chunk_size, 1));
+
+  while (input.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || input.gcount() > 0) {
+    parser.feed({buffer.data(), static_cast<size_t>(input.gcount())});
+  }
+
+  return parser.finish();
+}
+
+}  // namespace cfp
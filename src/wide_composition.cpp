@@ -0,0 +1,60 @@
+#include "cfp/wide_composition.hpp"
+
+#include <algorithm>  // reverse
+#include <limits>
+
+namespace cfp {
+
+std::vector<WideComposition::Entry> WideComposition::entries() const {
+  std::vector<Entry> result;
+
+  for (size_t idx = 0; idx < CAPACITY; idx++) {
+    if (contains(static_cast<ElementId>(idx))) {
+      result.emplace_back(static_cast<ElementId>(idx), counts_[idx]);
+    }
+  }
+
+  return result;
+}
+
+bool WideComposition::fitsNarrow() const noexcept {
+  bool fits = true;
+
+  for (size_t idx = 0; idx < CAPACITY; idx++) {
+    fits &= counts_[idx] <= std::numeric_limits<Composition::count_type>::max();
+  }
+
+  return fits;
+}
+
+Composition WideComposition::narrow() const {
+  if (!fitsNarrow()) {
+    detail::throw_count_overflow("element count exceeds 64 bits");
+  }
+
+  Composition result;
+
+  for (const auto &[id, count] : entries()) {
+    result.add(id, static_cast<Composition::count_type>(count));
+  }
+
+  return result;
+}
+
+std::string to_string(wide_count value) {
+  if (value == 0) {
+    return "0";
+  }
+
+  std::string digits;
+
+  while (value != 0) {
+    digits.push_back(static_cast<char>('0' + static_cast<int>(value % 10)));
+    value /= 10;
+  }
+
+  std::reverse(digits.begin(), digits.end());
+  return digits;
+}
+
+}  // namespace cfp
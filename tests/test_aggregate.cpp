@@ -0,0 +1,103 @@
+// tests/test_aggregate.cpp
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "cfp/aggregate.hpp"
+#include "cfp/error/overflow_error.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/error/tokenizer_error.hpp"
+#include "cfp/parser.hpp"
+
+namespace {
+
+const std::vector<std::string_view> SAMPLES{"H2O", "Fe2(SO4)3", "K4[Fe(CN)6]*3H2O", "C6H12O6", "NaCl", "CuSO4*5H2O"};
+
+/// Rows cycling through SAMPLES, spanning several parallel blocks.
+std::vector<std::string_view> dataset(size_t rows) {
+  std::vector<std::string_view> formulas;
+  formulas.reserve(rows);
+
+  for (size_t row = 0; row < rows; row++) {
+    formulas.push_back(SAMPLES[row % SAMPLES.size()]);
+  }
+
+  return formulas;
+}
+
+/// Serial reference: parse each row and sum.
+cfp::Composition reference(const std::vector<std::string_view> &formulas, const std::vector<uint64_t> &weights) {
+  cfp::Composition total;
+
+  for (size_t row = 0; row < formulas.size(); row++) {
+    total += cfp::Parser{formulas[row]}.parseComposition() * weights[row];
+  }
+
+  return total;
+}
+
+}  // namespace
+
+TEST(AggregateTest, SumsUnweightedRows) {
+  const std::vector<std::string_view> formulas{"H2O", "H2O2"};
+  const auto total = cfp::aggregate(formulas);
+
+  EXPECT_EQ(total.count("H"), 4u);
+  EXPECT_EQ(total.count("O"), 3u);
+  EXPECT_TRUE(cfp::aggregate(std::span<const std::string_view>{}).empty());
+}
+
+TEST(AggregateTest, MatchesSerialReferenceForAnyThreadCount) {
+  const auto formulas = dataset(10'007);
+
+  std::vector<uint64_t> weights(formulas.size());
+  for (size_t row = 0; row < weights.size(); row++) {
+    weights[row] = (row % 7) + 1;
+  }
+
+  const auto expected = reference(formulas, weights);
+
+  for (const unsigned threads : {1U, 2U, 3U, 8U}) {
+    EXPECT_EQ(cfp::aggregate(formulas, weights, threads), expected) << threads;
+  }
+}
+
+TEST(AggregateTest, RealWeights) {
+  const auto formulas = dataset(6'000);
+  const std::vector<double> weights(formulas.size(), 0.5);
+
+  const auto totals = cfp::aggregate(formulas, weights, 4);
+  const auto counts = cfp::aggregate(formulas, 1);
+
+  for (cfp::ElementId id = 1; id <= cfp::ELEMENT_COUNT; id++) {
+    EXPECT_DOUBLE_EQ(totals[id], static_cast<double>(counts[id]) * 0.5) << cfp::element_symbol(id);
+  }
+
+  EXPECT_DOUBLE_EQ(totals.count("Fe"), 1'000.0 * 1.5);
+  EXPECT_EQ(totals.count("Xx"), 0.0);
+}
+
+TEST(AggregateTest, ReportsLowestFailingRow) {
+  auto formulas = dataset(5'000);
+  formulas[4'500] = "H2O(";
+  formulas[3'000] = "H2 O";
+
+  for (const unsigned threads : {1U, 4U}) {
+    EXPECT_THROW(cfp::aggregate(formulas, threads), cfp::TokenizerError) << threads;
+  }
+
+  EXPECT_THROW(cfp::aggregate(formulas, std::vector<uint64_t>(3)), std::invalid_argument);
+  EXPECT_THROW(cfp::aggregate(formulas, std::vector<double>(3)), std::invalid_argument);
+}
+
+TEST(AggregateTest, DetectsTotalOverflow) {
+  const std::vector<std::string_view> formulas(3, "C");
+  const std::vector<uint64_t> weights(3, std::numeric_limits<uint64_t>::max() / 2);
+
+  EXPECT_THROW(cfp::aggregate(formulas, weights, 3), cfp::OverflowError);
+}
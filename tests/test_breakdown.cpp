@@ -0,0 +1,119 @@
+// tests/test_breakdown.cpp
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+
+#include "cfp/breakdown.hpp"
+#include "cfp/error/limit_error.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/grammar.hpp"
+#include "cfp/parser.hpp"
+
+namespace {
+
+struct NoLigandGrammar : cfp::FullGrammar {
+  static constexpr bool LIGANDS = false;
+};
+
+cfp::Breakdown breakdown(std::string_view input, bool groups = false) {
+  cfp::Parser parser{input};
+  return parser.parseBreakdown(groups);
+}
+
+cfp::SparseComposition sparse(std::string_view input) {
+  cfp::Parser parser{input};
+  return cfp::SparseComposition{parser.parseComposition()};
+}
+
+}  // namespace
+
+TEST(BreakdownTest, SplitsHydrateIntoUnits) {
+  constexpr std::string_view INPUT = "CuSO4*5H2O";
+  const auto result = breakdown(INPUT);
+
+  EXPECT_EQ(result.total, cfp::Parser{INPUT}.parseComposition());
+  ASSERT_EQ(result.units.size(), 2u);
+  EXPECT_TRUE(result.groups.empty());
+
+  EXPECT_EQ(result.units[0].text(INPUT), "CuSO4");
+  EXPECT_EQ(result.units[0].multiplier, 1u);
+  EXPECT_EQ(result.units[0].counts, sparse("CuSO4"));
+
+  EXPECT_EQ(result.units[1].text(INPUT), "5H2O");
+  EXPECT_EQ(result.units[1].unit, 1u);
+  EXPECT_EQ(result.units[1].multiplier, 5u);
+  EXPECT_EQ(result.units[1].counts, sparse("H10O5"));
+}
+
+TEST(BreakdownTest, RecordsTopLevelGroupsOnRequest) {
+  constexpr std::string_view INPUT = "K4[Fe(CN)6]*3H2O(OH)2";
+  const auto result = breakdown(INPUT, /*groups=*/true);
+
+  ASSERT_EQ(result.groups.size(), 2u);
+
+  // nested groups are part of their top-level group
+  EXPECT_EQ(result.groups[0].text(INPUT), "[Fe(CN)6]");
+  EXPECT_EQ(result.groups[0].unit, 0u);
+  EXPECT_EQ(result.groups[0].multiplier, 1u);
+  EXPECT_EQ(result.groups[0].counts, sparse("FeC6N6"));
+
+  // a group's counts include its unit's multiplier
+  EXPECT_EQ(result.groups[1].text(INPUT), "(OH)2");
+  EXPECT_EQ(result.groups[1].unit, 1u);
+  EXPECT_EQ(result.groups[1].multiplier, 2u);
+  EXPECT_EQ(result.groups[1].counts, sparse("O6H6"));
+
+  EXPECT_EQ(result.units[1].text(INPUT), "3H2O(OH)2");
+  EXPECT_EQ(result.units[1].counts, sparse("H12O9"));
+}
+
+TEST(BreakdownTest, SubtotalsSumToTotal) {
+  for (const std::string_view input : {"H2O", "Fe2(SO4)3", "Al2(SO4)3*18H2O", "2Fe(NO3)3*(NH4)2SO4*H2O"}) {
+    const auto result = breakdown(input, /*groups=*/true);
+    cfp::SparseComposition units;
+
+    for (const auto &unit : result.units) {
+      units += unit.counts;
+    }
+
+    EXPECT_EQ(units.toDense(), result.total) << input;
+  }
+}
+
+TEST(BreakdownTest, UnitOfSingleUnitGrammar) {
+  constexpr std::string_view INPUT = "Fe2(SO4)3";
+  cfp::BasicParser<NoLigandGrammar> parser{INPUT};
+  const auto result = parser.parseBreakdown(/*groups=*/true);
+
+  ASSERT_EQ(result.units.size(), 1u);
+  EXPECT_EQ(result.units[0].text(INPUT), "Fe2(SO4)3");
+  ASSERT_EQ(result.groups.size(), 1u);
+  EXPECT_EQ(result.groups[0].text(INPUT), "(SO4)3");
+}
+
+TEST(BreakdownTest, OutlivesInput) {
+  cfp::Breakdown result;
+  std::string copy;
+
+  {
+    const std::string input = "Al2(SO4)3*18H2O";
+    result = breakdown(input, /*groups=*/true);
+    copy = input;
+  }
+
+  ASSERT_EQ(result.units.size(), 2u);
+  EXPECT_EQ(result.units[1].offset, 10u);
+  EXPECT_EQ(result.units[1].text(copy), "18H2O");
+  ASSERT_EQ(result.groups.size(), 1u);
+  EXPECT_EQ(result.groups[0].text(copy), "(SO4)3");
+}
+
+TEST(BreakdownTest, AppliesParserChecksAndLimits) {
+  EXPECT_THROW((void)breakdown("CuSO4*5Xx2O"), cfp::ParserError);
+  EXPECT_THROW((void)breakdown("CuSO4*"), cfp::ParserError);
+
+  cfp::Parser parser{"CuSO4*5000000H2O", {.max_count = 1'000'000}};
+  EXPECT_THROW((void)parser.parseBreakdown(), cfp::LimitError);
+}
@@ -0,0 +1,83 @@
+/* tests/test_c_api.c: the C API compiled as C and linked against the shared cfp_c library. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cfp/cfp.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+              #cond);                                                  \
+      failures += 1;                                                   \
+    }                                                                  \
+  } while (0)
+
+static void parses_batch(void) {
+  const char *formulas[] = {"H2O", "Fe2(SO4)3", "H2 O", "(((H)))"};
+  const size_t count = sizeof formulas / sizeof formulas[0];
+
+  uint8_t ids[16];
+  uint64_t counts[16];
+  size_t offsets[5];
+  int32_t statuses[4];
+  size_t error_offsets[4];
+  size_t required = 0;
+
+  cfp_limits limits;
+  memset(&limits, 0, sizeof limits);
+  limits.max_depth = 2;
+
+  const int32_t status = cfp_parse_batch(formulas, NULL, count, &limits, ids, counts, 16, offsets, statuses,
+                                         error_offsets, 2, &required);
+
+  CHECK(status == CFP_OK);
+  CHECK(required == 5);
+
+  CHECK(statuses[0] == CFP_OK);
+  CHECK(offsets[0] == 0 && offsets[1] == 2);
+  CHECK(ids[0] == 1 && counts[0] == 2); /* H2 */
+  CHECK(ids[1] == 8 && counts[1] == 1); /* O */
+
+  CHECK(statuses[1] == CFP_OK);
+  CHECK(offsets[2] == 5);
+  CHECK(ids[4] == 26 && counts[4] == 2); /* Fe2, last by atomic number */
+
+  CHECK(statuses[2] == CFP_ERROR_TOKENIZER);
+  CHECK(error_offsets[2] == 2);
+
+  CHECK(statuses[3] == CFP_ERROR_LIMIT);
+  CHECK(offsets[3] == offsets[4]);
+
+  CHECK(strcmp(cfp_status_string(CFP_ERROR_LIMIT), "limit exceeded") == 0);
+}
+
+static void reports_capacity(void) {
+  const char *formulas[] = {"NaCl"};
+  size_t offsets[2];
+  int32_t statuses[1];
+  size_t required = 0;
+
+  CHECK(cfp_parse_batch(formulas, NULL, 1, NULL, NULL, NULL, 0, offsets, statuses, NULL, 1, &required) ==
+        CFP_ERROR_CAPACITY);
+  CHECK(required == 2);
+  CHECK(cfp_parse_batch(NULL, NULL, 1, NULL, NULL, NULL, 0, offsets, statuses, NULL, 1, NULL) ==
+        CFP_ERROR_INVALID_ARGUMENT);
+}
+
+int main(void) {
+  parses_batch();
+  reports_capacity();
+
+  if (failures != 0) {
+    fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+
+  return 0;
+}
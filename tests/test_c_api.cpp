@@ -0,0 +1,192 @@
+// tests/test_c_api.cpp
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cfp/cfp.h"
+#include "cfp/parser.hpp"
+#include "cfp/parser_context.hpp"
+
+namespace {
+
+/// Output buffers of one cfp_parse_batch() call.
+struct Batch {
+  std::vector<uint8_t> ids;
+  std::vector<uint64_t> counts;
+  std::vector<size_t> offsets;
+  std::vector<int32_t> statuses;
+  std::vector<size_t> error_offsets;
+  size_t required{0};
+  int32_t status{CFP_OK};
+
+  Batch(const std::vector<const char *> &formulas, size_t capacity, unsigned threads,
+        const cfp_limits *limits = nullptr) :
+      ids(capacity), counts(capacity), offsets(formulas.size() + 1), statuses(formulas.size()),
+      error_offsets(formulas.size()) {
+    status = cfp_parse_batch(formulas.data(), nullptr, formulas.size(), limits, ids.data(), counts.data(), capacity,
+                             offsets.data(), statuses.data(), error_offsets.data(), threads, &required);
+  }
+
+  /// Formula @a idx rendered back as a composition.
+  [[nodiscard]] cfp::Composition composition(size_t idx) const {
+    cfp::Composition comp;
+    for (size_t slot = offsets[idx]; slot < offsets[idx + 1]; slot++) {
+      comp.add(ids[slot], counts[slot]);
+    }
+    return comp;
+  }
+};
+
+}  // namespace
+
+TEST(CApiTest, ParsesOneFormula) {
+  std::vector<uint8_t> ids(8);
+  std::vector<uint64_t> counts(8);
+  size_t written = 0;
+
+  constexpr std::string_view FORMULA = "Fe2(SO4)3 trailing bytes are ignored";
+  ASSERT_EQ(cfp_parse(FORMULA.data(), 9, nullptr, ids.data(), counts.data(), ids.size(), &written, nullptr), CFP_OK);
+
+  ASSERT_EQ(written, 3u);
+  EXPECT_EQ(ids[0], 8);  // ascending atomic number: O, S, Fe
+  EXPECT_EQ(counts[0], 12u);
+  EXPECT_EQ(ids[1], 16);
+  EXPECT_EQ(counts[1], 3u);
+  EXPECT_EQ(ids[2], 26);
+  EXPECT_EQ(counts[2], 2u);
+}
+
+TEST(CApiTest, ReportsErrorsAsStatusCodes) {
+  uint64_t count = 0;
+  uint8_t id = 0;
+  size_t written = 0;
+  size_t offset = 0;
+
+  EXPECT_EQ(cfp_parse("H2 O", 4, nullptr, &id, &count, 1, &written, &offset), CFP_ERROR_TOKENIZER);
+  EXPECT_EQ(offset, 2u);
+  EXPECT_EQ(cfp_parse("H2(O", 4, nullptr, &id, &count, 1, &written, &offset), CFP_ERROR_PARSER);
+  EXPECT_EQ(offset, 4u);
+  EXPECT_EQ(cfp_parse("H2Xx", 4, nullptr, &id, &count, 1, &written, &offset), CFP_ERROR_PARSER);
+  EXPECT_EQ(offset, 2u);
+  EXPECT_EQ(cfp_parse("(C4294967296)4294967296", 23, nullptr, &id, &count, 1, &written, &offset), CFP_ERROR_OVERFLOW);
+  EXPECT_EQ(offset, 2u);
+  EXPECT_EQ(cfp_parse("", 0, nullptr, &id, &count, 1, &written, nullptr), CFP_ERROR_TOKENIZER);
+
+  EXPECT_EQ(cfp_parse("H2O", 3, nullptr, &id, &count, 1, &written, nullptr), CFP_ERROR_CAPACITY);
+  EXPECT_EQ(written, 2u);
+
+  EXPECT_EQ(cfp_parse("H2O", 3, nullptr, nullptr, nullptr, 1, &written, nullptr), CFP_ERROR_INVALID_ARGUMENT);
+  EXPECT_EQ(cfp_parse(nullptr, 3, nullptr, &id, &count, 1, &written, nullptr), CFP_ERROR_INVALID_ARGUMENT);
+
+  EXPECT_STREQ(cfp_status_string(CFP_ERROR_PARSER), "parser error");
+  EXPECT_STREQ(cfp_status_string(42), "unknown status");
+}
+
+TEST(CApiTest, LeavesThreadContextAlone) {
+  const auto &water = cfp::ParserContext::forThread().parse("H2O");
+
+  uint8_t id = 0;
+  uint64_t count = 0;
+  size_t written = 0;
+  ASSERT_EQ(cfp_parse("Na", 2, nullptr, &id, &count, 1, &written, nullptr), CFP_OK);
+
+  EXPECT_EQ(water.count("H"), 2u);
+  EXPECT_EQ(water.count("Na"), 0u);
+}
+
+TEST(CApiTest, AppliesLimits) {
+  uint8_t id = 0;
+  uint64_t count = 0;
+  size_t written = 0;
+  size_t offset = 0;
+
+  cfp_limits limits{};
+  limits.max_depth = 2;
+
+  EXPECT_EQ(cfp_parse("(((H)))", 7, &limits, &id, &count, 1, &written, &offset), CFP_ERROR_LIMIT);
+  EXPECT_EQ(offset, 2u);
+  EXPECT_EQ(cfp_parse("((H))", 5, &limits, &id, &count, 1, &written, &offset), CFP_OK);
+
+  // limits belong to the call: the next call on this thread has none
+  EXPECT_EQ(cfp_parse("(((H)))", 7, nullptr, &id, &count, 1, &written, nullptr), CFP_OK);
+
+  // batches apply them on every worker
+  const Batch batch{{"H2O", "(((H)))", "((H))"}, 8, 2, &limits};
+  ASSERT_EQ(batch.status, CFP_OK);
+  EXPECT_EQ(batch.statuses, (std::vector<int32_t>{CFP_OK, CFP_ERROR_LIMIT, CFP_OK}));
+  EXPECT_EQ(batch.error_offsets[1], 2u);
+
+  const Batch unlimited{{"(((H)))"}, 8, 2};
+  EXPECT_EQ(unlimited.statuses, (std::vector<int32_t>{CFP_OK}));
+
+  const cfp_limits zero{};
+  EXPECT_EQ(cfp_parse("(((H)))", 7, &zero, &id, &count, 1, &written, nullptr), CFP_OK);
+  EXPECT_STREQ(cfp_status_string(CFP_ERROR_LIMIT), "limit exceeded");
+}
+
+TEST(CApiTest, BatchMatchesParser) {
+  const std::vector<const char *> samples{"H2O", "Fe2(SO4)3", "bad", "K4[Fe(CN)6]*3H2O", nullptr, "C6H12O6"};
+
+  std::vector<const char *> formulas;
+  for (int rep = 0; rep < 200; rep++) {
+    formulas.insert(formulas.end(), samples.begin(), samples.end());
+  }
+
+  for (const unsigned threads : {1U, 4U}) {
+    const Batch batch{formulas, formulas.size() * cfp::ELEMENT_COUNT, threads};
+    ASSERT_EQ(batch.status, CFP_OK);
+    EXPECT_EQ(batch.required, batch.offsets.back());
+
+    for (size_t idx = 0; idx < formulas.size(); idx++) {
+      if (formulas[idx] == nullptr || std::string_view{formulas[idx]} == "bad") {
+        EXPECT_NE(batch.statuses[idx], CFP_OK);
+        EXPECT_EQ(batch.offsets[idx], batch.offsets[idx + 1]);
+        continue;
+      }
+
+      ASSERT_EQ(batch.statuses[idx], CFP_OK) << formulas[idx];
+      EXPECT_EQ(batch.composition(idx), cfp::Parser{formulas[idx]}.parseComposition()) << formulas[idx];
+    }
+  }
+}
+
+TEST(CApiTest, BatchReportsRequiredCapacity) {
+  const std::vector<const char *> formulas{"H2O", "NaCl", "C"};
+
+  const Batch small{formulas, 2, 2};
+  EXPECT_EQ(small.status, CFP_ERROR_CAPACITY);
+  EXPECT_EQ(small.required, 5u);
+  EXPECT_EQ(small.offsets, (std::vector<size_t>{0, 2, 4, 5}));
+
+  const Batch exact{formulas, small.required, 2};
+  EXPECT_EQ(exact.status, CFP_OK);
+  EXPECT_EQ(exact.composition(1).count("Na"), 1u);
+}
+
+TEST(CApiTest, BatchHandlesLengthsAndEmptyInput) {
+  const std::vector<const char *> formulas{"H2O2", "NaClO"};
+  const std::vector<size_t> lengths{3, 4};
+
+  std::vector<uint8_t> ids(8);
+  std::vector<uint64_t> counts(8);
+  std::vector<size_t> offsets(3);
+  std::vector<int32_t> statuses(2);
+
+  ASSERT_EQ(cfp_parse_batch(formulas.data(), lengths.data(), 2, nullptr, ids.data(), counts.data(), 8, offsets.data(),
+                            statuses.data(), nullptr, 0, nullptr),
+            CFP_OK);
+  EXPECT_EQ(offsets, (std::vector<size_t>{0, 2, 4}));
+  EXPECT_EQ(counts[1], 1u);  // "H2O"
+
+  size_t none = 1;
+  EXPECT_EQ(cfp_parse_batch(nullptr, nullptr, 0, nullptr, nullptr, nullptr, 0, &none, nullptr, nullptr, 0, nullptr),
+            CFP_OK);
+  EXPECT_EQ(none, 0u);
+  EXPECT_EQ(cfp_parse_batch(nullptr, nullptr, 1, nullptr, nullptr, nullptr, 0, offsets.data(), statuses.data(),
+                            nullptr, 0, nullptr),
+            CFP_ERROR_INVALID_ARGUMENT);
+}
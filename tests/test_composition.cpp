@@ -0,0 +1,139 @@
+// tests/test_composition.cpp
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/parser.hpp"
+
+using ExpectedMap = std::unordered_map<std::string, uint64_t>;
+
+static cfp::Composition compose(std::string_view formula) {
+  cfp::Parser parser{formula};
+  return parser.parseComposition();
+}
+
+// Parser produces the same counts as the map-based evaluation
+class CompositionParseTest : public ::testing::TestWithParam<std::string_view> {};
+
+TEST_P(CompositionParseTest, MatchesMapEvaluation) {
+  const auto &input = GetParam();
+
+  cfp::Parser parser{input};
+  const ExpectedMap expected = parser.parse();
+
+  EXPECT_EQ(compose(input).toDict(), expected);
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+  Formulas,
+  CompositionParseTest,
+  ::testing::Values(
+    "H", "HOH", "C12H22O11", "Fe2(SO4)3", "K[Fe(NO3)2]4", "CuSO4*5H2O", "2H2O*3NH3", "Og2"
+  )
+);
+// clang-format on
+
+TEST(CompositionTest, ParseRejectsUnknownElements) {
+  EXPECT_THROW(compose("H2Xx"), cfp::ParserError);
+}
+
+TEST(CompositionTest, DefaultIsEmpty) {
+  const cfp::Composition comp;
+
+  EXPECT_TRUE(comp.empty());
+  EXPECT_EQ(comp.size(), 0U);
+  EXPECT_EQ(comp.total(), 0U);
+  EXPECT_EQ(comp.begin(), comp.end());
+}
+
+TEST(CompositionTest, AddRejectsIdsBeyondCapacity) {
+  cfp::Composition comp;
+
+  EXPECT_THROW(comp.add(200, 1), std::out_of_range);
+  EXPECT_THROW(comp.add(cfp::Composition::CAPACITY, 1), std::out_of_range);
+  EXPECT_TRUE(comp.empty());
+
+  comp.add(cfp::Composition::CAPACITY - 1, 1);
+  EXPECT_EQ(comp[cfp::Composition::CAPACITY - 1], 1U);
+}
+
+TEST(CompositionTest, IteratesInElementOrder) {
+  const auto comp = compose("OgO2HFe3");
+
+  std::vector<cfp::Composition::Entry> entries(comp.begin(), comp.end());
+  const std::vector<cfp::Composition::Entry> expected{{1, 1}, {8, 2}, {26, 3}, {118, 1}};
+
+  EXPECT_EQ(entries, expected);
+  EXPECT_EQ(comp.size(), 4U);
+  EXPECT_EQ(comp.total(), 7U);
+  EXPECT_TRUE(comp.contains(118));
+  EXPECT_FALSE(comp.contains(6));
+  EXPECT_EQ(comp.count("Fe"), 3U);
+  EXPECT_EQ(comp.count("Xx"), 0U);
+}
+
+TEST(CompositionTest, Arithmetic) {
+  const auto salt = compose("CuSO4");
+  const auto water = compose("H2O");
+  const auto hydrate = compose("CuSO4*5H2O");
+
+  EXPECT_EQ(salt + water * 5, hydrate);
+  EXPECT_EQ(hydrate - salt, water * 5);
+  EXPECT_EQ(hydrate - hydrate, cfp::Composition{});
+  EXPECT_TRUE((water * 0).empty());
+  EXPECT_THROW(salt - water, std::underflow_error);
+}
+
+TEST(CompositionTest, SubsetAndEquality) {
+  const auto water = compose("H2O");
+
+  EXPECT_TRUE(water.isSubsetOf(compose("CuSO4*5H2O")));
+  EXPECT_TRUE(water.isSubsetOf(water));
+  EXPECT_FALSE(water.isSubsetOf(compose("HO")));
+  EXPECT_FALSE(water.isSubsetOf(compose("H2S")));
+  EXPECT_TRUE(cfp::Composition{}.isSubsetOf(water));
+
+  EXPECT_EQ(compose("HOH"), water);
+  EXPECT_NE(compose("H2O2"), water);
+}
+
+TEST(CompositionTest, EmpiricalFormula) {
+  EXPECT_EQ(compose("C6H12O6").gcd(), 6U);
+  EXPECT_EQ(compose("C6H12O6").empirical(), compose("CH2O"));
+  EXPECT_EQ(compose("H2O").empirical(), compose("H2O"));
+  EXPECT_EQ(cfp::Composition{}.gcd(), 0U);
+}
+
+TEST(SparseCompositionTest, RoundTripsDense) {
+  const auto dense = compose("K[Fe(CN)6]");
+  const cfp::SparseComposition sparse{dense};
+
+  EXPECT_EQ(sparse.size(), 4U);
+  EXPECT_EQ(sparse.toDense(), dense);
+  EXPECT_EQ(sparse[6], 6U);
+  EXPECT_EQ(sparse[8], 0U);
+}
+
+TEST(SparseCompositionTest, ExpandsExtremeEntries) {
+  cfp::Composition dense;
+  dense.add(1, std::numeric_limits<cfp::Composition::count_type>::max());
+  dense.add(cfp::Composition::CAPACITY - 1, 1);
+
+  EXPECT_EQ(cfp::SparseComposition{dense}.toDense(), dense);
+  EXPECT_EQ(cfp::SparseComposition{}.toDense(), cfp::Composition{});
+}
+
+TEST(SparseCompositionTest, MergesSums) {
+  cfp::SparseComposition lhs{compose("CuSO4")};
+  lhs += cfp::SparseComposition{compose("H10O5")};
+
+  EXPECT_EQ(lhs, cfp::SparseComposition{compose("CuSO4*5H2O")});
+}
@@ -0,0 +1,158 @@
+// tests/test_equation.cpp
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cfp/equation.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/error/tokenizer_error.hpp"
+#include "cfp/parser.hpp"
+
+namespace {
+
+std::string balanced(std::string_view input) {
+  auto equation = cfp::parse_equation(input);
+  cfp::balance(equation);
+  return cfp::to_string(equation);
+}
+
+}  // namespace
+
+// Parsing
+TEST(EquationParserTest, ParsesSpeciesAndCoefficients) {
+  const auto equation = cfp::parse_equation("Fe2O3 + 3CO -> 2Fe + 3CO2");
+
+  ASSERT_EQ(equation.reactants.size(), 2u);
+  ASSERT_EQ(equation.products.size(), 2u);
+
+  EXPECT_EQ(equation.reactants[0].formula, "Fe2O3");
+  EXPECT_EQ(equation.reactants[0].coefficient, 1u);
+  EXPECT_EQ(equation.reactants[0].composition.count("O"), 3u);
+  EXPECT_EQ(equation.reactants[1].formula, "CO");
+  EXPECT_EQ(equation.reactants[1].coefficient, 3u);
+  EXPECT_EQ(equation.products[0].formula, "Fe");
+  EXPECT_EQ(equation.products[0].coefficient, 2u);
+  EXPECT_EQ(equation.products[1].composition.count("O"), 2u);
+
+  EXPECT_TRUE(cfp::is_balanced(equation));
+}
+
+TEST(EquationParserTest, AcceptsEqualsAndNoSpaces) {
+  const auto equation = cfp::parse_equation("2H2+O2=2H2O");
+
+  EXPECT_EQ(cfp::to_string(equation), "2H2 + O2 -> 2H2O");
+  EXPECT_TRUE(cfp::is_balanced(equation));
+}
+
+TEST(EquationParserTest, SpeciesUseTheFullGrammar) {
+  const auto equation = cfp::parse_equation("  2K4[Fe(CN)6] + CuSO4*5H2O ->  Fe  ");
+
+  EXPECT_EQ(equation.reactants[0].formula, "K4[Fe(CN)6]");
+  EXPECT_EQ(equation.reactants[0].coefficient, 2u);
+  EXPECT_EQ(equation.reactants[1].formula, "CuSO4*5H2O");
+  EXPECT_EQ(equation.reactants[1].composition.count("H"), 10u);
+  EXPECT_EQ(equation.products[0].formula, "Fe");
+
+  // formula-level parsing is unchanged: a leading number is a unit multiplier there
+  cfp::EquationParser parser{"2H2O"};
+  EXPECT_EQ(parser.parseComposition().count("H"), 4u);
+}
+
+TEST(EquationParserTest, RejectsMalformedEquations) {
+  for (const auto input : {"H2 + O2", "-> H2O", "H2 + -> H2O", "H2 -> H2O +", "H2 -> H2O -> O", "2 -> H2", "H2 ->"}) {
+    EXPECT_THROW(cfp::parse_equation(input), cfp::ParserError) << input;
+  }
+
+  EXPECT_THROW(cfp::parse_equation("H2 -> Xx2"), cfp::ParserError);
+  EXPECT_THROW(cfp::parse_equation("(H2 + O2) -> H2O"), cfp::ParserError);
+}
+
+TEST(EquationParserTest, WhitespaceOnlyAroundOperators) {
+  EXPECT_THROW(cfp::parse_equation("H2 O -> H2O"), cfp::TokenizerError);
+  EXPECT_THROW(cfp::parse_equation("2 H2 -> H2"), cfp::TokenizerError);
+  EXPECT_THROW(cfp::parse_equation("H2 - > H2"), cfp::TokenizerError);
+
+  // the formula grammar still rejects all of them
+  EXPECT_THROW(cfp::Parser{"H2 + O2"}.parse(), cfp::TokenizerError);
+  EXPECT_THROW(cfp::Parser{"H2+O2"}.parse(), cfp::TokenizerError);
+}
+
+// Balancing
+class BalanceTest : public ::testing::TestWithParam<std::pair<std::string_view, std::string_view>> {};
+
+TEST_P(BalanceTest, FindsSmallestCoefficients) {
+  const auto [input, expected] = GetParam();
+  EXPECT_EQ(balanced(input), expected);
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+  Reactions,
+  BalanceTest,
+  ::testing::Values(
+    std::pair{"H2 + O2 -> H2O", "2H2 + O2 -> 2H2O"},
+    std::pair{"Fe2O3 + CO -> Fe + CO2", "Fe2O3 + 3CO -> 2Fe + 3CO2"},
+    std::pair{"C3H8 + O2 -> CO2 + H2O", "C3H8 + 5O2 -> 3CO2 + 4H2O"},
+    std::pair{"KMnO4 + HCl -> KCl + MnCl2 + H2O + Cl2", "2KMnO4 + 16HCl -> 2KCl + 2MnCl2 + 8H2O + 5Cl2"},
+    std::pair{"Ca3(PO4)2 + SiO2 + C -> CaSiO3 + P4 + CO", "2Ca3(PO4)2 + 6SiO2 + 10C -> 6CaSiO3 + P4 + 10CO"},
+    std::pair{"K4[Fe(CN)6] + H2SO4 + H2O -> K2SO4 + FeSO4 + (NH4)2SO4 + CO",
+              "K4[Fe(CN)6] + 6H2SO4 + 6H2O -> 2K2SO4 + FeSO4 + 3(NH4)2SO4 + 6CO"},
+    std::pair{"CuSO4*5H2O -> CuSO4 + H2O", "CuSO4*5H2O -> CuSO4 + 5H2O"},
+    std::pair{"5H2 + 9O2 = H2O", "2H2 + O2 -> 2H2O"}
+  )
+);
+// clang-format on
+
+TEST(BalancerTest, RejectsUnbalanceableReactions) {
+  for (const auto input : {
+           "H2 -> O2",                    // no solution
+           "H2O -> H2O2",                 // only the zero solution
+           "H2 + O2 -> H2O + H2O2",       // two independent balancings
+           "NaCl + H2O -> NaCl + H2O",    // identical sides: not unique
+           "H2 + O2 + N2 -> H2O",         // N2 would need a zero coefficient
+       }) {
+    auto equation = cfp::parse_equation(input);
+    EXPECT_THROW(cfp::balance(equation), std::invalid_argument) << input;
+  }
+}
+
+TEST(BalancerTest, ReusesScratchAcrossSizes) {
+  cfp::Balancer balancer;
+
+  for (const auto input : {"KMnO4 + HCl -> KCl + MnCl2 + H2O + Cl2", "H2 + O2 -> H2O", "N2 + H2 -> NH3"}) {
+    auto equation = cfp::parse_equation(input);
+    balancer.balance(equation);
+
+    EXPECT_TRUE(cfp::is_balanced(equation)) << input;
+  }
+}
+
+// Batch mode
+TEST(BalanceBatchTest, MatchesSequentialAndKeepsErrors) {
+  std::vector<std::string_view> reactions;
+
+  for (int rep = 0; rep < 50; rep++) {
+    reactions.insert(reactions.end(), {"C3H8 + O2 -> CO2 + H2O", "H2 -> O2", "H2 + -> H2O", "Al + O2 -> Al2O3"});
+  }
+
+  const auto results = cfp::balance_batch(reactions, 4);
+  ASSERT_EQ(results.size(), reactions.size());
+
+  for (size_t idx = 0; idx < reactions.size(); idx++) {
+    switch (idx % 4) {
+      case 0: EXPECT_EQ(cfp::to_string(results[idx].equation), "C3H8 + 5O2 -> 3CO2 + 4H2O");
+        break;
+      case 3: EXPECT_EQ(cfp::to_string(results[idx].equation), "4Al + 3O2 -> 2Al2O3");
+        break;
+      default: EXPECT_FALSE(results[idx].ok()) << reactions[idx];
+        break;
+    }
+  }
+
+  EXPECT_NE(results[2].error.find("expected species"), std::string::npos);
+  EXPECT_TRUE(cfp::balance_batch({}, 0).empty());
+}
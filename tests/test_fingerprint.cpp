@@ -0,0 +1,168 @@
+// tests/test_fingerprint.cpp
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cfp/error/limit_error.hpp"
+#include "cfp/error/overflow_error.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/fingerprint.hpp"
+#include "cfp/limits.hpp"
+#include "cfp/parser.hpp"
+
+namespace {
+
+/// Copies of @a motif in @a formula according to group_fingerprints().
+uint64_t copies(std::string_view formula, std::string_view motif) {
+  const auto fingerprint = cfp::group_fingerprint(motif);
+
+  for (const auto &group : cfp::group_fingerprints(formula)) {
+    if (group.fingerprint == fingerprint) {
+      return group.count;
+    }
+  }
+
+  return 0;
+}
+
+}  // namespace
+
+TEST(FingerprintTest, IgnoresMultiplierBracketsAndOrder) {
+  const auto sulfate = cfp::group_fingerprint("SO4");
+
+  EXPECT_EQ(cfp::group_fingerprint("(SO4)"), sulfate);
+  EXPECT_EQ(cfp::group_fingerprint("(SO4)3"), sulfate);
+  EXPECT_EQ(cfp::group_fingerprint("[O4S]"), sulfate);
+  EXPECT_EQ(cfp::group_fingerprint("SO2O2"), sulfate);
+
+  EXPECT_NE(cfp::group_fingerprint("SO3"), sulfate);
+  EXPECT_NE(cfp::group_fingerprint("S(O)4"), sulfate);
+  EXPECT_NE(cfp::group_fingerprint("NO3"), sulfate);
+  EXPECT_NE(cfp::group_fingerprint("(SO4)2"), cfp::group_fingerprint("((SO4)2)"));
+}
+
+TEST(FingerprintTest, NestedGroupsAreStructure) {
+  EXPECT_EQ(cfp::group_fingerprint("[Fe(CN)6]"), cfp::group_fingerprint("Fe(NC)6"));
+  EXPECT_EQ(cfp::group_fingerprint("Fe(CN)2(CN)4"), cfp::group_fingerprint("Fe(CN)6"));
+
+  EXPECT_NE(cfp::group_fingerprint("Fe(CN)6"), cfp::group_fingerprint("Fe(CN)5"));
+  EXPECT_NE(cfp::group_fingerprint("Fe(CN)6"), cfp::group_fingerprint("FeC6N6"));
+}
+
+TEST(FingerprintTest, CountsCopiesAcrossMultipliers) {
+  EXPECT_EQ(copies("Fe2(SO4)3", "SO4"), 3u);
+  EXPECT_EQ(copies("K4[Fe(CN)6]", "[Fe(CN)6]"), 1u);
+  EXPECT_EQ(copies("K4[Fe(CN)6]", "(CN)"), 6u);
+  EXPECT_EQ(copies("Ca3[Fe(CN)6]2", "(CN)"), 12u);
+  EXPECT_EQ(copies("(NH4)2SO4*2Fe(NO3)3(NH4)", "NH4"), 4u);
+  EXPECT_EQ(copies("(NH4)2SO4*2Fe(NO3)3(NH4)", "NO3"), 6u);
+  EXPECT_EQ(copies("H2SO4", "SO4"), 0u);
+
+  // one entry per distinct group, ordered by fingerprint
+  const auto groups = cfp::group_fingerprints("Ca3[Fe(CN)6]2");
+  ASSERT_EQ(groups.size(), 2u);
+  EXPECT_LT(groups[0].fingerprint, groups[1].fingerprint);
+  EXPECT_TRUE(cfp::group_fingerprints("H2O").empty());
+}
+
+TEST(FingerprintTest, RejectsInvalidInput) {
+  EXPECT_THROW((void)cfp::group_fingerprints("Fe2(SO4"), cfp::ParserError);
+  EXPECT_THROW((void)cfp::group_fingerprints("()"), cfp::ParserError);
+  EXPECT_THROW((void)cfp::group_fingerprints("(Xx)2"), cfp::ParserError);
+  EXPECT_THROW((void)cfp::group_fingerprints("((C)4294967296)4294967296"), cfp::OverflowError);
+
+  EXPECT_THROW((void)cfp::group_fingerprint("2SO4"), std::invalid_argument);
+  EXPECT_THROW((void)cfp::group_fingerprint("SO4*H2O"), std::invalid_argument);
+}
+
+TEST(FingerprintTest, ReportsParserErrors) {
+  for (const std::string_view input : {"Fe2(SO4", "H2()O", "(Xx)2", "(H*O)", "H2O*", "Fe2)"}) {
+    std::string expected;
+
+    try {
+      (void)cfp::Parser{input}.parseComposition();
+    } catch (const cfp::ParserError &err) {
+      expected = err.what();
+    }
+
+    try {
+      (void)cfp::group_fingerprints(input);
+      ADD_FAILURE() << input;
+    } catch (const cfp::ParserError &err) {
+      EXPECT_EQ(err.what(), expected) << input;
+    }
+  }
+}
+
+TEST(FingerprintTest, AppliesLimits) {
+  const cfp::ParseLimits limits{.max_depth = 2};
+
+  EXPECT_NO_THROW((void)cfp::group_fingerprints("[Fe(CN)6]", limits));
+  EXPECT_THROW((void)cfp::group_fingerprints("[Fe((CN))6]", limits), cfp::LimitError);
+  EXPECT_THROW((void)cfp::group_fingerprint("((((H))))", limits), cfp::LimitError);
+
+  const std::vector<std::string_view> corpus{"Fe2(SO4)3", "K4[Fe(CN)6]"};
+  const auto index = cfp::FingerprintIndex::build(corpus, 1, limits);
+  EXPECT_EQ(index.find("(CN)"), (std::vector<cfp::MotifMatch>{{1, 6}}));
+  EXPECT_THROW((void)index.find("(((CN)))"), cfp::LimitError);
+
+  const std::vector<std::string_view> deep{"Fe2(SO4)3", "(((H)))"};
+  EXPECT_THROW((void)cfp::FingerprintIndex::build(deep, 1, limits), cfp::LimitError);
+}
+
+TEST(FingerprintIndexTest, FindsRecordsAndCounts) {
+  const std::vector<std::string_view> corpus{"Fe2(SO4)3", "CuSO4*5H2O", "(NH4)2SO4", "Al2(SO4)3*18H2O",
+                                             "K4[Fe(CN)6]", "Cu(NO3)2", "[Cu(H2O)4](SO4)"};
+
+  const auto index = cfp::FingerprintIndex::build(corpus);
+  EXPECT_EQ(index.size(), corpus.size());
+
+  EXPECT_EQ(index.find("(SO4)"), (std::vector<cfp::MotifMatch>{{0, 3}, {3, 3}, {6, 1}}));
+  EXPECT_EQ(index.find("(CN)"), (std::vector<cfp::MotifMatch>{{4, 6}}));
+  EXPECT_EQ(index.find("[Cu(H2O)4]"), (std::vector<cfp::MotifMatch>{{6, 1}}));
+  EXPECT_EQ(index.recordCount(cfp::group_fingerprint("NH4")), 1u);
+  EXPECT_TRUE(index.find("(PO4)").empty());
+
+  // SO4, NH4, [Fe(CN)6], CN, NO3, [Cu(H2O)4], H2O
+  EXPECT_EQ(index.fingerprints().size(), 7u);
+}
+
+TEST(FingerprintIndexTest, ParallelBuildMatchesSequential) {
+  const std::vector<std::string> pool{"Fe2(SO4)3", "K3[Fe(CN)6]", "(NH4)3PO4", "Ca(NO3)2*4H2O", "C6H12O6"};
+  std::vector<std::string> rows;
+
+  for (size_t row = 0; row < 5000; row++) {
+    rows.push_back(pool[(row * 7) % pool.size()]);
+  }
+
+  const std::vector<std::string_view> views(rows.begin(), rows.end());
+  const auto sequential = cfp::FingerprintIndex::build(views, 1);
+  const auto parallel = cfp::FingerprintIndex::build(views, 4);
+
+  ASSERT_EQ(std::vector(sequential.fingerprints().begin(), sequential.fingerprints().end()),
+            std::vector(parallel.fingerprints().begin(), parallel.fingerprints().end()));
+
+  for (const auto fingerprint : sequential.fingerprints()) {
+    EXPECT_EQ(sequential.find(fingerprint), parallel.find(fingerprint));
+  }
+
+  EXPECT_EQ(parallel.recordCount(cfp::group_fingerprint("NO3")), 1000u);
+}
+
+TEST(FingerprintIndexTest, ReportsFirstInvalidRecord) {
+  std::vector<std::string_view> rows(3000, "Fe2(SO4)3");
+  rows[2500] = "Fe2(SO4";
+  rows[1500] = "Fe2)";
+
+  try {
+    (void)cfp::FingerprintIndex::build(rows, 4);
+    FAIL() << "expected ParserError";
+  } catch (const cfp::ParserError &err) {
+    EXPECT_EQ(err.token.text, ")");
+  }
+}
@@ -0,0 +1,177 @@
+// tests/test_formula_search.cpp
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/formula_search.hpp"
+#include "cfp/isotope.hpp"
+#include "cfp/parser.hpp"
+
+static cfp::Composition compose(std::string_view formula) {
+  cfp::Parser parser{formula};
+  return parser.parseComposition();
+}
+
+static cfp::FormulaQuery chnoQuery(double mass, double tolerance) {
+  return {
+      .mass = mass,
+      .tolerance = tolerance,
+      .elements = {{cfp::element_id("C"), 0, 50},
+                   {cfp::element_id("H"), 0, 100},
+                   {cfp::element_id("N"), 0, 10},
+                   {cfp::element_id("O"), 0, 20}},
+      .filter = {},
+  };
+}
+
+// Canonical formula strings
+class HillFormulaTest : public ::testing::TestWithParam<std::tuple<std::string_view, std::string_view>> {};
+
+TEST_P(HillFormulaTest, RendersAndRoundTrips) {
+  const auto &[input, expected] = GetParam();
+  const auto comp = compose(input);
+
+  EXPECT_EQ(cfp::to_string(comp), expected);
+  EXPECT_EQ(compose(cfp::to_string(comp)), comp);
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+  Hill,
+  HillFormulaTest,
+  ::testing::Values(
+    std::make_tuple("H2O",          "H2O"),
+    std::make_tuple("NaCl",         "ClNa"),
+    std::make_tuple("C6H12O6",      "C6H12O6"),
+    std::make_tuple("CH3COOH",      "C2H4O2"),
+    std::make_tuple("CuSO4*5H2O",   "CuH10O9S"),
+    std::make_tuple("K[Fe(CN)6]",   "C6FeKN6")
+  )
+);
+// clang-format on
+
+// Chemistry filters
+TEST(FormulaFilterTest, Rdbe) {
+  EXPECT_DOUBLE_EQ(cfp::rdbe(compose("C6H6")), 4.0);
+  EXPECT_DOUBLE_EQ(cfp::rdbe(compose("H2O")), 0.0);
+  EXPECT_DOUBLE_EQ(cfp::rdbe(compose("C5H5N")), 4.0);
+  EXPECT_DOUBLE_EQ(cfp::rdbe(compose("CH3")), 0.5);
+}
+
+TEST(FormulaFilterTest, GoldenRules) {
+  EXPECT_TRUE(cfp::passes_golden_rules(compose("C6H12O6")));
+  EXPECT_TRUE(cfp::passes_golden_rules(compose("C8H10N4O2")));
+  EXPECT_FALSE(cfp::passes_golden_rules(compose("CH3")));  // odd valence sum
+  EXPECT_FALSE(cfp::passes_golden_rules(compose("C2H8")));  // H/C > 3.1 (and SENIOR)
+  EXPECT_FALSE(cfp::passes_golden_rules(compose("CH4O4")));  // O/C > 1.2
+}
+
+// Enumeration
+TEST(FormulaSearchTest, FindsGlucose) {
+  const auto glucose = compose("C6H12O6");
+  const double mass = cfp::monoisotopic_mass(glucose);
+
+  const auto candidates = cfp::find_formulas(chnoQuery(mass, 0.001));
+
+  ASSERT_FALSE(candidates.empty());
+  EXPECT_EQ(candidates.front().composition, glucose);
+  EXPECT_NEAR(candidates.front().error, 0.0, 1e-9);
+
+  for (const auto &candidate : candidates) {
+    EXPECT_LE(std::abs(candidate.error), 0.001);
+    EXPECT_NEAR(cfp::monoisotopic_mass(candidate.composition), candidate.mass, 1e-9);
+  }
+}
+
+TEST(FormulaSearchTest, MatchesExhaustiveEnumeration) {
+  const auto query = chnoQuery(cfp::monoisotopic_mass(compose("C8H10N4O2")), 0.01);
+  const auto candidates = cfp::find_formulas(query);
+
+  size_t expected = 0;
+
+  for (uint32_t c = 0; c <= 50; c++) {
+    for (uint32_t h = 0; h <= 100; h++) {
+      for (uint32_t n = 0; n <= 10; n++) {
+        for (uint32_t o = 0; o <= 20; o++) {
+          const double mass = 12.0 * c + 1.00782503223 * h + 14.00307400443 * n + 15.99491461957 * o;
+          if (std::abs(mass - query.mass) <= query.tolerance) {
+            expected++;
+          }
+        }
+      }
+    }
+  }
+
+  EXPECT_EQ(candidates.size(), expected);
+}
+
+TEST(FormulaSearchTest, FiltersReduceCandidates) {
+  auto query = chnoQuery(cfp::monoisotopic_mass(compose("C8H10N4O2")), 0.01);
+  const auto unfiltered = cfp::find_formulas(query);
+
+  query.filter = {.min_rdbe = 0.0, .integer_rdbe = true, .golden_rules = true};
+  const auto filtered = cfp::find_formulas(query);
+
+  EXPECT_LT(filtered.size(), unfiltered.size());
+
+  const auto caffeine = std::find_if(filtered.begin(), filtered.end(), [](const cfp::FormulaCandidate &candidate) {
+    return cfp::to_string(candidate.composition) == "C8H10N4O2";
+  });
+  EXPECT_NE(caffeine, filtered.end());
+
+  for (const auto &candidate : filtered) {
+    EXPECT_GE(candidate.rdbe, 0.0);
+    EXPECT_TRUE(cfp::passes_golden_rules(candidate.composition));
+  }
+}
+
+TEST(FormulaSearchTest, ParallelMatchesSerial) {
+  const auto query = chnoQuery(300.0, 0.005);
+
+  const auto serial = cfp::find_formulas(query, 1);
+  const auto parallel = cfp::find_formulas(query, 4);
+
+  ASSERT_EQ(serial.size(), parallel.size());
+
+  for (size_t idx = 0; idx < serial.size(); idx++) {
+    EXPECT_EQ(serial[idx].composition, parallel[idx].composition);
+  }
+}
+
+TEST(FormulaSearchTest, BatchMatchesSingleQueries) {
+  const std::vector<cfp::FormulaQuery> queries{chnoQuery(180.0634, 0.001), chnoQuery(194.0804, 0.001),
+                                               chnoQuery(46.0419, 0.001)};
+
+  const auto batch = cfp::find_formulas_batch(queries, 3);
+  ASSERT_EQ(batch.size(), queries.size());
+
+  for (size_t idx = 0; idx < queries.size(); idx++) {
+    const auto single = cfp::find_formulas(queries[idx]);
+    ASSERT_EQ(batch[idx].size(), single.size());
+
+    for (size_t candidate = 0; candidate < single.size(); candidate++) {
+      EXPECT_EQ(batch[idx][candidate].composition, single[candidate].composition);
+    }
+  }
+}
+
+TEST(FormulaSearchTest, RejectsInvalidQueries) {
+  const auto query = [](std::vector<cfp::ElementRange> elements) {
+    cfp::FormulaQuery result;
+    result.mass = 10.0;
+    result.elements = std::move(elements);
+    return result;
+  };
+
+  EXPECT_THROW(cfp::find_formulas(query({})), std::invalid_argument);
+  EXPECT_THROW(cfp::find_formulas(query({{cfp::element_id("C"), 5, 1}})), std::invalid_argument);
+  EXPECT_THROW(cfp::find_formulas(query({{cfp::element_id("Tc"), 0, 1}})), std::invalid_argument);
+  EXPECT_THROW(cfp::find_formulas(query({{6, 0, 1}, {6, 0, 2}})), std::invalid_argument);
+}
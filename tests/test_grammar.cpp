@@ -0,0 +1,104 @@
+// tests/test_grammar.cpp
+
+#include <gtest/gtest.h>
+
+#include <string_view>
+#include <unordered_map>
+
+#include "cfp/element.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/error/tokenizer_error.hpp"
+#include "cfp/grammar.hpp"
+#include "cfp/parser.hpp"
+
+using ExpectedMap = std::unordered_map<std::string, uint64_t>;
+
+namespace {
+
+struct NoLigandGrammar : cfp::FullGrammar {
+  static constexpr bool LIGANDS = false;
+};
+
+struct ParensOnlyGrammar : cfp::FullGrammar {
+  static constexpr bool BRACKETS = false;
+  static constexpr bool LIGANDS = false;
+};
+
+struct NoGroupMultiplierGrammar : cfp::FullGrammar {
+  static constexpr bool GROUP_MULTIPLIERS = false;
+};
+
+template <typename G>
+ExpectedMap parseWith(std::string_view input) {
+  cfp::BasicParser<G> parser{input};
+  return parser.parse();
+}
+
+}  // namespace
+
+// Element table
+TEST(ElementTest, LooksUpSymbols) {
+  EXPECT_EQ(cfp::element_id("H"), 1);
+  EXPECT_EQ(cfp::element_id("Fe"), 26);
+  EXPECT_EQ(cfp::element_id("Og"), 118);
+  EXPECT_EQ(cfp::element_id("Xx"), 0);
+  EXPECT_EQ(cfp::element_id("fe"), 0);
+  EXPECT_EQ(cfp::element_id("Fee"), 0);
+  EXPECT_EQ(cfp::element_id(""), 0);
+
+  EXPECT_EQ(cfp::element_symbol(8), "O");
+  EXPECT_EQ(cfp::element_symbol(0), "");
+}
+
+TEST(ElementTest, RoundTripsAllSymbols) {
+  for (size_t id = 1; id <= cfp::ELEMENT_COUNT; id++) {
+    EXPECT_EQ(cfp::element_id(cfp::ELEMENT_SYMBOLS[id]), id) << cfp::ELEMENT_SYMBOLS[id];
+  }
+}
+
+// Full grammar is what cfp::Parser uses
+TEST(GrammarTest, FullGrammarMatchesParser) {
+  EXPECT_EQ(parseWith<cfp::FullGrammar>("K[Fe(NO3)2]4*2H2O"),
+            (ExpectedMap{{"K", 1}, {"Fe", 4}, {"N", 8}, {"O", 26}, {"H", 4}}));
+}
+
+TEST(GrammarTest, FlatGrammarParsesElementSequences) {
+  EXPECT_EQ(parseWith<cfp::FlatGrammar>("C12H22O11"), (ExpectedMap{{"C", 12}, {"H", 22}, {"O", 11}}));
+}
+
+TEST(GrammarTest, FlatGrammarRejectsGroupsAndLigands) {
+  EXPECT_THROW(parseWith<cfp::FlatGrammar>("Mg(OH)2"), cfp::TokenizerError);
+  EXPECT_THROW(parseWith<cfp::FlatGrammar>("Al[OH]3"), cfp::TokenizerError);
+  EXPECT_THROW(parseWith<cfp::FlatGrammar>("CuSO4*5H2O"), cfp::TokenizerError);
+  EXPECT_THROW(parseWith<cfp::FlatGrammar>("2H2O"), cfp::ParserError);
+}
+
+TEST(GrammarTest, NoLigandGrammarKeepsGroups) {
+  EXPECT_EQ(parseWith<NoLigandGrammar>("Fe2(SO4)3"), (ExpectedMap{{"Fe", 2}, {"S", 3}, {"O", 12}}));
+  EXPECT_THROW(parseWith<NoLigandGrammar>("CuSO4*5H2O"), cfp::TokenizerError);
+}
+
+TEST(GrammarTest, ParensOnlyGrammarRejectsBrackets) {
+  EXPECT_EQ(parseWith<ParensOnlyGrammar>("((H)2)3"), (ExpectedMap{{"H", 6}}));
+  EXPECT_THROW(parseWith<ParensOnlyGrammar>("K[Fe(NO3)2]4"), cfp::TokenizerError);
+  EXPECT_THROW(parseWith<ParensOnlyGrammar>("(H2O"), cfp::ParserError);
+  EXPECT_THROW(parseWith<ParensOnlyGrammar>("H2O)"), cfp::ParserError);
+}
+
+TEST(GrammarTest, NoGroupMultiplierGrammarRejectsMultipliedGroups) {
+  EXPECT_EQ(parseWith<NoGroupMultiplierGrammar>("Ca(OH)H"), (ExpectedMap{{"Ca", 1}, {"O", 1}, {"H", 2}}));
+  EXPECT_THROW(parseWith<NoGroupMultiplierGrammar>("Mg(OH)2"), cfp::ParserError);
+}
+
+TEST(GrammarTest, StrictGrammarValidatesElements) {
+  EXPECT_EQ(parseWith<cfp::StrictGrammar>("NaCl"), (ExpectedMap{{"Na", 1}, {"Cl", 1}}));
+  EXPECT_EQ(parseWith<cfp::FullGrammar>("Xx2"), (ExpectedMap{{"Xx", 2}}));
+
+  try {
+    parseWith<cfp::StrictGrammar>("H2Xx");
+    FAIL() << "Expected TokenizerError for unknown element";
+  } catch (const cfp::TokenizerError &err) {
+    EXPECT_EQ(err.offset, 2U);
+    EXPECT_EQ(err.token.text, "Xx");
+  }
+}
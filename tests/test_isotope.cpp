@@ -0,0 +1,184 @@
+// tests/test_isotope.cpp
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/isotope.hpp"
+#include "cfp/isotope_pattern.hpp"
+#include "cfp/parser.hpp"
+
+static cfp::Composition compose(std::string_view formula) {
+  cfp::Parser parser{formula};
+  return parser.parseComposition();
+}
+
+static double totalProbability(const cfp::IsotopeDistribution &dist) {
+  return std::accumulate(dist.begin(), dist.end(), 0.0,
+                         [](double sum, const cfp::Peak &peak) { return sum + peak.probability; });
+}
+
+// Isotope table
+TEST(IsotopeTableTest, AbundancesSumToOne) {
+  for (cfp::ElementId id = 1; id <= cfp::ELEMENT_COUNT; id++) {
+    const auto element_isotopes = cfp::isotopes(id);
+
+    if (element_isotopes.empty()) {
+      continue;
+    }
+
+    double sum = 0.0;
+
+    for (const auto &isotope : element_isotopes) {
+      EXPECT_EQ(isotope.element, id);
+      sum += isotope.abundance;
+    }
+
+    EXPECT_NEAR(sum, 1.0, 1e-3) << cfp::element_symbol(id);
+  }
+}
+
+TEST(IsotopeTableTest, MissingElementsHaveNoIsotopes) {
+  EXPECT_TRUE(cfp::isotopes(cfp::element_id("Tc")).empty());
+  EXPECT_TRUE(cfp::isotopes(cfp::element_id("Og")).empty());
+  EXPECT_EQ(cfp::isotopes(cfp::element_id("Sn")).size(), 10U);
+}
+
+TEST(IsotopeTableTest, Masses) {
+  EXPECT_NEAR(cfp::monoisotopic_mass(compose("H2O")), 18.0105646837, 1e-9);
+  EXPECT_NEAR(cfp::average_mass(compose("H2O")), 18.015, 1e-3);
+  EXPECT_NEAR(cfp::average_mass(compose("NaCl")), 58.44, 1e-2);
+  EXPECT_THROW(cfp::monoisotopic_mass(compose("TcO4")), std::invalid_argument);
+}
+
+// Distributions
+TEST(IsotopePatternTest, SingleElement) {
+  const auto dist = cfp::isotope_distribution(compose("C"));
+
+  ASSERT_EQ(dist.size(), 2U);
+  EXPECT_EQ(dist[0].nominal, 12U);
+  EXPECT_NEAR(dist[0].probability, 0.9893, 1e-12);
+  EXPECT_NEAR(dist[1].mass, 13.00335483507, 1e-9);
+}
+
+TEST(IsotopePatternTest, ChlorinePattern) {
+  const auto dist = cfp::isotope_distribution(compose("Cl2"));
+
+  ASSERT_EQ(dist.size(), 3U);
+  EXPECT_NEAR(dist[0].probability, 0.7576 * 0.7576, 1e-12);
+  EXPECT_NEAR(dist[1].probability, 2 * 0.7576 * 0.2424, 1e-12);
+  EXPECT_NEAR(dist[2].probability, 0.2424 * 0.2424, 1e-12);
+  EXPECT_EQ(dist[2].nominal, 74U);
+}
+
+TEST(IsotopePatternTest, RepeatedSquaringMatchesBinomial) {
+  const auto dist = cfp::isotope_distribution(compose("C100"), {.threshold = 1e-12});
+
+  ASSERT_GE(dist.size(), 3U);
+  EXPECT_NEAR(dist[0].probability, std::pow(0.9893, 100), 1e-9);
+  EXPECT_NEAR(dist[1].probability, 100 * 0.0107 * std::pow(0.9893, 99), 1e-9);
+  EXPECT_NEAR(totalProbability(dist), 1.0, 1e-6);
+}
+
+TEST(IsotopePatternTest, FineModeResolvesIsobars) {
+  const auto comp = compose("CH4");
+
+  const auto aggregated = cfp::isotope_distribution(comp, {.threshold = 1e-9, .mode = cfp::IsotopeMode::Aggregated});
+  const auto fine = cfp::isotope_distribution(comp, {.threshold = 1e-9, .mode = cfp::IsotopeMode::Fine});
+
+  // M+1 is 13C (+1.00336) or 2H (+1.00628): one aggregated peak, two fine peaks
+  const auto countNominal = [](const cfp::IsotopeDistribution &dist, uint64_t nominal) {
+    return std::count_if(dist.begin(), dist.end(), [nominal](const cfp::Peak &peak) { return peak.nominal == nominal; });
+  };
+
+  EXPECT_EQ(countNominal(aggregated, 17), 1);
+  EXPECT_EQ(countNominal(fine, 17), 2);
+  EXPECT_NEAR(totalProbability(aggregated), totalProbability(fine), 1e-9);
+}
+
+TEST(IsotopePatternTest, ThresholdPrunesPeaks) {
+  const auto comp = compose("C6H12O6");
+
+  const auto full = cfp::isotope_distribution(comp, {.threshold = 1e-15});
+  const auto pruned = cfp::isotope_distribution(comp, {.threshold = 1e-3});
+
+  EXPECT_LT(pruned.size(), full.size());
+
+  for (const auto &peak : pruned) {
+    EXPECT_GE(peak.probability, 1e-3);
+  }
+}
+
+TEST(IsotopePatternTest, PrunedProbabilityStaysNearThreshold) {
+  // many products below the threshold add up to peaks above it
+  const auto comp = compose("C1000H2000N300O500S20");
+  const auto reference = cfp::isotope_distribution(comp, {.threshold = 1e-12});
+
+  for (const double threshold : {1e-3, 1e-6}) {
+    const auto dist = cfp::isotope_distribution(comp, {.threshold = threshold});
+
+    // only the few tail bins below the threshold are missing
+    EXPECT_NEAR(totalProbability(dist), 1.0, 10 * threshold);
+
+    for (const auto &peak : dist) {
+      const auto it = std::find_if(reference.begin(), reference.end(),
+                                   [&peak](const cfp::Peak &ref) { return ref.nominal == peak.nominal; });
+      ASSERT_NE(it, reference.end());
+      EXPECT_NEAR(peak.probability, it->probability, threshold);
+    }
+  }
+}
+
+TEST(IsotopePatternTest, FineModeStaysNearThreshold) {
+  const auto comp = compose("C1000H2000N300O500S20");
+  const cfp::IsotopeOptions options{.threshold = 1e-6, .mode = cfp::IsotopeMode::Fine};
+  const auto reference = cfp::isotope_distribution(comp, {.threshold = 1e-10, .mode = cfp::IsotopeMode::Fine});
+  const auto dist = cfp::isotope_distribution(comp, options);
+
+  ASSERT_FALSE(dist.empty());
+
+  // every peak has a reference bin at (about) its mass with (about) its probability
+  for (const auto &peak : dist) {
+    auto it = std::lower_bound(reference.begin(), reference.end(), peak.mass,
+                               [](const cfp::Peak &ref, double mass) { return ref.mass < mass; });
+
+    if (it == reference.end() || (it != reference.begin() && peak.mass - (it - 1)->mass < it->mass - peak.mass)) {
+      --it;
+    }
+
+    ASSERT_NEAR(it->mass, peak.mass, options.resolution);
+    EXPECT_NEAR(it->probability, peak.probability, options.threshold);
+  }
+}
+
+TEST(IsotopePatternTest, BatchMatchesSingleCalls) {
+  const std::vector<cfp::Composition> comps{compose("C6H12O6"), compose("C12H22O11"), compose("CuSO4*5H2O")};
+
+  cfp::IsotopeCalculator calculator;
+  const auto batch = calculator.computeBatch(comps);
+
+  ASSERT_EQ(batch.size(), comps.size());
+
+  for (size_t idx = 0; idx < comps.size(); idx++) {
+    const auto single = cfp::isotope_distribution(comps[idx]);
+    ASSERT_EQ(batch[idx].size(), single.size());
+
+    for (size_t peak = 0; peak < single.size(); peak++) {
+      EXPECT_DOUBLE_EQ(batch[idx][peak].mass, single[peak].mass);
+      EXPECT_DOUBLE_EQ(batch[idx][peak].probability, single[peak].probability);
+    }
+  }
+}
+
+TEST(IsotopePatternTest, RejectsElementsWithoutIsotopes) {
+  cfp::IsotopeCalculator calculator;
+
+  EXPECT_TRUE(calculator.compute(cfp::Composition{}).empty());
+  EXPECT_THROW(calculator.compute(compose("Pm2O3")), std::invalid_argument);
+}
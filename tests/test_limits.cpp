@@ -0,0 +1,247 @@
+// tests/test_limits.cpp
+
+#include <gtest/gtest.h>
+
+#include <algorithm>  // max
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "cfp/error/limit_error.hpp"
+#include "cfp/error/overflow_error.hpp"
+#include "cfp/limits.hpp"
+#include "cfp/parser.hpp"
+#include "cfp/parser_context.hpp"
+
+namespace {
+
+constexpr cfp::ParseLimits LIMITS{
+    .max_length = 1024, .max_depth = 8, .max_tokens = 256, .max_units = 4, .max_count = 1'000'000};
+
+std::string repeat(std::string_view text, size_t times) {
+  std::string out;
+  out.reserve(text.size() * times);
+
+  for (size_t idx = 0; idx < times; idx++) {
+    out += text;
+  }
+
+  return out;
+}
+
+/// "(((H)))" with @a depth parentheses.
+std::string nested(size_t depth) {
+  return repeat("(", depth) + "H" + repeat(")", depth);
+}
+
+std::optional<cfp::LimitError> parser_limit_error(std::string_view input, const cfp::ParseLimits &limits) {
+  try {
+    cfp::Parser parser{input, limits};
+    (void)parser.parseComposition();
+  } catch (const cfp::LimitError &err) {
+    return err;
+  }
+
+  return std::nullopt;
+}
+
+std::optional<cfp::LimitError> context_limit_error(std::string_view input, const cfp::ParseLimits &limits) {
+  try {
+    cfp::ParserContext context{limits};
+    (void)context.parse(input);
+  } catch (const cfp::LimitError &err) {
+    return err;
+  }
+
+  return std::nullopt;
+}
+
+/// LimitError thrown by Parser, after checking that ParserContext reports the same one.
+std::optional<cfp::LimitError> limit_error(std::string_view input, const cfp::ParseLimits &limits = LIMITS) {
+  const auto from_parser = parser_limit_error(input, limits);
+  const auto from_context = context_limit_error(input, limits);
+
+  EXPECT_EQ(from_parser.has_value(), from_context.has_value()) << input.substr(0, 32);
+
+  if (from_parser && from_context) {
+    EXPECT_EQ(from_parser->kind, from_context->kind);
+    EXPECT_EQ(from_parser->offset, from_context->offset);
+    EXPECT_STREQ(from_parser->what(), from_context->what());
+  }
+
+  return from_parser;
+}
+
+}  // namespace
+
+TEST(LimitsTest, DefaultsImposeNoLimits) {
+  const auto input = nested(1000) + repeat("*H2O", 100);
+
+  cfp::Parser parser{input};
+  EXPECT_EQ(parser.parseComposition().count("O"), 100u);
+  EXPECT_FALSE(limit_error(input, {}).has_value());
+}
+
+TEST(LimitsTest, InputsAtTheLimitsParse) {
+  EXPECT_FALSE(limit_error(repeat("H", 256)).has_value());
+  EXPECT_FALSE(limit_error(nested(8)).has_value());
+  EXPECT_FALSE(limit_error("H2O*H2O*H2O*H2O").has_value());
+  EXPECT_FALSE(limit_error("(H1000)1000").has_value());
+}
+
+TEST(LimitsTest, LengthIsCheckedBeforeLexing) {
+  // the first byte is not even a valid lexeme
+  const auto err = limit_error("$" + repeat("H", 1024));
+
+  ASSERT_TRUE(err.has_value());
+  EXPECT_EQ(err->kind, cfp::LimitKind::Length);
+  EXPECT_EQ(err->offset, 1024u);
+  EXPECT_EQ(err->limit, 1024u);
+  EXPECT_STREQ(err->what(), "Limit exceeded: input of 1025 bytes is too long (limit 1024) at pos 1024 (kind=Length)");
+}
+
+TEST(LimitsTest, DepthStopsAtTheFirstTooDeepGroup) {
+  const auto err = limit_error(nested(9));
+
+  ASSERT_TRUE(err.has_value());
+  EXPECT_EQ(err->kind, cfp::LimitKind::Depth);
+  EXPECT_EQ(err->offset, 8u);
+
+  // siblings do not add up
+  EXPECT_FALSE(limit_error(repeat(nested(8), 4)).has_value());
+}
+
+TEST(LimitsTest, TokensAreCountedWhileLexing) {
+  const auto err = limit_error(repeat("H", 257));
+
+  ASSERT_TRUE(err.has_value());
+  EXPECT_EQ(err->kind, cfp::LimitKind::Tokens);
+  EXPECT_EQ(err->offset, 256u);
+}
+
+TEST(LimitsTest, FirstLimitReachedWins) {
+  // the depth limit is hit before the 4th token is lexed
+  auto err = limit_error("((((H))))", {.max_depth = 2, .max_tokens = 3});
+  ASSERT_TRUE(err.has_value());
+  EXPECT_EQ(err->kind, cfp::LimitKind::Depth);
+  EXPECT_EQ(err->offset, 2u);
+
+  // and the unit limit before the tokens of the rejected unit
+  err = limit_error("H*H*" + repeat("H", 10), {.max_tokens = 8, .max_units = 2});
+  ASSERT_TRUE(err.has_value());
+  EXPECT_EQ(err->kind, cfp::LimitKind::Units);
+  EXPECT_EQ(err->offset, 4u);
+}
+
+TEST(LimitsTest, UnitsAreCountedBeforeParsingThem) {
+  const auto err = limit_error("H2O*H2O*H2O*H2O*5H2O");
+
+  ASSERT_TRUE(err.has_value());
+  EXPECT_EQ(err->kind, cfp::LimitKind::Units);
+  EXPECT_EQ(err->offset, 16u);
+}
+
+TEST(LimitsTest, NumbersAndTotalsAreCounts) {
+  // a single number is rejected where it stands
+  auto err = limit_error("CH1000001");
+  ASSERT_TRUE(err.has_value());
+  EXPECT_EQ(err->kind, cfp::LimitKind::Count);
+  EXPECT_EQ(err->offset, 2u);
+
+  // a product or sum only after evaluation, at the end of the input
+  for (const std::string_view input : {"(H1000)1001", "H1000000H", "2(H1000)1000"}) {
+    err = limit_error(input);
+    ASSERT_TRUE(err.has_value()) << input;
+    EXPECT_EQ(err->kind, cfp::LimitKind::Count);
+    EXPECT_EQ(err->offset, input.size());
+    EXPECT_NE(std::string_view{err->what()}.find("count of H is too large"), std::string_view::npos);
+  }
+}
+
+TEST(LimitsTest, CountLimitReplacesOverflowError) {
+  const std::string_view input = "((((C1000000)1000000)1000000)1000000)";
+
+  cfp::Parser parser{input};
+  EXPECT_THROW((void)parser.parseComposition(), cfp::OverflowError);
+
+  const auto err = limit_error(input, {.max_count = 1'000'000});
+  ASSERT_TRUE(err.has_value());
+  EXPECT_EQ(err->kind, cfp::LimitKind::Count);
+}
+
+TEST(LimitsTest, EveryEntryPointAppliesTheLimits) {
+  cfp::Parser map_parser{"(H1000)1001", LIMITS};
+  EXPECT_THROW((void)map_parser.parse(), cfp::LimitError);
+
+  cfp::Parser wide_parser{"(H1000)1001", LIMITS};
+  EXPECT_THROW((void)wide_parser.parseWide(), cfp::LimitError);
+
+  // units are counted over all species of an equation
+  cfp::EquationParser equation{"H2*H2*H2 + O2*O2 -> H2O", LIMITS};
+  EXPECT_THROW((void)equation.parseEquation(), cfp::LimitError);
+
+  cfp::ParametricParser parametric{"(CH2)n(H1000)1001", LIMITS};
+  EXPECT_THROW((void)parametric.parseParametric(), cfp::LimitError);
+
+  // limits win over later grammar errors
+  EXPECT_THROW(cfp::Parser(repeat("(", 100), LIMITS).parse(), cfp::LimitError);
+}
+
+TEST(LimitsTest, ContextLimitsCanChange) {
+  cfp::ParserContext context;
+  EXPECT_NO_THROW((void)context.parse(nested(9)));
+
+  context.setLimits(LIMITS);
+  EXPECT_EQ(context.limits().max_depth, 8u);
+  EXPECT_THROW((void)context.parse(nested(9)), cfp::LimitError);
+  EXPECT_TRUE(context.result().empty());
+
+  // a rejected input leaves the context usable
+  EXPECT_EQ(context.parse(nested(8)).count("H"), 1u);
+}
+
+// Hostile inputs of 4 MiB: each must be rejected at a position bounded by
+// the limits, i.e. after work independent of the input size.
+TEST(LimitsStressTest, HostileInputsAreRejectedEarly) {
+  constexpr size_t SIZE = size_t{4} << 20;
+  constexpr cfp::ParseLimits limits{.max_depth = 64, .max_tokens = 4096, .max_units = 256, .max_count = 1'000'000};
+
+  struct Case {
+    std::string input;
+    cfp::LimitKind kind;
+    size_t max_offset;
+  };
+
+  const Case cases[] = {
+      {repeat("(", SIZE), cfp::LimitKind::Depth, 64},
+      {nested(SIZE / 2), cfp::LimitKind::Depth, 64},
+      {repeat("H", SIZE), cfp::LimitKind::Tokens, 4096},
+      {repeat("H*", SIZE / 2), cfp::LimitKind::Units, 512},
+      {"H" + repeat("9", SIZE), cfp::LimitKind::Count, 1},
+      {"(H)" + repeat("9", SIZE), cfp::LimitKind::Count, 3},
+      {repeat("(H1000)1000", SIZE / 11), cfp::LimitKind::Tokens, ((4096 / 5) + 1) * 11},
+      {repeat("(", 64) + "H" + repeat(")1000", 64), cfp::LimitKind::Count, 64 + 1 + (5 * 64)},
+  };
+
+  for (const auto &test : cases) {
+    SCOPED_TRACE(test.input.substr(0, 16));
+
+    const auto err = parser_limit_error(test.input, limits);
+    ASSERT_TRUE(err.has_value());
+    EXPECT_EQ(err->kind, test.kind);
+    EXPECT_LE(err->offset, test.max_offset);
+
+    // the context lexes everything first, so it may stop at the token limit instead
+    const auto context_err = context_limit_error(test.input, limits);
+    ASSERT_TRUE(context_err.has_value());
+    EXPECT_TRUE(context_err->kind == test.kind || context_err->kind == cfp::LimitKind::Tokens);
+    EXPECT_LE(context_err->offset, std::max<size_t>(test.max_offset, 4096 * 11));
+  }
+
+  // with a length limit nothing of the input is looked at
+  const auto err = limit_error(repeat("(", SIZE), {.max_length = 4096});
+  ASSERT_TRUE(err.has_value());
+  EXPECT_EQ(err->kind, cfp::LimitKind::Length);
+}
@@ -0,0 +1,172 @@
+// tests/test_overflow.cpp
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>  // pair
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/error/overflow_error.hpp"
+#include "cfp/error/stream_error.hpp"
+#include "cfp/error/tokenizer_error.hpp"
+#include "cfp/parser.hpp"
+#include "cfp/parser_context.hpp"
+#include "cfp/query.hpp"
+#include "cfp/recovery.hpp"
+#include "cfp/stream_parser.hpp"
+#include "cfp/wide_composition.hpp"
+
+namespace {
+
+constexpr uint64_t MAX = std::numeric_limits<uint64_t>::max();
+
+// 2^64 - 1 fits; doubling it does not
+constexpr std::string_view AT_LIMIT = "C18446744073709551615";
+constexpr std::string_view NESTED_OVERFLOW = "((C)18446744073709551615)2";
+constexpr std::string_view UNIT_OVERFLOW = "4294967296(C4294967296)";
+constexpr std::string_view SUM_OVERFLOW = "C18446744073709551615C";
+
+}  // namespace
+
+TEST(OverflowTest, LargestCountParses) {
+  cfp::Parser parser{AT_LIMIT};
+  EXPECT_EQ(parser.parseComposition().count("C"), MAX);
+}
+
+TEST(OverflowTest, NumberBeyond64BitsIsTokenizerError) {
+  try {
+    cfp::Parser parser{"C18446744073709551616"};
+    parser.parse();
+    FAIL() << "expected TokenizerError";
+  } catch (const cfp::TokenizerError &err) {
+    EXPECT_EQ(err.offset, 1u);
+    EXPECT_NE(std::string_view{err.what()}.find("exceeds 64 bits"), std::string_view::npos);
+  }
+}
+
+TEST(OverflowTest, EveryEvaluatorThrowsOverflowError) {
+  for (const auto input : {NESTED_OVERFLOW, UNIT_OVERFLOW, SUM_OVERFLOW}) {
+    EXPECT_THROW(cfp::Parser{input}.parse(), cfp::OverflowError) << input;
+    EXPECT_THROW(cfp::Parser{input}.parseComposition(), cfp::OverflowError) << input;
+
+    cfp::ParserContext ctx;
+    EXPECT_THROW(ctx.parse(input), cfp::OverflowError) << input;
+    EXPECT_THROW(cfp::count_of(input, "C"), cfp::OverflowError) << input;
+  }
+}
+
+TEST(OverflowTest, ReportsOffsetOfOverflowingTerm) {
+  const auto offset = [](auto &&evaluate) -> std::optional<size_t> {
+    try {
+      evaluate();
+    } catch (const cfp::OverflowError &err) {
+      return err.offset;
+    }
+    return std::nullopt;
+  };
+
+  // the inner group's multiplier, the count of C, the second C
+  const std::vector<std::pair<std::string_view, size_t>> cases{
+      {NESTED_OVERFLOW, 4}, {UNIT_OVERFLOW, 12}, {SUM_OVERFLOW, 21}};
+
+  for (const auto &[input, expected] : cases) {
+    EXPECT_EQ(offset([&] { (void)cfp::Parser{input}.parse(); }), expected) << input;
+    EXPECT_EQ(offset([&] { (void)cfp::Parser{input}.parseComposition(); }), expected) << input;
+    EXPECT_EQ(offset([&] { (void)cfp::Parser{input}.parseBreakdown(); }), expected) << input;
+  }
+
+  // count_of scales a group when it closes, so an outer multiplier overflows
+  EXPECT_EQ(offset([] { (void)cfp::count_of(NESTED_OVERFLOW, "C"); }), 25u);
+  EXPECT_EQ(offset([] { (void)cfp::count_of(UNIT_OVERFLOW, "C"); }), 0u);
+  EXPECT_EQ(offset([] { (void)cfp::count_of(SUM_OVERFLOW, "C"); }), 21u);
+
+  // right to left, the context sees the first C's count overflow the sum
+  cfp::ParserContext ctx;
+  EXPECT_EQ(offset([&] { (void)ctx.parse(NESTED_OVERFLOW); }), 4u);
+  EXPECT_EQ(offset([&] { (void)ctx.parse(UNIT_OVERFLOW); }), 12u);
+  EXPECT_EQ(offset([&] { (void)ctx.parse(SUM_OVERFLOW); }), 1u);
+
+  EXPECT_EQ(offset([] { cfp::Parser{"(((C)18446744073709551615)18446744073709551615)3"}.parseWide(); }), 5u);
+  EXPECT_EQ(offset([] {
+              cfp::Composition comp;
+              comp.add(6, MAX);
+              comp += comp;
+            }),
+            std::nullopt);
+}
+
+TEST(OverflowTest, StreamReportsCountOverflow) {
+  for (const auto input : {NESTED_OVERFLOW, UNIT_OVERFLOW, SUM_OVERFLOW}) {
+    try {
+      cfp::parse_stream(std::vector{input});
+      FAIL() << "expected StreamError for " << input;
+    } catch (const cfp::StreamError &err) {
+      EXPECT_EQ(err.kind, cfp::DiagnosticKind::CountOverflow) << input;
+    }
+  }
+}
+
+TEST(OverflowTest, RecoveryReportsCountOverflow) {
+  cfp::DiagnosticSink sink;
+  const auto comp = cfp::parse_recovering("((C)18446744073709551615)2*H2O", sink);
+
+  ASSERT_EQ(sink.size(), 1u);
+  EXPECT_EQ(sink[0].kind, cfp::DiagnosticKind::CountOverflow);
+  EXPECT_EQ(comp.count("H"), 2u);
+}
+
+TEST(OverflowTest, CompositionArithmeticIsChecked) {
+  cfp::Composition comp;
+  comp.add(6, MAX);
+
+  EXPECT_THROW(comp.add(6, 1), cfp::OverflowError);
+  EXPECT_THROW(comp += comp, cfp::OverflowError);
+  EXPECT_THROW(comp *= 2, cfp::OverflowError);
+
+  // C18446744073709551615H: each count fits, the total does not
+  const auto polymer = cfp::Parser{"C18446744073709551615H"}.parseComposition();
+  EXPECT_THROW((void)polymer.total(), cfp::OverflowError);
+  EXPECT_EQ(cfp::Parser{"C18446744073709551614H"}.parseComposition().total(), MAX);
+}
+
+TEST(WideCompositionTest, EvaluatesBeyond64Bits) {
+  cfp::Parser parser{NESTED_OVERFLOW};
+  const auto wide = parser.parseWide();
+
+  EXPECT_EQ(wide[6], cfp::wide_count{MAX} * 2);
+  EXPECT_EQ(cfp::to_string(wide[6]), "36893488147419103230");
+  EXPECT_FALSE(wide.fitsNarrow());
+  EXPECT_THROW((void)wide.narrow(), cfp::OverflowError);
+}
+
+TEST(WideCompositionTest, MatchesNarrowWhenItFits) {
+  for (const std::string_view input : {std::string_view{"H2O"}, std::string_view{"K4[Fe(CN)6]*3H2O"}, AT_LIMIT}) {
+    cfp::Parser narrow{input};
+    cfp::Parser wide{input};
+
+    EXPECT_EQ(wide.parseWide().narrow(), narrow.parseComposition()) << input;
+  }
+}
+
+TEST(WideCompositionTest, StillChecked) {
+  // (2^64 - 1)^2 * 2^64 > 2^128
+  cfp::Parser parser{"(((C)18446744073709551615)18446744073709551615)18446744073709551615"};
+  EXPECT_THROW(parser.parseWide(), cfp::OverflowError);
+
+  EXPECT_EQ(cfp::to_string(cfp::wide_count{0}), "0");
+}
+
+TEST(WideCompositionTest, AddRejectsIdsBeyondCapacity) {
+  cfp::WideComposition comp;
+
+  EXPECT_THROW(comp.add(200, 1), std::out_of_range);
+  EXPECT_THROW(comp.add(cfp::WideComposition::CAPACITY, 1), std::out_of_range);
+  EXPECT_TRUE(comp.empty());
+
+  comp.add(cfp::WideComposition::CAPACITY - 1, 1);
+  EXPECT_EQ(comp[cfp::WideComposition::CAPACITY - 1], 1U);
+}
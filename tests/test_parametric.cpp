@@ -0,0 +1,122 @@
+// tests/test_parametric.cpp
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cfp/error/overflow_error.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/error/tokenizer_error.hpp"
+#include "cfp/parametric.hpp"
+#include "cfp/parser.hpp"
+
+namespace {
+
+cfp::ParametricComposition parametric(std::string_view input) {
+  cfp::ParametricParser parser{input};
+  return parser.parseParametric();
+}
+
+cfp::Composition concrete(std::string_view input) {
+  cfp::Parser parser{input};
+  return parser.parseComposition();
+}
+
+}  // namespace
+
+TEST(ParametricTest, SplitsConstantAndParameterTerms) {
+  const auto comp = parametric("H(CH2)nOH");
+
+  ASSERT_EQ(comp.parameters().size(), 1u);
+  EXPECT_EQ(comp.parameters()[0], "n");
+  EXPECT_EQ(comp.constant(), concrete("H2O"));
+  EXPECT_EQ(comp.coefficient(0), concrete("CH2"));
+  EXPECT_EQ(comp.parameterIndex("n"), 0u);
+  EXPECT_FALSE(comp.parameterIndex("m").has_value());
+  EXPECT_THROW((void)comp.coefficient(1), std::out_of_range);
+}
+
+TEST(ParametricTest, MatchesConcreteFormulas) {
+  const auto polymer = parametric("(C2H4)n");
+  const auto complex = parametric("K4[Fe(CN)6]x*yH2O");
+
+  for (uint64_t val = 0; val < 5; val++) {
+    const auto num = std::to_string(val + 1);
+    const std::vector<uint64_t> one{val + 1};
+    const std::vector<uint64_t> two{val + 1, val + 2};
+
+    EXPECT_EQ(polymer.evaluate(one), concrete("(C2H4)" + num));
+    EXPECT_EQ(complex.evaluate(two), concrete("K4[Fe(CN)6]" + num + "*" + std::to_string(val + 2) + "H2O"));
+  }
+
+  EXPECT_EQ(std::vector(complex.parameters().begin(), complex.parameters().end()),
+            (std::vector<std::string>{"x", "y"}));
+}
+
+TEST(ParametricTest, RepeatedParameterSharesATerm) {
+  const auto comp = parametric("(CH2)n(O)n");
+
+  ASSERT_EQ(comp.parameters().size(), 1u);
+  EXPECT_EQ(comp.coefficient(0), concrete("CH2O"));
+
+  // a numeric multiplier outside a parameter stays linear
+  EXPECT_EQ(parametric("((CH2)n)2").coefficient(0), concrete("C2H4"));
+}
+
+TEST(ParametricTest, EvaluatesArraysOfValues) {
+  const auto comp = parametric("H(CH2)nOH");
+
+  // columns: H, C, O
+  ASSERT_EQ(std::vector(comp.elements().begin(), comp.elements().end()), (std::vector<cfp::ElementId>{1, 6, 8}));
+
+  std::vector<uint64_t> values(1000);
+  for (size_t idx = 0; idx < values.size(); idx++) {
+    values[idx] = idx;
+  }
+
+  std::vector<uint64_t> out(values.size() * 3);
+  comp.evaluate(values, out);
+
+  for (size_t row = 0; row < values.size(); row++) {
+    EXPECT_EQ(out[(row * 3) + 0], (2 * row) + 2);
+    EXPECT_EQ(out[(row * 3) + 1], row);
+    EXPECT_EQ(out[(row * 3) + 2], 1u);
+  }
+
+  EXPECT_THROW(comp.evaluate(values, std::span<uint64_t>{out}.first(5)), std::invalid_argument);
+  EXPECT_THROW((void)comp.evaluate(std::vector<uint64_t>{1, 2}), std::invalid_argument);
+}
+
+TEST(ParametricTest, ChecksOverflowOnlyWhenNeeded) {
+  const auto comp = parametric("(C2)n");
+  const std::vector<uint64_t> values{1, std::numeric_limits<uint64_t>::max() / 2};
+  std::vector<uint64_t> out(2);
+
+  EXPECT_NO_THROW(comp.evaluate(values, out));
+  EXPECT_EQ(out[1], std::numeric_limits<uint64_t>::max() - 1);
+
+  const std::vector<uint64_t> too_big{std::numeric_limits<uint64_t>::max()};
+  out.resize(1);
+  EXPECT_THROW(comp.evaluate(too_big, out), cfp::OverflowError);
+}
+
+TEST(ParametricTest, RejectsNonLinearAndMisplacedParameters) {
+  EXPECT_THROW(parametric("((CH2)n)m"), cfp::ParserError);
+  EXPECT_THROW(parametric("((CH2)n)n"), cfp::ParserError);
+  EXPECT_THROW(parametric("n(CH2)m"), cfp::ParserError);
+  EXPECT_THROW(parametric("H2n"), cfp::ParserError);   // element counts are numeric
+  EXPECT_THROW(parametric("(CH2)nXx"), cfp::ParserError);
+
+  // numeric entry points of the parametric grammar refuse parameters
+  cfp::ParametricParser parser{"(C2H4)n"};
+  EXPECT_THROW(parser.parseComposition(), cfp::ParserError);
+  EXPECT_EQ(cfp::ParametricParser{"(C2H4)2"}.parseComposition(), concrete("C4H8"));
+
+  // the default grammar still rejects lowercase lexemes
+  EXPECT_THROW(concrete("(C2H4)n"), cfp::TokenizerError);
+}
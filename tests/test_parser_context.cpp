@@ -0,0 +1,105 @@
+// tests/test_parser_context.cpp
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "cfp/error/parser_error.hpp"
+#include "cfp/error/tokenizer_error.hpp"
+#include "cfp/parser.hpp"
+#include "cfp/parser_context.hpp"
+
+static cfp::Composition compose(std::string_view formula) {
+  cfp::Parser parser{formula};
+  return parser.parseComposition();
+}
+
+// Same results as the AST parser
+class ParserContextValidTest : public ::testing::TestWithParam<std::string_view> {};
+
+TEST_P(ParserContextValidTest, MatchesParser) {
+  cfp::ParserContext ctx;
+  EXPECT_EQ(ctx.parse(GetParam()), compose(GetParam()));
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+  Valid,
+  ParserContextValidTest,
+  ::testing::Values("H", "C12H22O11", "((H)2)3", "Fe2(SO4)3", "K4[Fe(CN)6]", "[Co(NH3)5Cl]Cl2",
+                    "CuSO4*5H2O", "2H2O*3(NaCl)2*Og")
+);
+// clang-format on
+
+// Same errors as the AST parser
+class ParserContextInvalidTest : public ::testing::TestWithParam<std::string_view> {};
+
+TEST_P(ParserContextInvalidTest, MatchesParserError) {
+  std::string expected;
+
+  try {
+    compose(GetParam());
+  } catch (const std::exception &err) {
+    expected = err.what();
+  }
+
+  cfp::ParserContext ctx;
+
+  try {
+    ctx.parse(GetParam());
+    FAIL() << "expected an error for " << GetParam();
+  } catch (const cfp::ParserError &err) {
+    EXPECT_EQ(err.what(), expected);
+  } catch (const cfp::TokenizerError &err) {
+    EXPECT_EQ(err.what(), expected);
+  }
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+  Invalid,
+  ParserContextInvalidTest,
+  ::testing::Values("", "H2O)", "(H2O", "(H2O]", "()", "H*", "*H", "5", "5*H", "(H*O)", "H2 O", "H0", "Xx2Yy",
+                    "HXx(Yy)", "C18446744073709551615C2Xx", "(C18446744073709551615)2*Xx")
+);
+// clang-format on
+
+TEST(ParserContextTest, ReusesAcrossCalls) {
+  cfp::ParserContext ctx;
+
+  EXPECT_EQ(ctx.parse("K4[Fe(CN)6]"), compose("K4[Fe(CN)6]"));
+  EXPECT_EQ(ctx.parse("H2O"), compose("H2O"));  // no leftovers from the previous call
+  EXPECT_EQ(ctx.tokens().size(), 3u);
+
+  EXPECT_THROW(ctx.parse("H2O)"), cfp::ParserError);
+  EXPECT_EQ(ctx.parse("NaCl"), compose("NaCl"));
+
+  ctx.reset();
+  EXPECT_TRUE(ctx.result().empty());
+  EXPECT_TRUE(ctx.tokens().empty());
+}
+
+TEST(ParserContextTest, FailureClearsResult) {
+  cfp::ParserContext ctx;
+
+  for (const std::string_view input : {"C18446744073709551615C2", "H2Xx", "H2O)"}) {
+    ctx.parse("H2O");
+    EXPECT_ANY_THROW(ctx.parse(input)) << input;
+    EXPECT_TRUE(ctx.result().empty()) << input;
+  }
+}
+
+TEST(ParserContextTest, OnePerThread) {
+  const auto *main_ctx = &cfp::ParserContext::forThread();
+  const cfp::ParserContext *other_ctx = nullptr;
+
+  std::thread{[&] {
+    other_ctx = &cfp::ParserContext::forThread();
+    EXPECT_EQ(cfp::ParserContext::forThread().parse("CH4"), compose("CH4"));
+  }}.join();
+
+  EXPECT_NE(main_ctx, other_ctx);
+  EXPECT_EQ(main_ctx, &cfp::ParserContext::forThread());
+}
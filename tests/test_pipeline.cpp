@@ -0,0 +1,236 @@
+// tests/test_pipeline.cpp
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <ranges>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "cfp/error/limit_error.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/error/tokenizer_error.hpp"
+#include "cfp/generator.hpp"
+#include "cfp/parser.hpp"
+#include "cfp/pipeline.hpp"
+
+namespace {
+
+constexpr std::string_view SAMPLES[] = {"H2O", "Fe2(SO4)3", "K4[Fe(CN)6]*3H2O", "C6H12O6", "NaCl", "[Co(NH3)5Cl]Cl2"};
+
+/// Small stages so that many batches and chunks are in flight.
+constexpr cfp::PipelineOptions SMALL{.chunk_size = 7, .batch_size = 16, .queue_capacity = 2, .threads = 4};
+
+cfp::Generator<int> count_to(int limit) {
+  for (int value = 0; value < limit; value++) {
+    co_yield value;
+  }
+}
+
+cfp::Generator<int> fail_after(int limit) {
+  for (int value = 0; value < limit; value++) {
+    co_yield value;
+  }
+  throw std::runtime_error{"source failed"};
+}
+
+std::string lines(size_t count) {
+  std::string text;
+
+  for (size_t line = 0; line < count; line++) {
+    text += SAMPLES[line % std::size(SAMPLES)];
+    text += '\n';
+  }
+
+  return text;
+}
+
+}  // namespace
+
+TEST(GeneratorTest, YieldsLazilyInOrder) {
+  std::vector<int> values;
+
+  for (const int value : count_to(5)) {
+    values.push_back(value);
+  }
+
+  EXPECT_EQ(values, (std::vector<int>{0, 1, 2, 3, 4}));
+  EXPECT_TRUE(count_to(0).begin() == std::default_sentinel);
+
+  static_assert(std::ranges::input_range<cfp::Generator<int>>);
+}
+
+TEST(GeneratorTest, RethrowsAfterValues) {
+  std::vector<int> values;
+
+  EXPECT_THROW(
+      {
+        for (const int value : fail_after(3)) {
+          values.push_back(value);
+        }
+      },
+      std::runtime_error);
+
+  EXPECT_EQ(values, (std::vector<int>{0, 1, 2}));
+}
+
+TEST(PipelineTest, LinesMatchParserInOrder) {
+  constexpr size_t COUNT = 5000;
+  std::istringstream input{lines(COUNT)};
+
+  size_t index = 0;
+
+  for (const auto &result : cfp::parse_lines(input, SMALL)) {
+    ASSERT_EQ(result.index, index);
+    ASSERT_TRUE(result.ok());
+
+    const auto expected = SAMPLES[index % std::size(SAMPLES)];
+    EXPECT_EQ(result.formula, expected);
+    EXPECT_EQ(result.composition.toDense(), cfp::Parser{expected}.parseComposition());
+    index += 1;
+  }
+
+  EXPECT_EQ(index, COUNT);
+}
+
+TEST(PipelineTest, ReportsErrorsPerLine) {
+  std::istringstream input{"H2O\r\nFe2(SO4\n\nNaCl\nXx2\nCO2"};
+  std::vector<cfp::ParsedFormula> results;
+
+  for (auto &result : cfp::parse_lines(input)) {
+    results.push_back(std::move(result));
+  }
+
+  ASSERT_EQ(results.size(), 6u);
+
+  EXPECT_EQ(results[0].formula, "H2O");
+  EXPECT_TRUE(results[0].ok());
+  EXPECT_THROW((void)results[1].value(), cfp::ParserError);
+  EXPECT_THROW((void)results[2].value(), cfp::TokenizerError);
+  EXPECT_TRUE(results[3].ok());
+  EXPECT_FALSE(results[4].ok());
+  EXPECT_EQ(results[5].value().toDense(), cfp::Parser{"CO2"}.parseComposition());
+
+  // no record after a final newline
+  std::istringstream terminated{"H2O\nCO2\n"};
+  size_t count = 0;
+
+  for (const auto &result : cfp::parse_lines(terminated)) {
+    EXPECT_TRUE(result.ok());
+    count += 1;
+  }
+
+  EXPECT_EQ(count, 2u);
+}
+
+TEST(PipelineTest, ParsesRanges) {
+  const std::vector<std::string> formulas{"H2O", "CO2", "(NH4)2SO4"};
+
+  std::vector<std::string> seen;
+
+  for (const auto &result : cfp::parse_each(formulas, SMALL)) {
+    seen.push_back(result.formula);
+  }
+
+  EXPECT_EQ(seen, formulas);
+
+  // an rvalue container is moved into the pipeline
+  size_t count = 0;
+
+  for (const auto &result : cfp::parse_each(std::vector<std::string>(1000, "C2H5OH"), SMALL)) {
+    EXPECT_EQ(result.index, count++);
+    EXPECT_EQ(result.composition[cfp::element_id("C")], 2u);
+  }
+
+  EXPECT_EQ(count, 1000u);
+
+  // lazy views are iterated on the reader thread
+  auto chains =
+      std::views::iota(1, 201) | std::views::transform([](int n) { return "C" + std::to_string(n) + "H4"; });
+  count = 0;
+
+  for (const auto &result : cfp::parse_each(chains, SMALL)) {
+    EXPECT_EQ(result.composition[cfp::element_id("C")], ++count);
+  }
+
+  EXPECT_EQ(count, 200u);
+}
+
+TEST(PipelineTest, SourceFailureEndsAfterCompletedLines) {
+  int pulls = 0;
+  const auto pull = [&pulls]() -> std::string_view {
+    if (pulls++ == 3) {
+      throw std::runtime_error{"connection reset"};
+    }
+    return "H2O\nCO";  // the last line is cut off by the failure
+  };
+
+  std::vector<std::string> seen;
+
+  EXPECT_THROW(
+      {
+        for (const auto &result : cfp::parse_lines(pull, SMALL)) {
+          seen.push_back(result.formula);
+        }
+      },
+      std::runtime_error);
+
+  EXPECT_EQ(seen, (std::vector<std::string>{"H2O", "COH2O", "COH2O"}));
+}
+
+TEST(PipelineTest, BackpressureBoundsReadAhead) {
+  std::atomic<size_t> pulls{0};
+  const auto endless = [&pulls]() -> std::string_view {
+    pulls++;
+    return "H2O\n";
+  };
+
+  {
+    auto results = cfp::parse_lines(endless, SMALL);
+    auto it = results.begin();
+
+    for (int step = 0; step < 100; step++) {
+      ASSERT_TRUE(it != std::default_sentinel);
+      EXPECT_TRUE((*it).ok());
+      ++it;
+    }
+
+    // let every stage run ahead as far as its queues allow
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+  }  // stops the stages
+
+  // chunks + splitter + batches + workers + reorder window + consumer, with room to spare
+  EXPECT_LT(pulls.load(), 400u);
+}
+
+TEST(PipelineTest, OverlongLinesFailTheirLengthLimit) {
+  cfp::PipelineOptions options = SMALL;
+  options.limits.max_length = 8;
+
+  std::istringstream input{"H2O\n" + std::string(100'000, 'C') + "\nCO2\n"};
+  std::vector<cfp::ParsedFormula> results;
+
+  for (auto &result : cfp::parse_lines(input, options)) {
+    results.push_back(std::move(result));
+  }
+
+  ASSERT_EQ(results.size(), 3u);
+  EXPECT_TRUE(results[0].ok());
+  EXPECT_EQ(results[1].formula.size(), 9u);  // only one byte beyond the limit is kept
+  EXPECT_THROW((void)results[1].value(), cfp::LimitError);
+  EXPECT_TRUE(results[2].ok());
+}
+
+TEST(PipelineTest, RejectsInvalidOptions) {
+  std::istringstream input{"H2O"};
+
+  EXPECT_THROW((void)cfp::parse_lines(input, {.batch_size = 0}), std::invalid_argument);
+  EXPECT_THROW((void)cfp::parse_lines(input, {.queue_capacity = 0}), std::invalid_argument);
+  EXPECT_THROW((void)cfp::parse_each(std::function<bool(std::string &)>{}), std::invalid_argument);
+}
@@ -0,0 +1,123 @@
+// tests/test_program.cpp
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "cfp/error/overflow_error.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/parser.hpp"
+#include "cfp/program.hpp"
+
+class ProgramTest : public ::testing::TestWithParam<std::string_view> {};
+
+TEST_P(ProgramTest, EvaluatesLikeTheParser) {
+  const auto program = cfp::FormulaProgram::compile(GetParam());
+  const auto comp = cfp::Parser{GetParam()}.parseComposition();
+
+  EXPECT_EQ(program.evaluate(), comp);
+  EXPECT_EQ(program.evaluate(37), comp * 37);
+  EXPECT_TRUE(program.evaluate(0).empty());
+}
+
+TEST_P(ProgramTest, RoundTripsThroughBytes) {
+  const auto program = cfp::FormulaProgram::compile(GetParam());
+  const auto bytes = program.serialize();
+
+  EXPECT_EQ(bytes.size(), 9 + (9 * program.size()));
+  EXPECT_EQ(cfp::FormulaProgram::deserialize(bytes), program);
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+  Formulas,
+  ProgramTest,
+  ::testing::Values("H2O", "Fe2(SO4)3", "K4[Fe(CN)6]*3H2O", "((CH2)10)100", "[Co(NH3)5Cl]Cl2")
+);
+// clang-format on
+
+TEST(ProgramTest, FoldsNestedMultipliers) {
+  const auto program = cfp::FormulaProgram::compile("K4[Fe(CN)6]*3H2O");
+
+  // ascending element ID: H, C, N, O, K, Fe
+  EXPECT_EQ(std::vector(program.elements().begin(), program.elements().end()),
+            (std::vector<cfp::ElementId>{1, 6, 7, 8, 19, 26}));
+  EXPECT_EQ(std::vector(program.counts().begin(), program.counts().end()),
+            (std::vector<uint64_t>{6, 6, 6, 3, 4, 1}));
+}
+
+TEST(ProgramTest, ScalesIntoFlatBuffers) {
+  const auto program = cfp::FormulaProgram::compile("Fe2(SO4)3");
+
+  std::vector<uint64_t> counts(program.size());
+  program.evaluate(uint64_t{250}, counts);
+  EXPECT_EQ(counts, (std::vector<uint64_t>{3000, 750, 500}));
+
+  std::vector<double> amounts(program.size());
+  program.evaluate(0.5, amounts);
+  EXPECT_EQ(amounts, (std::vector<double>{6.0, 1.5, 1.0}));
+}
+
+TEST(ProgramTest, RejectsShortOutput) {
+  const auto program = cfp::FormulaProgram::compile("Fe2(SO4)3");
+
+  std::vector<uint64_t> counts(program.size() - 1, 7);
+  EXPECT_THROW(program.evaluate(uint64_t{2}, counts), std::invalid_argument);
+  EXPECT_EQ(counts, (std::vector<uint64_t>{7, 7}));  // untouched
+
+  std::vector<double> amounts(program.size() - 1);
+  EXPECT_THROW(program.evaluate(0.5, amounts), std::invalid_argument);
+  EXPECT_THROW(program.evaluate(0.5, std::span<double>{}), std::invalid_argument);
+}
+
+TEST(ProgramTest, ChecksScaleOverflow) {
+  const auto program = cfp::FormulaProgram::compile("C3H8");
+  std::vector<uint64_t> counts(program.size(), 7);
+
+  EXPECT_THROW((void)program.evaluate(std::numeric_limits<uint64_t>::max() / 4), cfp::OverflowError);
+  EXPECT_THROW(program.evaluate(std::numeric_limits<uint64_t>::max() / 4, counts), cfp::OverflowError);
+  EXPECT_EQ(counts, (std::vector<uint64_t>{7, 7}));  // untouched
+  EXPECT_NO_THROW((void)program.evaluate(std::numeric_limits<uint64_t>::max() / 8));
+
+  EXPECT_THROW(cfp::FormulaProgram::compile("H2Xx"), cfp::ParserError);
+}
+
+TEST(ProgramTest, RejectsMalformedBytes) {
+  auto bytes = cfp::FormulaProgram::compile("H2O").serialize();
+
+  const auto rejects = [](std::vector<uint8_t> data) {
+    EXPECT_THROW(cfp::FormulaProgram::deserialize(data), std::invalid_argument);
+  };
+
+  rejects({});
+  rejects({bytes.begin(), bytes.end() - 1});  // truncated
+
+  auto bad = bytes;
+  bad[0] = 'X';  // magic
+  rejects(bad);
+
+  bad = bytes;
+  bad[4] = 2;  // version
+  rejects(bad);
+
+  bad = bytes;
+  bad[9 + 9] = 1;  // second ID repeats the first
+  rejects(bad);
+
+  bad = bytes;
+  bad[9] = 200;  // unknown element
+  rejects(bad);
+
+  bad = bytes;
+  for (size_t idx = 10; idx < 18; idx++) {
+    bad[idx] = 0;  // zero count
+  }
+  rejects(bad);
+
+  EXPECT_TRUE(cfp::FormulaProgram::deserialize(cfp::FormulaProgram{}.serialize()).evaluate().empty());
+}
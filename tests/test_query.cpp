@@ -0,0 +1,99 @@
+// tests/test_query.cpp
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "cfp/error/parser_error.hpp"
+#include "cfp/error/tokenizer_error.hpp"
+#include "cfp/parser.hpp"
+#include "cfp/query.hpp"
+
+static const cfp::ElementId CL = cfp::element_id("Cl");
+static const cfp::ElementId BR = cfp::element_id("Br");
+
+// count_of agrees with full evaluation for every element
+class CountOfTest : public ::testing::TestWithParam<std::string_view> {};
+
+TEST_P(CountOfTest, MatchesParser) {
+  cfp::Parser parser{GetParam()};
+  const auto comp = parser.parseComposition();
+
+  for (cfp::ElementId id = 1; id <= cfp::ELEMENT_COUNT; id++) {
+    EXPECT_EQ(cfp::count_of(GetParam(), id), comp[id]) << cfp::element_symbol(id);
+  }
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+  Formulas,
+  CountOfTest,
+  ::testing::Values("H2O", "Fe2(SO4)3", "K4[Fe(CN)6]", "((H)2)3", "CuSO4*5H2O", "2H2O*3(NaCl)2", "[Co(NH3)5Cl]Cl2")
+);
+// clang-format on
+
+TEST(CountOfTest, BySymbol) {
+  EXPECT_EQ(cfp::count_of("Fe2(SO4)3", "O"), 12u);
+  EXPECT_EQ(cfp::count_of("Fe2(SO4)3", "Cl"), 0u);
+  EXPECT_THROW(cfp::count_of("H2O", "Xx"), std::invalid_argument);
+}
+
+TEST(CountOfTest, RejectsMalformedInput) {
+  EXPECT_THROW(cfp::count_of("Fe2(SO4", "O"), cfp::ParserError);
+  EXPECT_THROW(cfp::count_of("Fe2(SO4]", "O"), cfp::ParserError);
+  EXPECT_THROW(cfp::count_of("H2O)", "O"), cfp::ParserError);
+  EXPECT_THROW(cfp::count_of("(H*O)", "O"), cfp::ParserError);
+  EXPECT_THROW(cfp::count_of("H2 O", "O"), cfp::TokenizerError);
+  EXPECT_THROW(cfp::count_of("", "O"), cfp::TokenizerError);
+}
+
+// count_of rejects exactly the grammar errors the parser rejects
+class CountOfGrammarTest : public ::testing::TestWithParam<std::string_view> {};
+
+TEST_P(CountOfGrammarTest, RejectsLikeParser) {
+  EXPECT_THROW((void)cfp::Parser{GetParam()}.parse(), cfp::ParserError);
+  EXPECT_THROW((void)cfp::count_of(GetParam(), cfp::element_id("H")), cfp::ParserError);
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+  Malformed,
+  CountOfGrammarTest,
+  ::testing::Values("()", "H2O*", "*H2O", "2", "2*", "H2O**H2O", "H2()O", "([])", "2*H2O", "(H)2[]")
+);
+// clang-format on
+
+TEST(CountOfGrammarTest, ReportsParserMessage) {
+  for (const std::string_view input : {"H2()O", "2*", "H2O**H2O"}) {
+    std::string expected;
+    try {
+      (void)cfp::Parser{input}.parse();
+    } catch (const cfp::ParserError &error) {
+      expected = error.what();
+    }
+
+    try {
+      (void)cfp::count_of(input, cfp::element_id("H"));
+      ADD_FAILURE() << input;
+    } catch (const cfp::ParserError &error) {
+      EXPECT_EQ(error.what(), expected) << input;
+    }
+  }
+}
+
+TEST(ContainsAnyTest, FindsAnyRequestedElement) {
+  EXPECT_TRUE(cfp::contains_any("CH2Cl2", {CL, BR}));
+  EXPECT_TRUE(cfp::contains_any("C6H5Br", {CL, BR}));
+  EXPECT_TRUE(cfp::contains_any("[Co(NH3)5Cl]", {CL}));
+  EXPECT_FALSE(cfp::contains_any("C6H12O6", {CL, BR}));
+  EXPECT_FALSE(cfp::contains_any("C", {}));
+  EXPECT_FALSE(cfp::contains_any("C", {0}));
+}
+
+TEST(ContainsAnyTest, ExitsAtFirstMatch) {
+  // the invalid tail is never lexed once Cl has been seen
+  EXPECT_TRUE(cfp::contains_any("Cl2 $$$", {CL}));
+  EXPECT_THROW(cfp::contains_any("C2 $$$", {CL}), cfp::TokenizerError);
+}
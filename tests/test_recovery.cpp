@@ -0,0 +1,140 @@
+// tests/test_recovery.cpp
+
+#include <gtest/gtest.h>
+
+#include <string_view>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/error/limit_error.hpp"
+#include "cfp/grammar.hpp"
+#include "cfp/parser.hpp"
+#include "cfp/recovery.hpp"
+
+using Kind = cfp::DiagnosticKind;
+
+static cfp::Composition compose(std::string_view formula) {
+  cfp::Parser parser{formula};
+  return parser.parseComposition();
+}
+
+static std::vector<Kind> kinds(const cfp::DiagnosticSink &sink) {
+  std::vector<Kind> result;
+
+  for (const auto &diagnostic : sink) {
+    result.push_back(diagnostic.kind);
+  }
+  return result;
+}
+
+// Valid input: same result as the regular parser, no diagnostics
+class RecoveryValidTest : public ::testing::TestWithParam<std::string_view> {};
+
+TEST_P(RecoveryValidTest, MatchesParser) {
+  cfp::DiagnosticSink sink;
+  const auto comp = cfp::parse_recovering(GetParam(), sink);
+
+  EXPECT_TRUE(sink.empty());
+  EXPECT_EQ(comp, compose(GetParam()));
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+  Valid,
+  RecoveryValidTest,
+  ::testing::Values("H2O", "Fe2(SO4)3", "K4[Fe(CN)6]", "CuSO4*5H2O", "2H2O*3NaCl")
+);
+// clang-format on
+
+// Invalid input: every problem reported, best-effort composition
+class RecoveryInvalidTest
+    : public ::testing::TestWithParam<std::tuple<std::string_view, std::vector<Kind>, std::string_view>> {};
+
+TEST_P(RecoveryInvalidTest, ReportsAllProblems) {
+  const auto &[input, expected_kinds, expected_formula] = GetParam();
+
+  cfp::DiagnosticSink sink;
+  const auto comp = cfp::parse_recovering(input, sink);
+
+  EXPECT_EQ(kinds(sink), expected_kinds);
+  EXPECT_EQ(comp, expected_formula.empty() ? cfp::Composition{} : compose(expected_formula));
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+  Invalid,
+  RecoveryInvalidTest,
+  ::testing::Values(
+    std::make_tuple("Fe2(SO4*3 cl",   std::vector{Kind::UnclosedGroup, Kind::Whitespace, Kind::UnexpectedCharacter,
+                                                  Kind::EmptyUnit},                                  "Fe2SO4"),
+    std::make_tuple("H2$$O",          std::vector{Kind::UnexpectedCharacter},                         "H2O"),
+    std::make_tuple("H2O)",           std::vector{Kind::UnmatchedCloser},                             "H2O"),
+    std::make_tuple("K[Fe(CN)6)",     std::vector{Kind::UnclosedGroup, Kind::UnmatchedCloser},       "KFeC6N6"),
+    std::make_tuple("[Fe(CN)6]Xx2O",  std::vector{Kind::UnknownElement},                             "FeC6N6O"),
+    std::make_tuple("H02O0",          std::vector{Kind::InvalidNumber, Kind::InvalidNumber},          "H2"),
+    std::make_tuple("H99999999999999999999", std::vector{Kind::CountOverflow},                       "H"),
+    std::make_tuple("()H2O",          std::vector{Kind::EmptyGroup},                                  "H2O"),
+    std::make_tuple("*H2O**NaCl",     std::vector{Kind::EmptyUnit, Kind::EmptyUnit},                 "H2ONaCl"),
+    std::make_tuple("H2 3O",          std::vector{Kind::Whitespace, Kind::UnexpectedToken},           "H2O"),
+    std::make_tuple("",               std::vector{Kind::EmptyUnit},                                   "")
+  )
+);
+// clang-format on
+
+TEST(RecoveryTest, ReportsOffsetsInInputOrder) {
+  cfp::DiagnosticSink sink;
+  cfp::parse_recovering("Fe2(SO4*3 cl", sink);
+
+  ASSERT_EQ(sink.size(), 4u);
+  EXPECT_EQ(sink[0].offset, 3u);  // '('
+  EXPECT_EQ(sink[1].offset, 9u);  // ' '
+  EXPECT_EQ(sink[2].offset, 10u);  // 'c'
+  EXPECT_EQ(sink[3].offset, 12u);  // end of input
+  EXPECT_EQ(sink[2].message, "unexpected character 'c'");
+}
+
+TEST(RecoveryTest, AppendsToExistingSink) {
+  cfp::DiagnosticSink sink;
+  cfp::parse_recovering("H2O)", sink);
+  cfp::parse_recovering("(H2O", sink);
+
+  EXPECT_EQ(kinds(sink), (std::vector{Kind::UnmatchedCloser, Kind::UnclosedGroup}));
+}
+
+TEST(RecoveryTest, OverflowingUnitLeavesTotal) {
+  cfp::DiagnosticSink sink;
+  const auto comp = cfp::parse_recovering("C18446744073709551615*C2*H", sink);
+
+  EXPECT_EQ(kinds(sink), (std::vector{Kind::CountOverflow}));
+  EXPECT_EQ(sink[0].offset, 23u);  // the count of "C2"
+  EXPECT_EQ(comp.count("C"), 18446744073709551615u);
+  EXPECT_EQ(comp.count("H"), 1u);
+}
+
+TEST(RecoveryTest, EnforcesLimits) {
+  cfp::DiagnosticSink sink;
+
+  EXPECT_THROW((void)cfp::parse_recovering("((((H))))", sink, {.max_depth = 2}), cfp::LimitError);
+  EXPECT_THROW((void)cfp::parse_recovering("H*H*H", sink, {.max_units = 2}), cfp::LimitError);
+  EXPECT_THROW((void)cfp::parse_recovering("H$O$N$C", sink, {.max_tokens = 4}), cfp::LimitError);
+}
+
+TEST(RecoveryTest, FollowsGrammarPolicy) {
+  // groups are not part of the flat grammar, so their characters are unexpected
+  cfp::DiagnosticSink sink;
+  const auto comp = cfp::BasicParser<cfp::FlatGrammar, true>{"(H2O)2", sink}.parseComposition();
+
+  EXPECT_EQ(kinds(sink), (std::vector{Kind::UnexpectedCharacter, Kind::UnexpectedCharacter}));
+  EXPECT_EQ(comp, compose("H2O"));
+
+  // strict elements are reported once, by the tokenizer
+  sink.clear();
+  (void)cfp::BasicParser<cfp::StrictGrammar, true>{"Xx2O", sink}.parseComposition();
+
+  EXPECT_EQ(kinds(sink), (std::vector{Kind::UnknownElement}));
+}
+
+TEST(RecoveryTest, DiagnosticKindNames) {
+  EXPECT_EQ(cfp::to_string(Kind::UnclosedGroup), "UnclosedGroup");
+  EXPECT_EQ(cfp::to_string(Kind::Whitespace), "Whitespace");
+}
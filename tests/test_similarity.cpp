@@ -0,0 +1,239 @@
+// tests/test_similarity.cpp
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/error/parser_error.hpp"
+#include "cfp/parser.hpp"
+#include "cfp/similarity.hpp"
+
+namespace {
+
+using cfp::SimilarityMetric;
+
+constexpr SimilarityMetric METRICS[] = {SimilarityMetric::Tanimoto, SimilarityMetric::Cosine,
+                                        SimilarityMetric::MassDistance};
+
+cfp::Composition parse(std::string_view formula) {
+  return cfp::Parser{formula}.parseComposition();
+}
+
+/// Deterministic corpus: a few of 12 common elements per record, small counts.
+std::vector<cfp::Composition> corpus(size_t records) {
+  constexpr cfp::ElementId ELEMENTS[] = {1, 6, 7, 8, 9, 11, 15, 16, 17, 19, 26, 35};
+  uint64_t state = 0x2545f4914f6cdd1d;
+
+  const auto next = [&state] {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  };
+
+  std::vector<cfp::Composition> result(records);
+
+  for (auto &comp : result) {
+    const uint64_t kinds = 1 + (next() % 5);
+
+    for (uint64_t kind = 0; kind < kinds; kind++) {
+      comp.add(ELEMENTS[next() % std::size(ELEMENTS)], 1 + (next() % 30));
+    }
+  }
+
+  return result;
+}
+
+/// Best score of the exact k nearest neighbors, by brute force.
+std::vector<double> brute_force(const std::vector<cfp::Composition> &records, const cfp::Composition &query, size_t k,
+                                SimilarityMetric metric) {
+  std::vector<double> scores;
+
+  for (const auto &record : records) {
+    const double score = cfp::similarity(query, record, metric);
+
+    if (metric == SimilarityMetric::MassDistance || score > 0.0) {
+      scores.push_back(score);
+    }
+  }
+
+  if (metric == SimilarityMetric::MassDistance) {
+    std::sort(scores.begin(), scores.end());
+  } else {
+    std::sort(scores.rbegin(), scores.rend());
+  }
+
+  scores.resize(std::min(k, scores.size()));
+  return scores;
+}
+
+double tolerance(double score) {
+  return 1e-4 * std::max(1.0, std::abs(score));
+}
+
+}  // namespace
+
+TEST(SimilarityTest, ReferenceScores) {
+  const auto water = parse("H2O");
+  const auto peroxide = parse("H2O2");
+
+  EXPECT_DOUBLE_EQ(cfp::similarity(water, water, SimilarityMetric::Tanimoto), 1.0);
+  EXPECT_DOUBLE_EQ(cfp::similarity(water, water, SimilarityMetric::Cosine), 1.0);
+  EXPECT_DOUBLE_EQ(cfp::similarity(water, water, SimilarityMetric::MassDistance), 0.0);
+
+  // a = (2, 1), b = (2, 2): a.b = 6, |a|^2 = 5, |b|^2 = 8
+  EXPECT_DOUBLE_EQ(cfp::similarity(water, peroxide, SimilarityMetric::Tanimoto), 6.0 / 7.0);
+  EXPECT_DOUBLE_EQ(cfp::similarity(water, peroxide, SimilarityMetric::Cosine), 6.0 / std::sqrt(40.0));
+  EXPECT_NEAR(cfp::similarity(water, peroxide, SimilarityMetric::MassDistance), 15.999, 1e-2);
+
+  EXPECT_EQ(cfp::similarity(water, parse("NaCl"), SimilarityMetric::Tanimoto), 0.0);
+  EXPECT_EQ(cfp::similarity(water, cfp::Composition{}, SimilarityMetric::Cosine), 0.0);
+}
+
+TEST(SimilarityIndexTest, FindsExactMatchFirst) {
+  const std::vector<std::string_view> formulas{"C6H12O6", "H2O", "NaCl", "C2H6O", "H2O2", "CH4"};
+  const auto index = cfp::SimilarityIndex::build(formulas);
+
+  ASSERT_EQ(index.size(), formulas.size());
+  EXPECT_EQ(index.shift(0), 0u);
+
+  const auto nearest = index.search("H2O", 2, SimilarityMetric::Tanimoto);
+  ASSERT_EQ(nearest.size(), 2u);
+  EXPECT_EQ(nearest[0].record, 1u);
+  EXPECT_NEAR(nearest[0].score, 1.0, 1e-6);
+  EXPECT_EQ(nearest[1].record, 4u);
+
+  const auto closest = index.search("H2O", 1, SimilarityMetric::MassDistance);
+  ASSERT_EQ(closest.size(), 1u);
+  EXPECT_EQ(closest[0].record, 1u);
+  EXPECT_NEAR(closest[0].score, 0.0, 1e-6);
+
+  // only records sharing an element have a positive similarity
+  EXPECT_EQ(index.search("NaF", 10, SimilarityMetric::Cosine).size(), 1u);
+}
+
+TEST(SimilarityIndexTest, MatchesBruteForce) {
+  const auto records = corpus(5000);
+  const auto queries = corpus(40);
+  const cfp::SimilarityIndex index{records};
+
+  for (const auto metric : METRICS) {
+    for (const auto &query : queries) {
+      const auto expected = brute_force(records, query, 10, metric);
+      const auto found = index.search(query, 10, metric, 4);
+
+      ASSERT_EQ(found.size(), expected.size());
+
+      for (size_t rank = 0; rank < found.size(); rank++) {
+        EXPECT_NEAR(found[rank].score, expected[rank], tolerance(expected[rank]));
+        EXPECT_NEAR(found[rank].score, cfp::similarity(query, records[found[rank].record], metric),
+                    tolerance(found[rank].score));
+      }
+    }
+  }
+}
+
+TEST(SimilarityIndexTest, ThreadCountDoesNotChangeResults) {
+  const auto records = corpus(20000);
+  const cfp::SimilarityIndex index{records};
+  const auto query = parse("C8H10N4O2");
+
+  for (const auto metric : METRICS) {
+    EXPECT_EQ(index.search(query, 25, metric, 1), index.search(query, 25, metric, 4));
+  }
+}
+
+TEST(SimilarityIndexTest, BatchMatchesSingleQueries) {
+  const auto records = corpus(3000);
+  const auto queries = corpus(16);
+  const cfp::SimilarityIndex index{records};
+
+  const auto batch = index.searchBatch(queries, 5, SimilarityMetric::Cosine, 4);
+  ASSERT_EQ(batch.size(), queries.size());
+
+  for (size_t query = 0; query < queries.size(); query++) {
+    EXPECT_EQ(batch[query], index.search(queries[query], 5, SimilarityMetric::Cosine, 1));
+  }
+}
+
+TEST(SimilarityIndexTest, QuantizesLargeCounts) {
+  const std::vector<cfp::Composition> records{parse("C1000000H2000000"), parse("C100H200"), parse("C3H8")};
+  const cfp::SimilarityIndex index{records};
+
+  EXPECT_EQ(index.shift(0), 5u);  // 2,000,000 >> 5 fits in 16 bits
+  EXPECT_EQ(index.shift(1), 0u);
+  EXPECT_EQ(index.shift(2), 0u);
+  EXPECT_THROW((void)index.shift(3), std::out_of_range);
+  EXPECT_EQ(std::vector(index.elements().begin(), index.elements().end()), (std::vector<cfp::ElementId>{1, 6}));
+
+  // Tanimoto and Cosine are scale-free: C1000000H2000000 and C100H200 tie with the query
+  const auto nearest = index.search("CH2", 3, SimilarityMetric::Cosine);
+  ASSERT_EQ(nearest.size(), 3u);
+  EXPECT_NEAR(nearest[0].score, 1.0, 1e-4);
+  EXPECT_NEAR(nearest[1].score, 1.0, 1e-4);
+  EXPECT_EQ(nearest[2].record, 2u);
+
+  const auto distance = index.search(records[0], 1, SimilarityMetric::MassDistance);
+  ASSERT_EQ(distance.size(), 1u);
+  EXPECT_EQ(distance[0].record, 0u);
+  EXPECT_LT(distance[0].score, 1e-6 * cfp::similarity(records[0], {}, SimilarityMetric::MassDistance));
+}
+
+TEST(SimilarityIndexTest, LargeRecordLeavesSmallOnesExact) {
+  // a polymer record is quantized on its own; the small formulas around it are not
+  const std::vector<cfp::Composition> records{parse("H"),    parse("C200000"), parse("CH4"),
+                                              parse("H2O"),  parse("CH"),      parse("C200000H400002")};
+  const cfp::SimilarityIndex index{records};
+
+  EXPECT_EQ(index.shift(0), 0u);
+  EXPECT_EQ(index.shift(1), 2u);
+  EXPECT_EQ(index.shift(5), 3u);
+
+  for (const auto &query : {parse("H"), parse("CH"), parse("H2O"), parse("CH4")}) {
+    for (const auto metric : METRICS) {
+      const auto nearest = index.search(query, records.size(), metric);
+      const auto expected = brute_force(records, query, records.size(), metric);
+
+      ASSERT_EQ(nearest.size(), expected.size());
+
+      for (size_t rank = 0; rank < nearest.size(); rank++) {
+        EXPECT_NEAR(nearest[rank].score, expected[rank], tolerance(expected[rank]));
+
+        // small records score exactly, so each query finds itself with the best possible score
+        if (records[nearest[rank].record] == query) {
+          EXPECT_EQ(rank, 0u);
+          EXPECT_NEAR(nearest[rank].score, cfp::similarity(query, query, metric), 1e-6);
+        }
+      }
+    }
+  }
+}
+
+TEST(SimilarityIndexTest, EmptyInputs) {
+  const cfp::SimilarityIndex empty;
+  EXPECT_TRUE(empty.search("H2O", 5, SimilarityMetric::Tanimoto).empty());
+
+  const auto index = cfp::SimilarityIndex::build(std::vector<std::string_view>{"H2O", "CO2"});
+  EXPECT_TRUE(index.search("H2O", 0, SimilarityMetric::Tanimoto).empty());
+  EXPECT_TRUE(index.search(cfp::Composition{}, 5, SimilarityMetric::MassDistance).empty());
+  EXPECT_EQ(index.search("H2O", 5, SimilarityMetric::MassDistance).size(), 2u);
+}
+
+TEST(SimilarityIndexTest, ReportsFirstInvalidFormula) {
+  std::vector<std::string_view> rows(3000, "C2H6O");
+  rows[2500] = "C2(H6O";
+  rows[1500] = "C2H6)";
+
+  try {
+    (void)cfp::SimilarityIndex::build(rows, 4);
+    FAIL() << "expected ParserError";
+  } catch (const cfp::ParserError &err) {
+    EXPECT_EQ(err.token.text, ")");
+  }
+}
@@ -0,0 +1,161 @@
+// tests/test_stream_parser.cpp
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cfp/composition.hpp"
+#include "cfp/error/stream_error.hpp"
+#include "cfp/parser.hpp"
+#include "cfp/stream_parser.hpp"
+
+static cfp::Composition compose(std::string_view formula) {
+  cfp::Parser parser{formula};
+  return parser.parseComposition();
+}
+
+// Valid formulas: every chunking gives the parser's result
+class StreamValidTest : public ::testing::TestWithParam<std::string_view> {};
+
+TEST_P(StreamValidTest, AnySplitMatchesParser) {
+  const auto input = GetParam();
+  const auto expected = compose(input);
+
+  for (size_t split = 0; split <= input.size(); split++) {
+    const std::vector chunks{input.substr(0, split), input.substr(split)};
+    EXPECT_EQ(cfp::parse_stream(chunks), expected) << "split at " << split;
+  }
+}
+
+TEST_P(StreamValidTest, CharByCharMatchesParser) {
+  const auto input = GetParam();
+  cfp::StreamParser parser;
+
+  for (const char chr : input) {
+    parser.feed({&chr, 1});
+  }
+
+  EXPECT_EQ(parser.offset(), input.size());
+  EXPECT_EQ(parser.finish(), compose(input));
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+  Valid,
+  StreamValidTest,
+  ::testing::Values("H", "Fe12", "C1234H22", "Fe2(SO4)3", "K4[Fe(CN)6]", "((H)2)3", "CuSO4*5H2O",
+                    "2H2O*3NaCl*Og2", "[Co(NH3)5Cl]Cl2")
+);
+// clang-format on
+
+// Invalid formulas: same acceptance as the parser, absolute offsets
+class StreamInvalidTest
+    : public ::testing::TestWithParam<std::tuple<std::string_view, size_t, cfp::DiagnosticKind>> {};
+
+TEST_P(StreamInvalidTest, ThrowsWithAbsoluteOffset) {
+  const auto &[input, offset, kind] = GetParam();
+
+  // split in the middle so the error is in the second chunk when possible
+  const std::vector chunks{input.substr(0, input.size() / 2), input.substr(input.size() / 2)};
+
+  try {
+    cfp::parse_stream(chunks);
+    FAIL() << "expected StreamError for " << input;
+  } catch (const cfp::StreamError &err) {
+    EXPECT_EQ(err.offset, offset);
+    EXPECT_EQ(err.kind, kind);
+  }
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+  Invalid,
+  StreamInvalidTest,
+  ::testing::Values(
+    std::make_tuple("",             0, cfp::DiagnosticKind::EmptyUnit),
+    std::make_tuple("H2O H2O",      3, cfp::DiagnosticKind::Whitespace),
+    std::make_tuple("H2$O",         2, cfp::DiagnosticKind::UnexpectedCharacter),
+    std::make_tuple("H2Xx3",        2, cfp::DiagnosticKind::UnknownElement),
+    std::make_tuple("H2Oxyzw",      2, cfp::DiagnosticKind::UnknownElement),
+    std::make_tuple("H2O0",         3, cfp::DiagnosticKind::InvalidNumber),
+    std::make_tuple("H2O01",        3, cfp::DiagnosticKind::InvalidNumber),
+    std::make_tuple("H99999999999999999999", 1, cfp::DiagnosticKind::CountOverflow),
+    std::make_tuple("CC18446744073709551615", 2, cfp::DiagnosticKind::CountOverflow),
+    std::make_tuple("C18446744073709551615C", 21, cfp::DiagnosticKind::CountOverflow),
+    std::make_tuple("(C18446744073709551615)2", 23, cfp::DiagnosticKind::CountOverflow),
+    std::make_tuple("H2O)",         3, cfp::DiagnosticKind::UnmatchedCloser),
+    std::make_tuple("K[Fe(CN)6]]",  10, cfp::DiagnosticKind::UnmatchedCloser),
+    std::make_tuple("(H2O]",        4, cfp::DiagnosticKind::UnmatchedCloser),
+    std::make_tuple("Na(Cl",        2, cfp::DiagnosticKind::UnclosedGroup),
+    std::make_tuple("H()O",         1, cfp::DiagnosticKind::EmptyGroup),
+    std::make_tuple("(H*O)",        2, cfp::DiagnosticKind::UnexpectedToken),
+    std::make_tuple("(2H)",         1, cfp::DiagnosticKind::UnexpectedToken),
+    std::make_tuple("H2O**NaCl",    4, cfp::DiagnosticKind::EmptyUnit),
+    std::make_tuple("H2O*5",        5, cfp::DiagnosticKind::EmptyUnit)
+  )
+);
+// clang-format on
+
+// Rejects exactly what parseComposition() rejects
+TEST(StreamParserTest, AgreesWithParserOnInvalidInput) {
+  for (const std::string_view input :
+       {"H2O)", "(H", "()", "H*", "*H", "2", "H 2", "h2o", "H0", "[H)", "Xx2", "H2()O", "2*", "H2O**H2O"}) {
+    EXPECT_ANY_THROW(compose(input)) << input;
+    EXPECT_THROW(cfp::parse_stream(std::vector{input}), cfp::StreamError) << input;
+  }
+}
+
+TEST(StreamParserTest, PullCallbackOverLongInput) {
+  constexpr size_t REPEAT = 100'000;
+  size_t pulled = 0;
+
+  // "(H2O)" repeated, each copy delivered in two chunks split inside the number
+  const auto pull = [&]() -> std::string_view {
+    if (pulled == 2 * REPEAT) {
+      return {};
+    }
+    return (pulled++ % 2 == 0) ? "(H" : "2O)";
+  };
+
+  const auto comp = cfp::parse_stream(pull);
+
+  EXPECT_EQ(comp.count("H"), 2 * REPEAT);
+  EXPECT_EQ(comp.count("O"), REPEAT);
+}
+
+TEST(StreamParserTest, ReadsFromStream) {
+  std::string formula;
+
+  for (int idx = 0; idx < 1000; idx++) {
+    formula += "[Fe(CN)6]";
+  }
+  formula += "*12H2O";
+
+  std::istringstream input{formula};
+  const auto comp = cfp::parse_stream(input, /*chunk_size=*/7);
+
+  EXPECT_EQ(comp, compose(formula));
+}
+
+TEST(StreamParserTest, DeepNesting) {
+  const std::string formula = std::string(500, '(') + "H" + std::string(500, ')') + "2";
+
+  EXPECT_EQ(cfp::parse_stream(std::vector<std::string_view>{formula}).count("H"), 2u);
+}
+
+TEST(StreamParserTest, ReusableAfterFinishAndReset) {
+  cfp::StreamParser parser;
+
+  parser.feed("H2");
+  parser.feed("O");
+  EXPECT_EQ(parser.finish(), compose("H2O"));
+
+  EXPECT_THROW(parser.feed("(H))"), cfp::StreamError);
+  parser.reset();
+
+  parser.feed("NaCl");
+  EXPECT_EQ(parser.finish(), compose("NaCl"));
+}